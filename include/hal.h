@@ -0,0 +1,51 @@
+#pragma once
+
+// Hardware abstraction. The dashboard reaches the hardware only through what
+// this header pulls in:
+//
+//   display      Adafruit_SSD1306 on Wire
+//   clock        millis()/micros(), halGetTime()/halSetTime() below
+//   HTTP client  HTTPClient over WiFiClient
+//   HTTP server  WiFiServer/WiFiClient (DashboardServer sits on top)
+//   filesystem   LittleFS
+//   WiFi status  WiFi, WiFiManager, WiFiUDP, lwIP DNS, halDhcpLeaseSeconds()
+//
+// On the ESP8266 these are the Arduino libraries themselves, so the firmware
+// pays nothing for the layer. The native environment resolves the same
+// headers to the Linux stand-ins in lib/native_hal.
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <ESP8266HTTPClient.h>
+#include <ESP8266WebServer.h>  // HTTPMethod; the server itself is DashboardServer
+#include <WiFiUdp.h>
+#include <lwip/dns.h>
+#include <Wire.h>
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+#include <WiFiManager.h>
+#include <LittleFS.h>
+#include <time.h>
+#include <sys/time.h>
+
+// Wall clock, UTC. On the device the SDK owns the system clock; the native
+// build keeps an adjustable offset over the host clock instead, since
+// setting the host clock needs root.
+#ifdef ESP8266
+inline void halGetTime(timeval& tv) { gettimeofday(&tv, nullptr); }
+inline void halSetTime(const timeval& tv) { settimeofday(&tv, nullptr); }
+#else
+void halGetTime(timeval& tv);
+void halSetTime(const timeval& tv);
+#endif
+
+// Lease time the DHCP server granted the station, 0 when unknown
+#ifdef ESP8266
+#include <lwip/netif.h>
+#include <lwip/dhcp.h>
+inline uint32_t halDhcpLeaseSeconds() {
+  struct dhcp* dhcp = netif_default ? netif_dhcp_data(netif_default) : nullptr;
+  return dhcp ? dhcp->offered_t0_lease : 0;
+}
+#else
+uint32_t halDhcpLeaseSeconds();
+#endif
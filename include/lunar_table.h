@@ -0,0 +1,148 @@
+// Generated by scripts/gen_lunar_table.py - do not edit.
+// New moons 2020-2060 (UTC, Meeus ch. 49 with all terms) and the minutes from
+// each to the following full moon.
+#pragma once
+
+const int LUNAR_TABLE_SIZE = 508;
+
+const uint32_t LUNAR_NEW_MOONS[LUNAR_TABLE_SIZE] PROGMEM = {
+  1579902120u, 1582471916u, 1585042084u, 1587608741u, 1590169123u, 1592721678u,
+  1595266366u, 1597804889u, 1600340398u, 1602876652u, 1605416830u, 1607962594u,
+  1610514008u, 1613070341u, 1615630866u, 1618194645u, 1620759588u, 1623322357u,
+  1625879791u, 1628430604u, 1630975901u, 1633518315u, 1636060473u, 1638603780u,
+  1641148408u, 1643694360u, 1646242482u, 1648794256u, 1651350477u, 1653910206u,
+  1656471123u, 1659030889u, 1661588216u, 1664142864u, 1666694913u, 1669244226u,
+  1671790607u, 1674334390u, 1676876744u, 1679419382u, 1681963946u, 1684511589u,
+  1687063022u, 1689618702u, 1692178683u, 1694741986u, 1697306108u, 1699867638u,
+  1702423916u, 1704974238u, 1707519542u, 1710061219u, 1712600448u, 1715138511u,
+  1717677456u, 1720220237u, 1722769976u, 1725328529u, 1727894958u, 1730465235u,
+  1733034088u, 1735597606u, 1738154154u, 1740703480u, 1743245859u, 1745782265u,
+  1748314936u, 1750847487u, 1753384263u, 1755929183u, 1758484436u, 1761049504u,
+  1763621235u, 1766195002u, 1768765921u, 1771329669u, 1773883404u, 1776426702u,
+  1778961656u, 1781492043u, 1784022209u, 1786556195u, 1789097210u, 1791647396u,
+  1794207717u, 1796777506u, 1799353463u, 1801929363u, 1804498167u, 1807055467u,
+  1809601109u, 1812138012u, 1814670116u, 1817201100u, 1819734059u, 1822271760u,
+  1824816986u, 1827372255u, 1829938337u, 1832512347u, 1835087842u, 1837657883u,
+  1840218413u, 1842768972u, 1845311249u, 1847847690u, 1850381014u, 1852914215u,
+  1855450600u, 1857993473u, 1860545172u, 1863105864u, 1865673086u, 1868242754u,
+  1870810810u, 1873374129u, 1875930632u, 1878479460u, 1881021345u, 1883558658u,
+  1886094863u, 1888633441u, 1891176723u, 1893725365u, 1896278848u, 1898836480u,
+  1901397746u, 1903961523u, 1906525274u, 1909085656u, 1911640252u, 1914188840u,
+  1916733274u, 1919276211u, 1921819582u, 1924363923u, 1926909053u, 1929455328u,
+  1932004141u, 1934557022u, 1937114230u, 1939674274u, 1942234807u, 1944793936u,
+  1947350815u, 1949905246u, 1952456974u, 1955005540u, 1957550793u, 1960093446u,
+  1962635072u, 1965177563u, 1967722536u, 1970271120u, 1972824088u, 1975381889u,
+  1977944198u, 1980509189u, 1983073501u, 1985633572u, 1988187419u, 1990735184u,
+  1993278200u, 1995817891u, 1998355565u, 2000892983u, 2003432815u, 2005978350u,
+  2008532382u, 2011095583u, 2013665308u, 2016236351u, 2018803593u, 2021364096u,
+  2023917012u, 2026462463u, 2029001143u, 2031534748u, 2034066347u, 2036600106u,
+  2039140376u, 2041690419u, 2044251151u, 2046820571u, 2049394464u, 2051967785u,
+  2054535723u, 2057094555u, 2059642651u, 2062181020u, 2064712832u, 2067242348u,
+  2069773897u, 2072311162u, 2074856802u, 2077412316u, 2079977850u, 2082551459u,
+  2085128235u, 2087701158u, 2090264204u, 2092815185u, 2095355807u, 2097889769u,
+  2100421006u, 2102952901u, 2105488281u, 2108029790u, 2110580058u, 2113140862u,
+  2115711262u, 2118286438u, 2120859372u, 2123424459u, 2125979649u, 2128525807u,
+  2131065098u, 2133600076u, 2136133510u, 2138668456u, 2141208172u, 2143755492u,
+  2146311681u, 2148875532u, 2151443699u, 2154012173u, 2156577569u, 2159137442u,
+  2161690314u, 2164236005u, 2166775953u, 2169313037u, 2171850753u, 2174391993u,
+  2176938110u, 2179488962u, 2182043853u, 2184602368u, 2187164080u, 2189727477u,
+  2192289673u, 2194847626u, 2197399820u, 2199946970u, 2202491326u, 2205035153u,
+  2207579509u, 2210124301u, 2212669456u, 2215215957u, 2217765603u, 2220319669u,
+  2222877779u, 2225438074u, 2227998372u, 2230557209u, 2233113944u, 2235668151u,
+  2238219180u, 2240766455u, 2243310161u, 2245851545u, 2248392556u, 2250935171u,
+  2253480949u, 2256031006u, 2258586128u, 2261146554u, 2263711263u, 2266277406u,
+  2268840988u, 2271398770u, 2273949714u, 2276494720u, 2279035368u, 2281573150u,
+  2284109680u, 2286647278u, 2289189102u, 2291738465u, 2294297396u, 2296864977u,
+  2299436896u, 2302007366u, 2304571980u, 2307128846u, 2309677740u, 2312219181u,
+  2314754465u, 2317286094u, 2319817842u, 2322354151u, 2324899029u, 2327454720u,
+  2330020641u, 2332593412u, 2335168075u, 2337739459u, 2340303128u, 2342856345u,
+  2345398913u, 2347933164u, 2350463046u, 2352993013u, 2355527143u, 2358068595u,
+  2360619374u, 2363180254u, 2365750378u, 2368326318u, 2370901854u, 2373470083u,
+  2376026792u, 2378571983u, 2381108677u, 2383640889u, 2386172336u, 2388706047u,
+  2391244600u, 2393790520u, 2396346069u, 2398911839u, 2401484977u, 2404059313u,
+  2406628294u, 2409188149u, 2411738529u, 2414281119u, 2416818310u, 2419352705u,
+  2421887114u, 2424424605u, 2426968189u, 2429519923u, 2432079820u, 2434645549u,
+  2437213447u, 2439779981u, 2442342442u, 2444898934u, 2447448541u, 2449991761u,
+  2452530672u, 2455068459u, 2457608320u, 2460152278u, 2462700726u, 2465253078u,
+  2467808852u, 2470367974u, 2472929887u, 2475492590u, 2478053037u, 2480608723u,
+  2483159067u, 2485705503u, 2488250293u, 2490794998u, 2493339852u, 2495884533u,
+  2498429475u, 2500976335u, 2503527049u, 2506082398u, 2508641405u, 2511202019u,
+  2513762304u, 2516321088u, 2518877690u, 2521431325u, 2523981088u, 2526526599u,
+  2529068589u, 2531608833u, 2534149524u, 2536692641u, 2539239693u, 2541791795u,
+  2544349631u, 2546912942u, 2549479704u, 2552046069u, 2554607869u, 2557162673u,
+  2559710476u, 2562252730u, 2564791135u, 2567327331u, 2569863370u, 2572402135u,
+  2574947084u, 2577501182u, 2580065199u, 2582636349u, 2585209003u, 2587777519u,
+  2590338603u, 2592891333u, 2595436007u, 2597973629u, 2600506196u, 2603036976u,
+  2605570237u, 2608110391u, 2610660746u, 2613222184u, 2615792532u, 2618367289u,
+  2620941124u, 2623509076u, 2626067470u, 2628614883u, 2631152562u, 2633683866u,
+  2636213171u, 2638744850u, 2641282551u, 2643828804u, 2646384912u, 2648950816u,
+  2651524426u, 2654100827u, 2656673132u, 2659235536u, 2661786023u, 2664326399u,
+  2666860420u, 2669392060u, 2671924676u, 2674460946u, 2677003273u, 2679554006u,
+  2682114700u, 2684684350u, 2687258334u, 2689830034u, 2692394216u, 2694949016u,
+  2697495325u, 2700035258u, 2702571269u, 2705105961u, 2707642158u, 2710182834u,
+  2712730513u, 2715286226u, 2717848771u, 2720415129u, 2722981820u, 2725545963u,
+  2728105425u, 2730658780u, 2733205670u, 2735747227u, 2738286014u, 2740825229u,
+  2743367453u, 2745913746u, 2748463813u, 2751017072u, 2753573471u, 2756133111u,
+  2758695050u, 2761256830u, 2763815496u, 2766369260u, 2768918398u, 2771464731u,
+  2774010135u, 2776555334u, 2779100040u, 2781644190u, 2784188972u, 2786736528u,
+  2789288586u, 2791845284u, 2794405171u, 2796966180u, 2799526637u, 2802085477u,
+  2804641746u, 2807194291u, 2809742212u, 2812285623u, 2814825917u, 2817365308u,
+  2819906099u, 2822450207u, 2824999101u, 2827553846u, 2830114832u, 2832680976u,
+  2835249071u, 2837814540u, 2840373600u, 2842924938u, 2845469480u, 2848009042u,
+  2850545438u, 2853080591u, 2855617058u, 2858158161u, 2860707354u, 2863266790u,
+  2865835524u, 2868408940u, 2870980763u, 2873546161u,
+};
+
+const uint16_t LUNAR_FULL_OFFSETS[LUNAR_TABLE_SIZE] PROGMEM = {
+  22191, 21736, 21187, 20659, 20254, 20043, 20066, 20321, 20765, 21318,
+  21863, 22272, 22456, 22392, 22107, 21661, 21134, 20627, 20240, 20052,
+  20103, 20391, 20863, 21413, 21915, 22271, 22423, 22351, 22066, 21621,
+  21105, 20621, 20262, 20100, 20173, 20471, 20931, 21455, 21935, 22271,
+  22402, 22308, 22022, 21600, 21117, 20658, 20309, 20149, 20221, 20517,
+  20971, 21480, 21928, 22231, 22350, 22280, 22033, 21639, 21157, 20681,
+  20320, 20160, 20237, 20530, 20965, 21445, 21882, 22205, 22364, 22322,
+  22074, 21654, 21147, 20659, 20297, 20137, 20209, 20491, 20924, 21423,
+  21892, 22242, 22402, 22342, 22071, 21636, 21113, 20607, 20234, 20076,
+  20160, 20464, 20923, 21444, 21923, 22271, 22429, 22364, 22071, 21591,
+  21029, 20515, 20162, 20032, 20143, 20468, 20944, 21481, 21981, 22342,
+  22482, 22359, 21999, 21487, 20937, 20455, 20132, 20025, 20155, 20505,
+  21013, 21579, 22074, 22385, 22452, 22282, 21917, 21427, 20900, 20437,
+  20133, 20050, 20212, 20593, 21114, 21654, 22095, 22361, 22412, 22243,
+  21881, 21397, 20885, 20448, 20171, 20112, 20289, 20667, 21166, 21679,
+  22102, 22350, 22382, 22200, 21850, 21395, 20914, 20492, 20217, 20156,
+  20330, 20704, 21194, 21686, 22077, 22303, 22342, 22195, 21881, 21438,
+  20944, 20503, 20221, 20163, 20340, 20704, 21170, 21641, 22039, 22299,
+  22376, 22243, 21910, 21436, 20920, 20473, 20192, 20133, 20303, 20662,
+  21137, 21638, 22069, 22344, 22409, 22250, 21896, 21405, 20871, 20410,
+  20126, 20076, 20265, 20650, 21152, 21670, 22104, 22374, 22434, 22261,
+  21870, 21334, 20777, 20326, 20070, 20050, 20263, 20668, 21186, 21722,
+  22172, 22440, 22458, 22217, 21774, 21233, 20704, 20286, 20056, 20057,
+  20292, 20724, 21274, 21824, 22244, 22443, 22397, 22133, 21705, 21190,
+  20682, 20283, 20073, 20100, 20367, 20824, 21366, 21869, 22235, 22406,
+  22358, 22099, 21676, 21171, 20683, 20309, 20124, 20170, 20443, 20884,
+  21398, 21880, 22231, 22386, 22323, 22064, 21662, 21188, 20722, 20353,
+  20166, 20208, 20476, 20911, 21413, 21869, 22193, 22341, 22301, 22081,
+  21704, 21225, 20738, 20353, 20163, 20210, 20477, 20896, 21376, 21825,
+  22173, 22362, 22350, 22124, 21715, 21205, 20703, 20317, 20129, 20173,
+  20435, 20857, 21358, 21843, 22218, 22407, 22370, 22116, 21687, 21160,
+  20641, 20248, 20065, 20126, 20411, 20862, 21389, 21884, 22254, 22435,
+  22388, 22107, 21634, 21072, 20549, 20179, 20028, 20116, 20425, 20894,
+  21436, 21948, 22325, 22482, 22376, 22031, 21531, 20985, 20497, 20158,
+  20029, 20138, 20471, 20970, 21536, 22039, 22362, 22447, 22297, 21953,
+  21479, 20958, 20490, 20168, 20062, 20200, 20561, 21069, 21605, 22052,
+  22332, 22406, 22263, 21926, 21459, 20952, 20506, 20208, 20123, 20272,
+  20627, 21111, 21620, 22051, 22320, 22380, 22229, 21904, 21463, 20982,
+  20547, 20248, 20158, 20302, 20652, 21128, 21620, 22026, 22278, 22347,
+  22230, 21938, 21506, 21007, 20548, 20239, 20151, 20299, 20642, 21099,
+  21577, 21993, 22282, 22389, 22282, 21965, 21495, 20971, 20505, 20198,
+  20111, 20257, 20599, 21070, 21580, 22032, 22334, 22425, 22286, 21943,
+  21454, 20913, 20436, 20129, 20056, 20223, 20593, 21094, 21623, 22075,
+  22367, 22447, 22290, 21909, 21378, 20818, 20355, 20079, 20036, 20230,
+  20622, 21139, 21682, 22146, 22430, 22465, 22240, 21813, 21280, 20752,
+  20324, 20075, 20052, 20267, 20686, 21231, 21783, 22212, 22426, 22400,
+  22158, 21750, 21247, 20741, 20330, 20099, 20101, 20345, 20784, 21316,
+  21820, 22196, 22386, 22363, 22132, 21732, 21238, 20748, 20359, 20150,
+  20168, 20414, 20834, 21339, 21822, 22188, 22369, 22336, 22105, 21724,
+  21258, 20785, 20398, 20182, 20194, 20434, 20849, 21344, 21808, 22154,
+  22331, 22321, 22128, 21768, 21292, 20792, 20385, 20166,
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+// Drawing primitives with the Adafruit GFX geometry and classic 6x8 text
+// cell. There is no font on the host: each printed glyph is drawn as a
+// 5x7 outline, so snapshots still show the layout of every view.
+#include "Arduino.h"
+
+class Adafruit_GFX : public Print {
+public:
+  Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h) {}
+
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+  void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void fillScreen(uint16_t color) { fillRect(0, 0, WIDTH, HEIGHT, color); }
+  void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+  void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+
+  void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+  void setTextSize(uint8_t size) { textSize = size > 0 ? size : 1; }
+  void setTextColor(uint16_t color) { textColor = textBackground = color; }
+  void setTextColor(uint16_t color, uint16_t background) { textColor = color; textBackground = background; }
+  void setTextWrap(bool wrap) { this->wrap = wrap; }
+  void cp437(bool enable = true) {}
+  void getTextBounds(const char* text, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h);
+  void getTextBounds(const String& text, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+    getTextBounds(text.c_str(), x, y, x1, y1, w, h);
+  }
+  void getTextBounds(const __FlashStringHelper* text, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+    getTextBounds(reinterpret_cast<const char*>(text), x, y, x1, y1, w, h);
+  }
+
+  int16_t width() const { return WIDTH; }
+  int16_t height() const { return HEIGHT; }
+  int16_t getCursorX() const { return cursorX; }
+  int16_t getCursorY() const { return cursorY; }
+
+  size_t write(uint8_t c) override;
+  using Print::write;
+
+protected:
+  const int16_t WIDTH;
+  const int16_t HEIGHT;
+
+private:
+  int16_t cursorX = 0;
+  int16_t cursorY = 0;
+  uint8_t textSize = 1;
+  uint16_t textColor = 1;
+  uint16_t textBackground = 1;  // same as textColor: transparent
+  bool wrap = true;
+
+  void drawGlyph(int16_t x, int16_t y, unsigned char c);
+  void fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta, uint16_t color);
+};
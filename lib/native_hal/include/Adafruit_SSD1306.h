@@ -0,0 +1,39 @@
+#pragma once
+
+// SSD1306 frame buffer in the controller's page layout (one byte per 8
+// vertical pixels), so the firmware's snapshot encoder reads it unchanged.
+// display() only counts flushes.
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define BLACK 0
+#define WHITE 1
+#define INVERSE 2
+#define SSD1306_BLACK BLACK
+#define SSD1306_WHITE WHITE
+#define SSD1306_INVERSE INVERSE
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_EXTERNALVCC 0x01
+
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+  Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi = &Wire, int8_t resetPin = -1,
+                   uint32_t clockDuring = 400000UL, uint32_t clockAfter = 100000UL);
+  Adafruit_SSD1306(const Adafruit_SSD1306&) = delete;
+  Adafruit_SSD1306& operator=(const Adafruit_SSD1306&) = delete;
+  ~Adafruit_SSD1306();
+
+  bool begin(uint8_t vcs = SSD1306_SWITCHCAPVCC, uint8_t address = 0, bool reset = true, bool periphBegin = true);
+  void display() { flushes++; }
+  void clearDisplay();
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  bool getPixel(int16_t x, int16_t y);
+  uint8_t* getBuffer() { return buffer; }
+  void dim(bool dim) {}
+  void ssd1306_command(uint8_t command) {}
+
+  uint32_t flushes = 0;
+
+private:
+  uint8_t* buffer = nullptr;
+};
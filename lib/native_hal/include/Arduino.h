@@ -0,0 +1,157 @@
+#pragma once
+
+// Core Arduino/ESP8266 API for the native build: timing, PROGMEM, Serial and
+// the ESP object. Behaviour follows the ESP8266 core where the dashboard
+// depends on it; hardware-only queries return plausible fixed values.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef uint16_t word;
+
+using std::min;
+using std::max;
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define sq(x) ((x) * (x))
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define A0 17
+
+// Flash strings: plain memory on the host
+class __FlashStringHelper;
+#define PROGMEM
+#define PGM_P const char*
+#define PGM_VOID_P const void*
+#define PSTR(s) (s)
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper*>(p))
+#define F(s) FPSTR(PSTR(s))
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+#define pgm_read_float(p) (*(const float*)(p))
+#define pgm_read_ptr(p) (*(void* const*)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strlcpy_P strlcpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+#define vsnprintf_P vsnprintf
+
+#include "WString.h"
+#include "Print.h"
+
+// The sketch
+void setup();
+void loop();
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+int analogRead(uint8_t pin);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+
+char* dtostrf(double value, signed char width, unsigned char precision, char* out);
+
+// glibc only has strlcpy from 2.38; macOS and musl always do
+#if defined(__GLIBC__)
+#if !__GLIBC_PREREQ(2, 38)
+#define NATIVE_HAL_STRLCPY
+size_t strlcpy(char* dst, const char* src, size_t size);
+#endif
+#endif
+
+// stdout; reads nothing
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) {}
+  operator bool() const { return true; }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* data, size_t length) override;
+  using Print::write;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  int availableForWrite() { return 256; }
+  void flush() override;
+};
+
+extern HardwareSerial Serial;
+
+enum rst_reason {
+  REASON_DEFAULT_RST = 0,
+  REASON_WDT_RST = 1,
+  REASON_EXCEPTION_RST = 2,
+  REASON_SOFT_WDT_RST = 3,
+  REASON_SOFT_RESTART = 4,
+  REASON_DEEP_SLEEP_AWAKE = 5,
+  REASON_EXT_SYS_RST = 6
+};
+
+struct rst_info {
+  uint32_t reason;
+  uint32_t exccause;
+  uint32_t epc1;
+  uint32_t epc2;
+  uint32_t epc3;
+  uint32_t excvaddr;
+  uint32_t depc;
+};
+
+// Heap figures come from the model of the ESP8266 heap in src/Heap.cpp,
+// which sees every allocation the program makes. The cycle counter runs
+// at the ESP8266's 80 MHz off the host's monotonic clock, so cycle counts
+// logged by the firmware stay comparable. RTC user memory lives for the
+// process; every start is a power-on reset.
+class EspClass {
+public:
+  uint32_t getFreeHeap();
+  uint32_t getMaxFreeBlockSize();
+  uint8_t getHeapFragmentation();
+  uint32_t getCycleCount();
+  uint8_t getCpuFreqMHz() { return 80; }  // the rate getCycleCount() is scaled to
+  uint32_t getChipId() { return 0x00C0FFEE; }
+  uint32_t random();  // the hardware RNG; host entropy here
+  String getResetReason();
+  rst_info* getResetInfoPtr();
+  bool rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size);
+  bool rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size);
+  [[noreturn]] void reset();
+  [[noreturn]] void restart();
+  void wdtFeed() {}
+};
+
+extern EspClass ESP;
@@ -0,0 +1,36 @@
+#pragma once
+
+// Plain-HTTP GET over a host socket (HTTP/1.0, so bodies are never
+// chunked). With NATIVE_HTTP_FIXTURES set to a directory, requests are
+// answered from <dir>/<host>.json instead of the network, which keeps
+// benchmarks and profiles repeatable and offline.
+#include "ESP8266WiFi.h"
+
+#define HTTP_CODE_OK 200
+#define HTTP_CODE_NOT_FOUND 404
+
+#define HTTPC_ERROR_CONNECTION_FAILED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+class HTTPClient {
+public:
+  bool begin(WiFiClient& client, const String& url);
+  int GET();
+  String getString() { return body; }
+  int getSize() { return body.length(); }
+  void end();
+  void setTimeout(uint16_t ms) { timeout = ms; }
+  static String errorToString(int error);
+
+private:
+  WiFiClient* client = nullptr;
+  String host;
+  uint16_t port = 80;
+  String path;
+  String body;
+  uint16_t timeout = 5000;
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+// WiFi status, IPAddress and TCP sockets for the native build. The station
+// is "connected" through the host's network unless a test sets linkStatus,
+// and holds a DHCP lease of nativeDhcpLeaseSeconds; WiFiClient and
+// WiFiServer are non-blocking POSIX sockets shared between copies the way
+// the ESP8266 core shares its connection contexts.
+#include "Arduino.h"
+#include "lwip/dns.h"
+
+class IPAddress : public Printable {
+public:
+  IPAddress() : address(0) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+      : address(a | (uint32_t)b << 8 | (uint32_t)c << 16 | (uint32_t)d << 24) {}
+  IPAddress(uint32_t address) : address(address) {}
+  IPAddress(const ip_addr_t* ip) : address(ip->addr) {}
+
+  operator uint32_t() const { return address; }
+  uint8_t operator[](int index) const { return address >> (8 * index); }
+  bool operator==(const IPAddress& other) const { return address == other.address; }
+  bool isSet() const { return address != 0; }
+  bool fromString(const char* text);
+  String toString() const;
+  size_t printTo(Print& p) const override;
+
+private:
+  uint32_t address;  // first octet in the low byte, as lwIP stores it
+};
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_WRONG_PASSWORD = 6,
+  WL_DISCONNECTED = 7
+} wl_status_t;
+
+enum WiFiMode_t { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 };
+
+class ESP8266WiFiClass {
+public:
+  wl_status_t status() { return linkStatus; }
+  String SSID() const { return "native"; }
+  String psk() const { return ""; }
+  IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+  IPAddress gatewayIP() { return IPAddress(127, 0, 0, 1); }
+  IPAddress subnetMask() { return IPAddress(255, 0, 0, 0); }
+  IPAddress dnsIP(uint8_t index = 0) { return IPAddress(127, 0, 0, 1); }
+  int32_t RSSI() { return -55; }
+  uint8_t* BSSID() { return bssid; }
+  int32_t channel() { return 1; }
+
+  wl_status_t begin(const char* ssid, const char* passphrase = nullptr, int32_t channel = 0,
+                    const uint8_t* bssid = nullptr, bool connect = true) { return WL_CONNECTED; }
+  wl_status_t begin() { return WL_CONNECTED; }
+  bool config(IPAddress local, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress(),
+              IPAddress dns2 = IPAddress()) { return true; }
+  bool mode(WiFiMode_t mode) { return true; }
+  bool persistent(bool persistent) { return true; }
+  bool setAutoReconnect(bool autoReconnect) { return true; }
+  bool disconnect(bool wifiOff = false) { return true; }
+
+  wl_status_t linkStatus = WL_CONNECTED;  // native only, for tests
+
+private:
+  uint8_t bssid[6] = {0x02, 0, 0, 0, 0, 0x01};
+};
+
+extern ESP8266WiFiClass WiFi;
+extern uint32_t nativeDhcpLeaseSeconds;  // behind halDhcpLeaseSeconds()
+
+struct NativeSocket;
+
+class WiFiClient : public Stream {
+public:
+  WiFiClient() {}
+  explicit WiFiClient(int fd);
+
+  int connect(const char* host, uint16_t port);
+  uint8_t connected();
+  operator bool() { return connected(); }
+  void stop();
+  bool stop(unsigned int timeoutMs) { stop(); return true; }
+  void setNoDelay(bool noDelay);
+  void setTimeout(unsigned long ms) { Stream::setTimeout(ms); }
+  IPAddress remoteIP();
+
+  int available() override;
+  int read() override;
+  int read(uint8_t* buffer, size_t length);
+  int peek() override;
+
+  // Never blocks: returns what the socket buffer took, possibly 0
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* data, size_t length) override;
+  size_t write_P(PGM_P data, size_t length) { return write((const uint8_t*)data, length); }
+  using Print::write;
+  int availableForWrite();
+
+private:
+  std::shared_ptr<NativeSocket> socket;
+};
+
+// Ports below 1024 need root on the host, so those listen 8000 higher
+// (80 becomes 8080) unless NATIVE_HTTP_PORT says otherwise
+class WiFiServer {
+public:
+  explicit WiFiServer(uint16_t port) : port(port) {}
+
+  void begin();
+  bool hasClient();
+  WiFiClient accept();
+  WiFiClient available() { return accept(); }
+  void setNoDelay(bool noDelay) { this->noDelay = noDelay; }
+
+private:
+  uint16_t port;
+  int fd = -1;
+  bool noDelay = false;
+};
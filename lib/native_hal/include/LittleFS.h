@@ -0,0 +1,51 @@
+#pragma once
+
+// LittleFS over a host directory: NATIVE_FS_ROOT, or .native_fs in the
+// working directory. Paths are the firmware's absolute paths below it.
+#include "Arduino.h"
+
+namespace fs {
+
+struct NativeFile;
+
+class File : public Stream {
+public:
+  File() {}
+  explicit File(std::shared_ptr<NativeFile> file) : file(file) {}
+
+  operator bool() const { return file != nullptr; }
+  size_t size() const;
+  size_t position() const;
+  bool seek(uint32_t position);
+  void close() { file.reset(); }
+
+  int available() override;
+  int read() override;
+  size_t read(uint8_t* buffer, size_t length);
+  int peek() override;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* data, size_t length) override;
+  using Print::write;
+  void flush() override;
+
+private:
+  std::shared_ptr<NativeFile> file;
+};
+
+class FS {
+public:
+  bool begin();
+  File open(const char* path, const char* mode);
+  bool exists(const char* path);
+  bool remove(const char* path);
+  bool rename(const char* from, const char* to);
+
+private:
+  String root;
+  String hostPath(const char* path) const { return root + path; }
+};
+
+}  // namespace fs
+
+using fs::File;
+extern fs::FS LittleFS;
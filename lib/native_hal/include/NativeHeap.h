@@ -0,0 +1,12 @@
+#pragma once
+
+// Heap accounting of the native build, for tests and profiling. Every
+// allocation the firmware makes, through malloc, realloc, calloc or new,
+// is counted and placed in a model of the ESP8266 heap; see src/Heap.cpp.
+#include <stdint.h>
+
+// Roughly what the core leaves a sketch once WiFi is up
+const uint32_t NATIVE_HEAP_BYTES = 48 * 1024;
+
+uint32_t nativeHeapAllocations();  // calls since the process started
+uint32_t nativeHeapFailures();     // of those, how many the model had no room for
@@ -0,0 +1,85 @@
+#pragma once
+
+// Arduino String over std::string, with the members the dashboard and
+// ArduinoJson (ARDUINOJSON_ENABLE_ARDUINO_STRING) use
+#include <string>
+
+class __FlashStringHelper;
+
+class String {
+public:
+  String(const char* str = "") : s(str ? str : "") {}
+  String(const char* str, unsigned int length) : s(str, length) {}
+  String(const __FlashStringHelper* str) : String(reinterpret_cast<const char*>(str)) {}
+  String(const std::string& str) : s(str) {}
+  explicit String(char c) : s(1, c) {}
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(float value, unsigned char decimals = 2);
+  explicit String(double value, unsigned char decimals = 2);
+
+  String& operator=(const char* other) { s = other ? other : ""; return *this; }
+  String& operator=(const __FlashStringHelper* other) { return *this = reinterpret_cast<const char*>(other); }
+
+  bool concat(const String& other) { s += other.s; return true; }
+  bool concat(const char* other) { if (other) s += other; return true; }
+  bool concat(const char* other, unsigned int length) { s.append(other, length); return true; }
+  bool concat(const __FlashStringHelper* other) { return concat(reinterpret_cast<const char*>(other)); }
+  bool concat(char c) { s += c; return true; }
+  bool concat(int value) { return concat(String(value)); }
+  bool concat(unsigned int value) { return concat(String(value)); }
+  bool concat(long value) { return concat(String(value)); }
+  bool concat(unsigned long value) { return concat(String(value)); }
+  bool concat(float value) { return concat(String(value)); }
+  bool concat(double value) { return concat(String(value)); }
+
+  template <typename T>
+  String& operator+=(const T& value) { concat(value); return *this; }
+
+  bool operator==(const String& other) const { return s == other.s; }
+  bool operator==(const char* other) const { return s == (other ? other : ""); }
+  bool operator!=(const String& other) const { return !(*this == other); }
+  bool operator!=(const char* other) const { return !(*this == other); }
+  bool operator<(const String& other) const { return s < other.s; }
+  char operator[](unsigned int index) const { return index < s.size() ? s[index] : 0; }
+  char& operator[](unsigned int index) { return s[index]; }
+
+  unsigned int length() const { return s.size(); }
+  bool isEmpty() const { return s.empty(); }
+  const char* c_str() const { return s.c_str(); }
+  char* begin() { return &s[0]; }
+  char* end() { return &s[0] + s.size(); }
+  bool reserve(unsigned int size) { s.reserve(size); return true; }
+  char charAt(unsigned int index) const { return (*this)[index]; }
+
+  bool equals(const String& other) const { return *this == other; }
+  bool equals(const char* other) const { return *this == other; }
+  bool equalsIgnoreCase(const String& other) const;
+  bool startsWith(const String& prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+  bool endsWith(const String& suffix) const;
+  int indexOf(char c, unsigned int from = 0) const;
+  int indexOf(const String& text, unsigned int from = 0) const;
+  int lastIndexOf(char c) const;
+  String substring(unsigned int from) const { return substring(from, s.size()); }
+  String substring(unsigned int from, unsigned int to) const;
+
+  void remove(unsigned int index) { if (index < s.size()) s.erase(index); }
+  void remove(unsigned int index, unsigned int count) { if (index < s.size()) s.erase(index, count); }
+  void replace(const String& find, const String& replacement);
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+  long toInt() const { return atol(s.c_str()); }
+  float toFloat() const { return atof(s.c_str()); }
+  void toCharArray(char* out, unsigned int size) const;
+
+private:
+  std::string s;
+};
+
+String operator+(const String& a, const String& b);
+String operator+(const String& a, const char* b);
+String operator+(const char* a, const String& b);
+String operator+(const String& a, char b);
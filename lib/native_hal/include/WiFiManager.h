@@ -0,0 +1,28 @@
+#pragma once
+
+// The host is always online, so there is no portal: autoConnect() and
+// process() succeed at once and every parameter keeps its default
+#include "ESP8266WiFi.h"
+
+class WiFiManagerParameter {
+public:
+  WiFiManagerParameter(const char* id, const char* label, const char* defaultValue, int length)
+      : id(id), value(defaultValue ? defaultValue : "") {}
+
+  const char* getID() const { return id; }
+  const char* getValue() const { return value.c_str(); }
+
+private:
+  const char* id;
+  String value;
+};
+
+class WiFiManager {
+public:
+  void setSaveConfigCallback(std::function<void()> callback) {}
+  void addParameter(WiFiManagerParameter* parameter) {}
+  void setConfigPortalTimeout(unsigned long seconds) {}
+  void setConfigPortalBlocking(bool blocking) {}
+  bool autoConnect(const char* apName) { return true; }
+  bool process() { return true; }
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+// Non-blocking UDP over a host socket
+#include "ESP8266WiFi.h"
+#include <vector>
+
+class WiFiUDP : public Stream {
+public:
+  ~WiFiUDP() { stop(); }
+
+  uint8_t begin(uint16_t port);
+  void stop();
+
+  int beginPacket(IPAddress ip, uint16_t port);
+  int endPacket();
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* data, size_t length) override;
+  using Print::write;
+
+  // Size of the next datagram, 0 when none has arrived
+  int parsePacket();
+  int available() override { return rx.size() - rxOffset; }
+  int read() override;
+  int read(uint8_t* buffer, size_t length);
+  int peek() override;
+  IPAddress remoteIP() { return remote; }
+
+private:
+  int fd = -1;
+  IPAddress destination;
+  uint16_t destinationPort = 0;
+  IPAddress remote;
+  std::vector<uint8_t> tx;
+  std::vector<uint8_t> rx;
+  size_t rxOffset = 0;
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+// I2C is not wired to anything on the host
+#include "Arduino.h"
+
+class TwoWire {
+public:
+  void begin() {}
+  void begin(int sda, int scl) {}
+  void setClock(uint32_t frequency) {}
+};
+
+extern TwoWire Wire;
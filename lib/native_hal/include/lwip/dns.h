@@ -0,0 +1,19 @@
+#pragma once
+
+// lwIP's DNS entry point. The host resolver answers synchronously, so
+// dns_gethostbyname() returns ERR_OK or ERR_ARG and never calls back.
+#include <stdint.h>
+
+typedef int8_t err_t;
+
+#define ERR_OK 0
+#define ERR_INPROGRESS -5
+#define ERR_ARG -16
+
+struct ip_addr_t {
+  uint32_t addr;  // network byte order, as in lwIP
+};
+
+typedef void (*dns_found_callback)(const char* name, const ip_addr_t* ipaddr, void* callback_arg);
+
+err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg);
@@ -0,0 +1,129 @@
+#include "Arduino.h"
+#include "Wire.h"
+#include <sys/random.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+TwoWire Wire;
+
+namespace {
+
+timespec startClock() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now;
+}
+
+timespec processStart = startClock();
+int64_t wallClockOffsetUs = 0;  // set by halSetTime()
+uint8_t rtcUserMemory[512];
+rst_info resetInfo = {REASON_DEFAULT_RST, 0, 0, 0, 0, 0, 0};
+
+int64_t monotonicNs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)(now.tv_sec - processStart.tv_sec) * 1000000000 + (now.tv_nsec - processStart.tv_nsec);
+}
+
+}  // namespace
+
+unsigned long millis() { return (unsigned long)(uint32_t)(monotonicNs() / 1000000); }
+unsigned long micros() { return (unsigned long)(uint32_t)(monotonicNs() / 1000); }
+
+void delay(unsigned long ms) { usleep(ms * 1000); }
+void delayMicroseconds(unsigned int us) { usleep(us); }
+void yield() {}
+
+long random(long howbig) { return howbig > 0 ? ::random() % howbig : 0; }
+long random(long howsmall, long howbig) { return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall); }
+void randomSeed(unsigned long seed) { srandom(seed); }
+long map(long x, long inMin, long inMax, long outMin, long outMax) { return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin; }
+
+int analogRead(uint8_t pin) { return micros() & 0x3FF; }  // noise, like a floating A0
+void pinMode(uint8_t pin, uint8_t mode) {}
+void digitalWrite(uint8_t pin, uint8_t value) {}
+
+char* dtostrf(double value, signed char width, unsigned char precision, char* out) {
+  sprintf(out, "%*.*f", width, precision, value);
+  return out;
+}
+
+#ifdef NATIVE_HAL_STRLCPY
+size_t strlcpy(char* dst, const char* src, size_t size) {
+  size_t length = strlen(src);
+  if (size > 0) {
+    size_t n = length < size - 1 ? length : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return length;
+}
+#endif
+
+size_t HardwareSerial::write(uint8_t c) { return fwrite(&c, 1, 1, stdout); }
+size_t HardwareSerial::write(const uint8_t* data, size_t length) { return fwrite(data, 1, length, stdout); }
+void HardwareSerial::flush() { fflush(stdout); }
+
+uint32_t EspClass::getCycleCount() { return (uint32_t)(monotonicNs() * 80 / 1000); }
+uint32_t EspClass::random() {
+  uint32_t value;
+  getentropy(&value, sizeof(value));
+  return value;
+}
+
+String EspClass::getResetReason() { return "Power On"; }
+rst_info* EspClass::getResetInfoPtr() { return &resetInfo; }
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size) {
+  if (offset * 4 + size > sizeof(rtcUserMemory) || size == 0) return false;
+  memcpy(data, rtcUserMemory + offset * 4, size);
+  return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size) {
+  if (offset * 4 + size > sizeof(rtcUserMemory) || size == 0) return false;
+  memcpy(rtcUserMemory + offset * 4, data, size);
+  return true;
+}
+
+void EspClass::reset() {
+  fflush(stdout);
+  fprintf(stderr, "ESP.reset()\n");
+  exit(EXIT_FAILURE);
+}
+
+void EspClass::restart() { reset(); }
+
+// Wall clock behind halGetTime()/halSetTime() in include/hal.h: the host
+// clock plus whatever correction the firmware last applied
+void halGetTime(timeval& tv) {
+  gettimeofday(&tv, nullptr);
+  int64_t us = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec + wallClockOffsetUs;
+  tv.tv_sec = us / 1000000;
+  tv.tv_usec = us % 1000000;
+}
+
+void halSetTime(const timeval& tv) {
+  timeval host;
+  gettimeofday(&host, nullptr);
+  wallClockOffsetUs = ((int64_t)tv.tv_sec - host.tv_sec) * 1000000 + (tv.tv_usec - host.tv_usec);
+}
+
+// setup() once, then loop() until NATIVE_RUN_SECONDS (if set) have passed,
+// so perf and valgrind runs end on their own. Unit tests bring their own
+// main() and call into the firmware directly.
+#ifndef PIO_UNIT_TESTING
+int main() {
+  const char* runSeconds = getenv("NATIVE_RUN_SECONDS");
+  unsigned long runMs = runSeconds ? strtoul(runSeconds, nullptr, 10) * 1000 : 0;
+
+  setup();
+  while (runMs == 0 || millis() < runMs) {
+    loop();
+  }
+  fflush(stdout);
+  return 0;
+}
+#endif
@@ -0,0 +1,210 @@
+#include "Adafruit_SSD1306.h"
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  for (int16_t i = 0; i < w; i++) drawPixel(x + i, y, color);
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  for (int16_t i = 0; i < h; i++) drawPixel(x, y + i, color);
+}
+
+// Bresenham, as in Adafruit_GFX::writeLine
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    std::swap(x0, y0);
+    std::swap(x1, y1);
+  }
+  if (x0 > x1) {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+  }
+  int16_t dx = x1 - x0;
+  int16_t dy = abs(y1 - y0);
+  int16_t err = dx / 2;
+  int16_t ystep = y0 < y1 ? 1 : -1;
+  for (; x0 <= x1; x0++) {
+    if (steep) {
+      drawPixel(y0, x0, color);
+    } else {
+      drawPixel(x0, y0, color);
+    }
+    err -= dy;
+    if (err < 0) {
+      y0 += ystep;
+      err += dx;
+    }
+  }
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  for (int16_t i = x; i < x + w; i++) drawFastVLine(i, y, h, color);
+}
+
+void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  int16_t f = 1 - r;
+  int16_t ddFx = 1;
+  int16_t ddFy = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+
+  drawPixel(x0, y0 + r, color);
+  drawPixel(x0, y0 - r, color);
+  drawPixel(x0 + r, y0, color);
+  drawPixel(x0 - r, y0, color);
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddFy += 2;
+      f += ddFy;
+    }
+    x++;
+    ddFx += 2;
+    f += ddFx;
+    drawPixel(x0 + x, y0 + y, color);
+    drawPixel(x0 - x, y0 + y, color);
+    drawPixel(x0 + x, y0 - y, color);
+    drawPixel(x0 - x, y0 - y, color);
+    drawPixel(x0 + y, y0 + x, color);
+    drawPixel(x0 - y, y0 + x, color);
+    drawPixel(x0 + y, y0 - x, color);
+    drawPixel(x0 - y, y0 - x, color);
+  }
+}
+
+void Adafruit_GFX::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  drawFastVLine(x0, y0 - r, 2 * r + 1, color);
+  fillCircleHelper(x0, y0, r, 3, 0, color);
+}
+
+void Adafruit_GFX::fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta, uint16_t color) {
+  int16_t f = 1 - r;
+  int16_t ddFx = 1;
+  int16_t ddFy = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+  int16_t px = x;
+  int16_t py = y;
+
+  delta++;
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddFy += 2;
+      f += ddFy;
+    }
+    x++;
+    ddFx += 2;
+    f += ddFx;
+    if (x < y + 1) {
+      if (corners & 1) drawFastVLine(x0 + x, y0 - y, 2 * y + delta, color);
+      if (corners & 2) drawFastVLine(x0 - x, y0 - y, 2 * y + delta, color);
+    }
+    if (y != py) {
+      if (corners & 1) drawFastVLine(x0 + py, y0 - px, 2 * px + delta, color);
+      if (corners & 2) drawFastVLine(x0 - py, y0 - px, 2 * px + delta, color);
+      py = y;
+    }
+    px = x;
+  }
+}
+
+void Adafruit_GFX::drawGlyph(int16_t x, int16_t y, unsigned char c) {
+  if (textBackground != textColor) {
+    fillRect(x, y, 6 * textSize, 8 * textSize, textBackground);
+  }
+  if (c != ' ') {
+    drawRect(x, y, 5 * textSize, 7 * textSize, textColor);
+  }
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+  if (c == '\n') {
+    cursorX = 0;
+    cursorY += 8 * textSize;
+  } else if (c != '\r') {
+    if (wrap && cursorX + 6 * textSize > WIDTH) {
+      cursorX = 0;
+      cursorY += 8 * textSize;
+    }
+    drawGlyph(cursorX, cursorY, c);
+    cursorX += 6 * textSize;
+  }
+  return 1;
+}
+
+// Same metrics as the classic font: 6x8 cells, the last column blank
+void Adafruit_GFX::getTextBounds(const char* text, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+  int16_t cx = x;
+  int16_t cy = y;
+  int16_t minX = WIDTH, minY = HEIGHT, maxX = -1, maxY = -1;
+  for (; *text; text++) {
+    if (*text == '\n') {
+      cx = 0;
+      cy += 8 * textSize;
+      continue;
+    }
+    if (*text == '\r') continue;
+    if (wrap && cx + 6 * textSize > WIDTH) {
+      cx = 0;
+      cy += 8 * textSize;
+    }
+    minX = std::min(minX, cx);
+    minY = std::min(minY, cy);
+    maxX = std::max<int16_t>(maxX, cx + 6 * textSize - 1);
+    maxY = std::max<int16_t>(maxY, cy + 8 * textSize - 1);
+    cx += 6 * textSize;
+  }
+  if (maxX < minX) {
+    *x1 = x;
+    *y1 = y;
+    *w = *h = 0;
+    return;
+  }
+  *x1 = minX;
+  *y1 = minY;
+  *w = maxX - minX + 1;
+  *h = maxY - minY + 1;
+}
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t resetPin,
+                                   uint32_t clockDuring, uint32_t clockAfter)
+    : Adafruit_GFX(w, h) {}
+
+Adafruit_SSD1306::~Adafruit_SSD1306() { free(buffer); }
+
+bool Adafruit_SSD1306::begin(uint8_t vcs, uint8_t address, bool reset, bool periphBegin) {
+  if (!buffer) {
+    buffer = (uint8_t*)malloc(WIDTH * ((HEIGHT + 7) / 8));
+    if (!buffer) return false;
+  }
+  clearDisplay();
+  return true;
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+  if (buffer) memset(buffer, 0, WIDTH * ((HEIGHT + 7) / 8));
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (!buffer || x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return;
+  uint8_t& cell = buffer[x + (y / 8) * WIDTH];
+  uint8_t bit = 1 << (y & 7);
+  switch (color) {
+    case WHITE: cell |= bit; break;
+    case BLACK: cell &= ~bit; break;
+    case INVERSE: cell ^= bit; break;
+  }
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y) {
+  if (!buffer || x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return false;
+  return buffer[x + (y / 8) * WIDTH] & (1 << (y & 7));
+}
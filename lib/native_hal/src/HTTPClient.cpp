@@ -0,0 +1,96 @@
+#include "ESP8266HTTPClient.h"
+
+namespace {
+
+bool readFixture(const char* dir, const String& host, String& body) {
+  String path = String(dir) + "/" + host + ".json";
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f) return false;
+  char chunk[512];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) body.concat(chunk, n);
+  fclose(f);
+  return true;
+}
+
+}  // namespace
+
+bool HTTPClient::begin(WiFiClient& client, const String& url) {
+  end();
+  if (!url.startsWith("http://")) return false;  // no TLS on the host either
+  String rest = url.substring(7);
+  int slash = rest.indexOf('/');
+  String authority = slash < 0 ? rest : rest.substring(0, slash);
+  path = slash < 0 ? String("/") : rest.substring(slash);
+  int colon = authority.indexOf(':');
+  host = colon < 0 ? authority : authority.substring(0, colon);
+  port = colon < 0 ? 80 : authority.substring(colon + 1).toInt();
+  this->client = &client;
+  return host.length() > 0;
+}
+
+int HTTPClient::GET() {
+  if (!client) return HTTPC_ERROR_NOT_CONNECTED;
+  body = "";
+
+  const char* fixtures = getenv("NATIVE_HTTP_FIXTURES");
+  if (fixtures) return readFixture(fixtures, host, body) ? HTTP_CODE_OK : HTTP_CODE_NOT_FOUND;
+
+  client->setTimeout(timeout);
+  if (!client->connect(host.c_str(), port)) return HTTPC_ERROR_CONNECTION_FAILED;
+
+  String request = "GET " + path + " HTTP/1.0\r\nHost: " + host + "\r\nConnection: close\r\n\r\n";
+  const uint8_t* data = (const uint8_t*)request.c_str();
+  size_t remaining = request.length();
+  unsigned long start = millis();
+  while (remaining > 0) {
+    size_t n = client->write(data, remaining);
+    data += n;
+    remaining -= n;
+    if (millis() - start > timeout) return HTTPC_ERROR_SEND_HEADER_FAILED;
+  }
+
+  // HTTP/1.0 with Connection: close, so the response ends at EOF
+  String response;
+  uint8_t chunk[1024];
+  start = millis();
+  while (true) {
+    int n = client->read(chunk, sizeof(chunk));
+    if (n > 0) {
+      response.concat((const char*)chunk, n);
+      start = millis();
+    } else if (!client->connected()) {
+      break;
+    } else if (millis() - start > timeout) {
+      client->stop();
+      return HTTPC_ERROR_READ_TIMEOUT;
+    } else {
+      delay(1);
+    }
+  }
+  client->stop();
+
+  if (!response.startsWith("HTTP/")) return response.length() ? HTTPC_ERROR_NO_HTTP_SERVER : HTTPC_ERROR_CONNECTION_LOST;
+  int space = response.indexOf(' ');
+  int code = response.substring(space + 1, space + 4).toInt();
+  int headerEnd = response.indexOf("\r\n\r\n");
+  body = headerEnd < 0 ? String() : response.substring(headerEnd + 4);
+  return code > 0 ? code : HTTPC_ERROR_NO_HTTP_SERVER;
+}
+
+void HTTPClient::end() {
+  if (client) client->stop();
+  client = nullptr;
+}
+
+String HTTPClient::errorToString(int error) {
+  switch (error) {
+    case HTTPC_ERROR_CONNECTION_FAILED: return "connection failed";
+    case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+    case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+    case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+    case HTTPC_ERROR_NO_HTTP_SERVER: return "no HTTP server";
+    case HTTPC_ERROR_READ_TIMEOUT: return "read Timeout";
+    default: return String();
+  }
+}
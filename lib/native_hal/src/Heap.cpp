@@ -0,0 +1,207 @@
+#include "Arduino.h"
+#include "NativeHeap.h"
+#include <atomic>
+#include <math.h>
+#include <new>
+#include <stdlib.h>
+
+// The malloc family reaches here through -Wl,--wrap (see [env:native] in
+// platformio.ini); operator new and delete are replaced outright. Both
+// cover code compiled into the program, while allocations libc and
+// libstdc++ make internally go straight to the host allocator.
+//
+// Memory still comes from the host, but every allocation is also placed in
+// a model of the ESP8266 heap: NATIVE_HEAP_BYTES cut into umm_malloc's 8
+// byte blocks, handed out best fit with a 4 byte header and coalesced on
+// free. ESP.getFreeHeap(), getMaxFreeBlockSize() and getHeapFragmentation()
+// read the model, so fragmentation from a long run shows up as on the chip.
+namespace {
+
+const uint32_t BLOCK_BYTES = 8;
+const uint32_t BLOCK_COUNT = NATIVE_HEAP_BYTES / BLOCK_BYTES;
+const uint32_t HEADER_MAGIC = 0x48454150;  // "HEAP"
+
+// Precedes every block handed out here; blocks == 0 when the model was full
+struct alignas(16) Header {
+  uint32_t magic;
+  uint32_t size;
+  uint16_t start;
+  uint16_t blocks;
+};
+
+struct Extent {
+  uint16_t start;
+  uint16_t length;
+};
+
+// Free extents of the model, sorted by start; zero-initialised, so usable
+// from static constructors before this file's own have run
+Extent extents[BLOCK_COUNT / 2 + 1];
+uint32_t extentCount = 0;
+bool modelReady = false;
+std::atomic_flag modelLock = ATOMIC_FLAG_INIT;
+
+std::atomic<uint32_t> allocations(0);
+std::atomic<uint32_t> failures(0);
+
+struct ModelGuard {
+  ModelGuard() {
+    while (modelLock.test_and_set(std::memory_order_acquire)) {}
+    if (!modelReady) {
+      extents[0] = {0, (uint16_t)BLOCK_COUNT};
+      extentCount = 1;
+      modelReady = true;
+    }
+  }
+  ~ModelGuard() { modelLock.clear(std::memory_order_release); }
+};
+
+// Best fit, lowest address on a tie; false when nothing is large enough
+bool takeBlocks(uint16_t blocks, uint16_t& start) {
+  ModelGuard guard;
+  uint32_t best = extentCount;
+  for (uint32_t i = 0; i < extentCount; i++) {
+    if (extents[i].length >= blocks && (best == extentCount || extents[i].length < extents[best].length)) {
+      best = i;
+    }
+  }
+  if (best == extentCount) return false;
+  start = extents[best].start;
+  extents[best].start += blocks;
+  extents[best].length -= blocks;
+  if (extents[best].length == 0) {
+    memmove(&extents[best], &extents[best + 1], (extentCount - best - 1) * sizeof(Extent));
+    extentCount--;
+  }
+  return true;
+}
+
+void returnBlocks(uint16_t start, uint16_t blocks) {
+  ModelGuard guard;
+  uint32_t next = 0;
+  while (next < extentCount && extents[next].start < start) next++;
+  bool joinsPrevious = next > 0 && extents[next - 1].start + extents[next - 1].length == start;
+  bool joinsNext = next < extentCount && start + blocks == extents[next].start;
+  if (joinsPrevious && joinsNext) {
+    extents[next - 1].length += blocks + extents[next].length;
+    memmove(&extents[next], &extents[next + 1], (extentCount - next - 1) * sizeof(Extent));
+    extentCount--;
+  } else if (joinsPrevious) {
+    extents[next - 1].length += blocks;
+  } else if (joinsNext) {
+    extents[next].start = start;
+    extents[next].length += blocks;
+  } else {
+    memmove(&extents[next + 1], &extents[next], (extentCount - next) * sizeof(Extent));
+    extents[next] = {start, blocks};
+    extentCount++;
+  }
+}
+
+Header* headerOf(void* p) {
+  Header* header = (Header*)p - 1;
+  return header->magic == HEADER_MAGIC ? header : nullptr;
+}
+
+}  // namespace
+
+extern "C" {
+
+void* __real_malloc(size_t size);
+void __real_free(void* p);
+void* __real_realloc(void* p, size_t size);
+
+void* __wrap_malloc(size_t size) {
+  allocations++;
+  Header* header = (Header*)__real_malloc(sizeof(Header) + size);
+  if (!header) return nullptr;
+  uint32_t blocks = (size + 4 + BLOCK_BYTES - 1) / BLOCK_BYTES;
+  uint16_t start = 0;
+  if (blocks > BLOCK_COUNT || !takeBlocks(blocks, start)) {
+    failures++;
+    blocks = 0;
+  }
+  *header = {HEADER_MAGIC, (uint32_t)size, start, (uint16_t)blocks};
+  return header + 1;
+}
+
+// Pointers without a header were allocated inside libc, e.g. by strdup()
+void __wrap_free(void* p) {
+  if (!p) return;
+  Header* header = headerOf(p);
+  if (!header) {
+    __real_free(p);
+    return;
+  }
+  if (header->blocks) returnBlocks(header->start, header->blocks);
+  header->magic = 0;
+  __real_free(header);
+}
+
+void* __wrap_realloc(void* p, size_t size) {
+  if (!p) return __wrap_malloc(size);
+  Header* header = headerOf(p);
+  if (!header) return __real_realloc(p, size);
+  if (size == 0) {
+    __wrap_free(p);
+    return nullptr;
+  }
+  void* moved = __wrap_malloc(size);
+  if (!moved) return nullptr;
+  memcpy(moved, p, min<size_t>(header->size, size));
+  __wrap_free(p);
+  return moved;
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+  if (size && count > SIZE_MAX / size) return nullptr;
+  void* p = __wrap_malloc(count * size);
+  if (p) memset(p, 0, count * size);
+  return p;
+}
+
+}  // extern "C"
+
+uint32_t nativeHeapAllocations() { return allocations; }
+uint32_t nativeHeapFailures() { return failures; }
+
+uint32_t EspClass::getFreeHeap() {
+  ModelGuard guard;
+  uint32_t blocks = 0;
+  for (uint32_t i = 0; i < extentCount; i++) blocks += extents[i].length;
+  return blocks * BLOCK_BYTES;
+}
+
+uint32_t EspClass::getMaxFreeBlockSize() {
+  ModelGuard guard;
+  uint32_t blocks = 0;
+  for (uint32_t i = 0; i < extentCount; i++) blocks = max<uint32_t>(blocks, extents[i].length);
+  return blocks * BLOCK_BYTES;
+}
+
+// The core's formula: 100 - 100 * sqrt(sum of squared free sizes) / free
+uint8_t EspClass::getHeapFragmentation() {
+  ModelGuard guard;
+  double total = 0;
+  double squares = 0;
+  for (uint32_t i = 0; i < extentCount; i++) {
+    double bytes = extents[i].length * BLOCK_BYTES;
+    total += bytes;
+    squares += bytes * bytes;
+  }
+  return total > 0 ? (uint8_t)(100 - sqrt(squares) * 100 / total) : 0;
+}
+
+void* operator new(size_t size) {
+  void* p = __wrap_malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return __wrap_malloc(size ? size : 1); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return __wrap_malloc(size ? size : 1); }
+void operator delete(void* p) noexcept { __wrap_free(p); }
+void operator delete[](void* p) noexcept { __wrap_free(p); }
+void operator delete(void* p, size_t) noexcept { __wrap_free(p); }
+void operator delete[](void* p, size_t) noexcept { __wrap_free(p); }
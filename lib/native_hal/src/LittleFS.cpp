@@ -0,0 +1,74 @@
+#include "LittleFS.h"
+#include <sys/stat.h>
+
+fs::FS LittleFS;
+
+namespace fs {
+
+struct NativeFile {
+  FILE* f;
+  explicit NativeFile(FILE* f) : f(f) {}
+  ~NativeFile() { fclose(f); }
+};
+
+size_t File::size() const {
+  if (!file) return 0;
+  struct stat st;
+  fflush(file->f);
+  return fstat(fileno(file->f), &st) == 0 ? st.st_size : 0;
+}
+
+size_t File::position() const { return file ? ftell(file->f) : 0; }
+
+bool File::seek(uint32_t position) { return file && fseek(file->f, position, SEEK_SET) == 0; }
+
+int File::available() { return file ? (int)(size() - position()) : 0; }
+
+int File::read() {
+  if (!file) return -1;
+  int c = fgetc(file->f);
+  return c == EOF ? -1 : c;
+}
+
+size_t File::read(uint8_t* buffer, size_t length) { return file ? fread(buffer, 1, length, file->f) : 0; }
+
+int File::peek() {
+  if (!file) return -1;
+  int c = fgetc(file->f);
+  if (c == EOF) return -1;
+  ungetc(c, file->f);
+  return c;
+}
+
+size_t File::write(const uint8_t* data, size_t length) { return file ? fwrite(data, 1, length, file->f) : 0; }
+
+void File::flush() {
+  if (file) fflush(file->f);
+}
+
+bool FS::begin() {
+  const char* dir = getenv("NATIVE_FS_ROOT");
+  root = dir ? dir : ".native_fs";
+  return mkdir(root.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+// Arduino modes map one to one onto stdio, always binary
+File FS::open(const char* path, const char* mode) {
+  String flags(mode);
+  flags += 'b';
+  FILE* f = fopen(hostPath(path).c_str(), flags.c_str());
+  return f ? File(std::make_shared<NativeFile>(f)) : File();
+}
+
+bool FS::exists(const char* path) {
+  struct stat st;
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) { return ::remove(hostPath(path).c_str()) == 0; }
+
+bool FS::rename(const char* from, const char* to) {
+  return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+}  // namespace fs
@@ -0,0 +1,262 @@
+#include "ESP8266WiFi.h"
+#include "WiFiUdp.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+ESP8266WiFiClass WiFi;
+uint32_t nativeDhcpLeaseSeconds = 86400;
+
+uint32_t halDhcpLeaseSeconds() { return nativeDhcpLeaseSeconds; }
+
+bool IPAddress::fromString(const char* text) {
+  in_addr parsed;
+  if (inet_pton(AF_INET, text, &parsed) != 1) return false;
+  address = parsed.s_addr;
+  return true;
+}
+
+String IPAddress::toString() const {
+  char text[16];
+  snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+  return text;
+}
+
+size_t IPAddress::printTo(Print& p) const { return p.print(toString()); }
+
+namespace {
+
+void setNonBlocking(int fd) { fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK); }
+
+bool resolve(const char* host, int type, sockaddr_in& out) {
+  addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = type;
+  addrinfo* found = nullptr;
+  if (getaddrinfo(host, nullptr, &hints, &found) != 0 || !found) return false;
+  out = *(sockaddr_in*)found->ai_addr;
+  freeaddrinfo(found);
+  return true;
+}
+
+}  // namespace
+
+err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg) {
+  sockaddr_in resolved;
+  if (!resolve(hostname, SOCK_DGRAM, resolved)) return ERR_ARG;
+  addr->addr = resolved.sin_addr.s_addr;
+  return ERR_OK;
+}
+
+struct NativeSocket {
+  int fd;
+  explicit NativeSocket(int fd) : fd(fd) {}
+  ~NativeSocket() { close(fd); }
+};
+
+WiFiClient::WiFiClient(int fd) : socket(std::make_shared<NativeSocket>(fd)) {}
+
+// Blocking connect bounded by the stream timeout, then non-blocking like
+// an lwIP pcb
+int WiFiClient::connect(const char* host, uint16_t port) {
+  stop();
+  sockaddr_in address;
+  if (!resolve(host, SOCK_STREAM, address)) return 0;
+  address.sin_port = htons(port);
+
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return 0;
+  auto owner = std::make_shared<NativeSocket>(fd);
+  setNonBlocking(fd);
+  if (::connect(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+    if (errno != EINPROGRESS) return 0;
+    pollfd waiting = {fd, POLLOUT, 0};
+    if (poll(&waiting, 1, timeout) != 1) return 0;
+    int error = 0;
+    socklen_t length = sizeof(error);
+    getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length);
+    if (error != 0) return 0;
+  }
+  socket = owner;
+  return 1;
+}
+
+uint8_t WiFiClient::connected() {
+  if (!socket) return 0;
+  char probe;
+  ssize_t n = recv(socket->fd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (n > 0) return 1;
+  if (n == 0) return 0;  // orderly shutdown with nothing left to read
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+void WiFiClient::stop() { socket.reset(); }
+
+void WiFiClient::setNoDelay(bool noDelay) {
+  if (!socket) return;
+  int flag = noDelay;
+  setsockopt(socket->fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+IPAddress WiFiClient::remoteIP() {
+  sockaddr_in peer;
+  socklen_t length = sizeof(peer);
+  if (!socket || getpeername(socket->fd, (sockaddr*)&peer, &length) != 0) return IPAddress();
+  return IPAddress((uint32_t)peer.sin_addr.s_addr);
+}
+
+int WiFiClient::available() {
+  int n = 0;
+  if (!socket || ioctl(socket->fd, FIONREAD, &n) != 0) return 0;
+  return n;
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t length) {
+  if (!socket) return -1;
+  ssize_t n = recv(socket->fd, buffer, length, MSG_DONTWAIT);
+  return n > 0 ? (int)n : -1;
+}
+
+int WiFiClient::peek() {
+  uint8_t c;
+  if (!socket) return -1;
+  return recv(socket->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? c : -1;
+}
+
+size_t WiFiClient::write(const uint8_t* data, size_t length) {
+  if (!socket) return 0;
+  ssize_t n = send(socket->fd, data, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+  return n > 0 ? n : 0;
+}
+
+int WiFiClient::availableForWrite() {
+  if (!socket) return 0;
+  pollfd waiting = {socket->fd, POLLOUT, 0};
+  return poll(&waiting, 1, 0) == 1 && (waiting.revents & POLLOUT) ? 1460 : 0;
+}
+
+void WiFiServer::begin() {
+  const char* override = getenv("NATIVE_HTTP_PORT");
+  uint16_t hostPort = override ? atoi(override) : port < 1024 ? port + 8000 : port;
+
+  fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return;
+  int reuse = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(hostPort);
+  if (bind(fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 5) != 0) {
+    fprintf(stderr, "WiFiServer: cannot listen on port %u: %s\n", hostPort, strerror(errno));
+    close(fd);
+    fd = -1;
+    return;
+  }
+  setNonBlocking(fd);
+  printf("WiFiServer: listening on port %u\n", hostPort);
+}
+
+bool WiFiServer::hasClient() {
+  if (fd < 0) return false;
+  pollfd waiting = {fd, POLLIN, 0};
+  return poll(&waiting, 1, 0) == 1;
+}
+
+WiFiClient WiFiServer::accept() {
+  if (fd < 0) return WiFiClient();
+  int client = ::accept(fd, nullptr, nullptr);
+  if (client < 0) return WiFiClient();
+  setNonBlocking(client);
+  WiFiClient accepted(client);
+  if (noDelay) accepted.setNoDelay(true);
+  return accepted;
+}
+
+uint8_t WiFiUDP::begin(uint16_t port) {
+  stop();
+  fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) return 0;
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(port);
+  if (bind(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+    // The port is only a source port for NTP; any free one will do
+    address.sin_port = 0;
+    if (bind(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+      stop();
+      return 0;
+    }
+  }
+  setNonBlocking(fd);
+  return 1;
+}
+
+void WiFiUDP::stop() {
+  if (fd >= 0) close(fd);
+  fd = -1;
+  tx.clear();
+  rx.clear();
+  rxOffset = 0;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+  destination = ip;
+  destinationPort = port;
+  tx.clear();
+  return fd >= 0;
+}
+
+size_t WiFiUDP::write(const uint8_t* data, size_t length) {
+  tx.insert(tx.end(), data, data + length);
+  return length;
+}
+
+int WiFiUDP::endPacket() {
+  if (fd < 0) return 0;
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = (uint32_t)destination;
+  address.sin_port = htons(destinationPort);
+  ssize_t n = sendto(fd, tx.data(), tx.size(), 0, (sockaddr*)&address, sizeof(address));
+  tx.clear();
+  return n >= 0;
+}
+
+int WiFiUDP::parsePacket() {
+  rx.clear();
+  rxOffset = 0;
+  if (fd < 0) return 0;
+  uint8_t datagram[1500];
+  sockaddr_in from;
+  socklen_t length = sizeof(from);
+  ssize_t n = recvfrom(fd, datagram, sizeof(datagram), MSG_DONTWAIT, (sockaddr*)&from, &length);
+  if (n <= 0) return 0;
+  rx.assign(datagram, datagram + n);
+  remote = IPAddress((uint32_t)from.sin_addr.s_addr);
+  return n;
+}
+
+int WiFiUDP::read() { return rxOffset < rx.size() ? rx[rxOffset++] : -1; }
+
+int WiFiUDP::read(uint8_t* buffer, size_t length) {
+  size_t n = std::min(length, rx.size() - rxOffset);
+  memcpy(buffer, rx.data() + rxOffset, n);
+  rxOffset += n;
+  return n;
+}
+
+int WiFiUDP::peek() { return rxOffset < rx.size() ? rx[rxOffset] : -1; }
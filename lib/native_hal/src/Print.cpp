@@ -0,0 +1,95 @@
+#include "Arduino.h"
+
+size_t Print::write(const uint8_t* data, size_t length) {
+  size_t n = 0;
+  while (length--) {
+    if (write(*data++) == 0) break;
+    n++;
+  }
+  return n;
+}
+
+size_t Print::write(const char* s) {
+  return s ? write((const uint8_t*)s, strlen(s)) : 0;
+}
+
+size_t Print::print(const String& s) { return write(s.c_str(), s.length()); }
+
+size_t Print::printNumber(unsigned long long value, int base) {
+  return print(String((unsigned long)value, (unsigned char)base));
+}
+
+size_t Print::print(long value, int base) { return print((long long)value, base); }
+size_t Print::print(unsigned long value, int base) { return print((unsigned long long)value, base); }
+
+size_t Print::print(long long value, int base) {
+  if (base == 10 && value < 0) {
+    return write('-') + printNumber(-(unsigned long long)value, base);
+  }
+  return printNumber(value, base);
+}
+
+size_t Print::print(unsigned long long value, int base) { return printNumber(value, base); }
+
+size_t Print::print(double value, int digits) { return print(String(value, (unsigned char)digits)); }
+
+namespace {
+
+size_t vprint(Print& out, const char* format, va_list args) {
+  char small[128];
+  va_list copy;
+  va_copy(copy, args);
+  int length = vsnprintf(small, sizeof(small), format, copy);
+  va_end(copy);
+  if (length < 0) return 0;
+  if ((size_t)length < sizeof(small)) return out.write((const uint8_t*)small, length);
+
+  std::unique_ptr<char[]> large(new char[length + 1]);
+  vsnprintf(large.get(), length + 1, format, args);
+  return out.write((const uint8_t*)large.get(), length);
+}
+
+}  // namespace
+
+size_t Print::printf(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  size_t n = vprint(*this, format, args);
+  va_end(args);
+  return n;
+}
+
+size_t Print::printf_P(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  size_t n = vprint(*this, format, args);
+  va_end(args);
+  return n;
+}
+
+int Stream::timedRead() {
+  unsigned long start = millis();
+  do {
+    int c = read();
+    if (c >= 0) return c;
+    yield();
+  } while (millis() - start < timeout);
+  return -1;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+  size_t n = 0;
+  while (n < length) {
+    int c = timedRead();
+    if (c < 0) break;
+    buffer[n++] = (char)c;
+  }
+  return n;
+}
+
+String Stream::readString() {
+  String out;
+  int c;
+  while ((c = timedRead()) >= 0) out += (char)c;
+  return out;
+}
@@ -0,0 +1,120 @@
+#include "Arduino.h"
+#include <ctype.h>
+
+namespace {
+
+std::string formatInteger(unsigned long long value, unsigned char base, bool negative) {
+  if (base < 2 || base > 36) base = 10;
+  char digits[66];
+  char* p = digits + sizeof(digits);
+  *--p = '\0';
+  do {
+    unsigned digit = value % base;
+    *--p = digit < 10 ? '0' + digit : 'a' + digit - 10;
+    value /= base;
+  } while (value > 0);
+  if (negative) *--p = '-';
+  return p;
+}
+
+std::string formatFloat(double value, unsigned char decimals) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+  return buffer;
+}
+
+}  // namespace
+
+// Like the ESP8266 core, only base 10 is signed
+String::String(int value, unsigned char base) : String((long)value, base) {}
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+String::String(long value, unsigned char base)
+    : s(base == 10 ? formatInteger(value < 0 ? -(unsigned long long)value : value, 10, value < 0)
+                   : formatInteger((unsigned long)value, base, false)) {}
+String::String(unsigned long value, unsigned char base) : s(formatInteger(value, base, false)) {}
+String::String(float value, unsigned char decimals) : s(formatFloat(value, decimals)) {}
+String::String(double value, unsigned char decimals) : s(formatFloat(value, decimals)) {}
+
+bool String::equalsIgnoreCase(const String& other) const {
+  return s.size() == other.s.size() && strncasecmp(s.c_str(), other.s.c_str(), s.size()) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+  return s.size() >= suffix.s.size() && s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+  size_t at = s.find(c, from);
+  return at == std::string::npos ? -1 : (int)at;
+}
+
+int String::indexOf(const String& text, unsigned int from) const {
+  size_t at = s.find(text.s, from);
+  return at == std::string::npos ? -1 : (int)at;
+}
+
+int String::lastIndexOf(char c) const {
+  size_t at = s.rfind(c);
+  return at == std::string::npos ? -1 : (int)at;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) std::swap(from, to);
+  if (from >= s.size()) return String();
+  return String(s.substr(from, std::min<size_t>(to, s.size()) - from));
+}
+
+void String::replace(const String& find, const String& replacement) {
+  if (find.s.empty()) return;
+  for (size_t at = s.find(find.s); at != std::string::npos; at = s.find(find.s, at + replacement.s.size())) {
+    s.replace(at, find.s.size(), replacement.s);
+  }
+}
+
+void String::toLowerCase() {
+  for (char& c : s) c = tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+  for (char& c : s) c = toupper((unsigned char)c);
+}
+
+void String::trim() {
+  size_t first = s.find_first_not_of(" \t\r\n\f\v");
+  if (first == std::string::npos) {
+    s.clear();
+    return;
+  }
+  s = s.substr(first, s.find_last_not_of(" \t\r\n\f\v") - first + 1);
+}
+
+void String::toCharArray(char* out, unsigned int size) const {
+  if (size == 0) return;
+  size_t n = std::min<size_t>(s.size(), size - 1);
+  memcpy(out, s.c_str(), n);
+  out[n] = '\0';
+}
+
+String operator+(const String& a, const String& b) {
+  String sum(a);
+  sum.concat(b);
+  return sum;
+}
+
+String operator+(const String& a, const char* b) {
+  String sum(a);
+  sum.concat(b);
+  return sum;
+}
+
+String operator+(const char* a, const String& b) {
+  String sum(a);
+  sum.concat(b);
+  return sum;
+}
+
+String operator+(const String& a, char b) {
+  String sum(a);
+  sum.concat(b);
+  return sum;
+}
@@ -0,0 +1,115 @@
+"""Generates include/lunar_table.h: new and full moon times for 2020-2060.
+
+New and full moon instants from Meeus, Astronomical Algorithms ch. 49 with
+all periodic and planetary terms (about a minute), converted from TT to UTC
+with the Espenak-Meeus Delta-T polynomials. Run from the project root:
+
+  python scripts/gen_lunar_table.py
+"""
+
+import math
+import os
+from datetime import datetime, timezone
+
+FIRST_YEAR = 2020
+LAST_YEAR = 2060
+OUTPUT = os.path.join("include", "lunar_table.h")
+
+NEW_TERMS = (-0.40720, 0.17241, 0.01608, 0.01039, 0.00739, -0.00514, 0.00208)
+FULL_TERMS = (-0.40614, 0.17302, 0.01614, 0.01043, 0.00734, -0.00515, 0.00209)
+PLANETARY = (
+    (299.77, 0.107408, 0.000325), (251.88, 0.016321, 0.000165), (251.83, 26.651886, 0.000164),
+    (349.42, 36.412478, 0.000126), (84.66, 18.206239, 0.000110), (141.74, 53.303771, 0.000062),
+    (207.14, 2.453732, 0.000060), (154.84, 7.306860, 0.000056), (34.52, 27.261239, 0.000047),
+    (207.19, 0.121824, 0.000042), (291.34, 1.844379, 0.000040), (161.72, 24.198154, 0.000037),
+    (239.56, 25.513099, 0.000035), (331.55, 3.592518, 0.000023),
+)
+
+
+def sin(deg):
+    return math.sin(math.radians(deg))
+
+
+def phase_jde(k, full):
+    if full:
+        k += 0.5
+    T = k / 1236.85
+    jde = (2451550.09766 + 29.530588861 * k + 0.00015437 * T**2
+           - 0.000000150 * T**3 + 0.00000000073 * T**4)
+    E = 1 - 0.002516 * T - 0.0000074 * T**2
+    M = 2.5534 + 29.10535670 * k - 0.0000014 * T**2 - 0.00000011 * T**3
+    Mp = 201.5643 + 385.81693528 * k + 0.0107582 * T**2 + 0.00001238 * T**3 - 0.000000058 * T**4
+    F = 160.7108 + 390.67050284 * k - 0.0016118 * T**2 - 0.00000227 * T**3 + 0.000000011 * T**4
+    Om = 124.7746 - 1.56375588 * k + 0.0020672 * T**2 + 0.00000215 * T**3
+
+    c = FULL_TERMS if full else NEW_TERMS
+    jde += (c[0] * sin(Mp) + c[1] * E * sin(M) + c[2] * sin(2 * Mp) + c[3] * sin(2 * F)
+            + c[4] * E * sin(Mp - M) + c[5] * E * sin(Mp + M) + c[6] * E * E * sin(2 * M)
+            - 0.00111 * sin(Mp - 2 * F) - 0.00057 * sin(Mp + 2 * F) + 0.00056 * E * sin(2 * Mp + M)
+            - 0.00042 * sin(3 * Mp) + 0.00042 * E * sin(M + 2 * F) + 0.00038 * E * sin(M - 2 * F)
+            - 0.00024 * E * sin(2 * Mp - M) - 0.00017 * sin(Om) - 0.00007 * sin(Mp + 2 * M)
+            + 0.00004 * sin(2 * Mp - 2 * F) + 0.00004 * sin(3 * M) + 0.00003 * sin(Mp + M - 2 * F)
+            + 0.00003 * sin(2 * Mp + 2 * F) - 0.00003 * sin(Mp + M + 2 * F)
+            + 0.00003 * sin(Mp - M + 2 * F) - 0.00002 * sin(Mp - M - 2 * F)
+            - 0.00002 * sin(3 * Mp + M) + 0.00002 * sin(4 * Mp))
+    for i, (a0, rate, coeff) in enumerate(PLANETARY):
+        arg = a0 + rate * k - (0.009173 * T**2 if i == 0 else 0)
+        jde += coeff * sin(arg)
+    return jde
+
+
+def delta_t(year):
+    """Seconds TT - UT (Espenak & Meeus, 2006)."""
+    if year < 2050:
+        t = year - 2000
+        return 62.92 + 0.32217 * t + 0.005589 * t * t
+    return -20 + 32 * ((year - 1820) / 100) ** 2 - 0.5628 * (2150 - year)
+
+
+def unix_time(jde):
+    year = 2000 + (jde - 2451545.0) / 365.25
+    return round((jde - 2440587.5) * 86400 - delta_t(year))
+
+
+def main():
+    start = datetime(FIRST_YEAR, 1, 1, tzinfo=timezone.utc).timestamp()
+    end = datetime(LAST_YEAR + 1, 1, 1, tzinfo=timezone.utc).timestamp()
+
+    k = math.floor((FIRST_YEAR - 2000) * 12.3685) - 1
+    new_moons, full_offsets = [], []
+    while True:
+        new = unix_time(phase_jde(k, False))
+        if new >= end:
+            break
+        if new >= start:
+            new_moons.append(new)
+            full_offsets.append(round((unix_time(phase_jde(k, True)) - new) / 60))
+        k += 1
+    # One more new moon so the last lunation in range has an end
+    new_moons.append(unix_time(phase_jde(k, False)))
+    full_offsets.append(round((unix_time(phase_jde(k, True)) - new_moons[-1]) / 60))
+
+    lines = [
+        "// Generated by scripts/gen_lunar_table.py - do not edit.",
+        "// New moons %d-%d (UTC, Meeus ch. 49 with all terms) and the minutes from" % (FIRST_YEAR, LAST_YEAR),
+        "// each to the following full moon.",
+        "#pragma once",
+        "",
+        "const int LUNAR_TABLE_SIZE = %d;" % len(new_moons),
+        "",
+        "const uint32_t LUNAR_NEW_MOONS[LUNAR_TABLE_SIZE] PROGMEM = {",
+    ]
+    for i in range(0, len(new_moons), 6):
+        lines.append("  " + " ".join("%du," % t for t in new_moons[i:i + 6]))
+    lines += ["};", "", "const uint16_t LUNAR_FULL_OFFSETS[LUNAR_TABLE_SIZE] PROGMEM = {"]
+    for i in range(0, len(full_offsets), 10):
+        lines.append("  " + " ".join("%d," % m for m in full_offsets[i:i + 10]))
+    lines += ["};", ""]
+
+    with open(OUTPUT, "w") as f:
+        f.write("\n".join(lines))
+    print("Wrote %s: %d lunations" % (OUTPUT, len(new_moons)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,269 @@
+"""Memory budget report from the firmware linker map.
+
+Hooked into PlatformIO with `extra_scripts = post:scripts/memory_report.py`:
+
+  * every link writes `firmware.map` next to the ELF, prints how much of the
+    firmware's own fixed text PROGMEM, F() and PSTR() keep in flash, and
+    checks static DRAM use against `custom_dram_budget` from platformio.ini,
+    failing the build when it is exceeded;
+  * `pio run -t memreport` prints IRAM / DRAM / flash use per library and the
+    largest symbols, diffed against `memory_baseline.json`;
+  * `pio run -t memreport-baseline` rewrites that baseline. When it is
+    missing, the first link writes it, to be committed with the change
+    that produced it.
+
+It also runs on its own, e.g. in CI:
+
+  python scripts/memory_report.py .pio/build/modwifi/firmware.map \
+      --baseline memory_baseline.json --budget 49152
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+# ESP8266 output sections by the memory they occupy at run time. .data and
+# .rodata also take flash for their load image, but DRAM is the scarce one.
+REGIONS = {
+    ".text": "iram",
+    ".text1": "iram",
+    ".data": "dram",
+    ".rodata": "dram",
+    ".bss": "dram",
+    ".noinit": "dram",
+    ".irom0.text": "flash",
+}
+REGION_ORDER = ("iram", "dram", "flash")
+
+# Input sections the core's PROGMEM and PSTR()/F() macros emit, named after
+# the source file and line. Without the macros the same bytes are .rodata,
+# which the ESP8266 copies into DRAM at boot.
+FLASH_STRING_SECTIONS = (".irom.text.", ".irom0.pstr.")
+
+OUTPUT_SECTION = re.compile(r"^(\.[\w.]+)\s+0x[0-9a-f]+\s+0x[0-9a-f]+", re.I)
+INPUT_SECTION = re.compile(r"^ (\S+)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(.+)$", re.I)
+INPUT_NAME_ONLY = re.compile(r"^ (\.\S+|COMMON)$")
+INPUT_CONTINUED = re.compile(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(.+)$", re.I)
+
+
+def library_of(obj):
+    """Names the library an input object came from."""
+    archive = re.search(r"([^/\\]+)\.a\(", obj)
+    if archive:
+        name = archive.group(1)
+        return name[3:] if name.startswith("lib") else name
+    parts = re.split(r"[/\\]", obj)
+    if "src" in parts:
+        return "src"
+    return parts[-1]
+
+
+def symbol_of(section, obj):
+    """Function/data sections are named after their symbol."""
+    for prefix in (".irom0.text.", ".text.", ".rodata.", ".data.", ".bss.", ".literal."):
+        if section.startswith(prefix) and len(section) > len(prefix):
+            return section[len(prefix):]
+    return "%s(%s)" % (section, obj.split("/")[-1])
+
+
+def parse_map(path):
+    """Returns {(region, library, symbol): bytes} for every input section."""
+    usage = {}
+    region = None
+    pending = None
+    in_memory_map = False
+
+    def add(section, size, obj):
+        if region is None or size == 0:
+            return
+        key = (region, library_of(obj), symbol_of(section, obj))
+        usage[key] = usage.get(key, 0) + size
+
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if line.startswith("Linker script and memory map"):
+                in_memory_map = True
+                continue
+            if not in_memory_map:
+                continue
+
+            output = OUTPUT_SECTION.match(line)
+            if output and not line.startswith(" "):
+                region = REGIONS.get(output.group(1))
+                pending = None
+                continue
+            if line and not line.startswith(" "):
+                # Output section whose address is on the next line, or a
+                # section we do not track
+                name = line.split()[0]
+                region = REGIONS.get(name) if name.startswith(".") else None
+                pending = None
+                continue
+
+            if pending is not None:
+                cont = INPUT_CONTINUED.match(line)
+                if cont:
+                    add(pending, int(cont.group(2), 16), cont.group(3).strip())
+                pending = None
+                continue
+
+            name_only = INPUT_NAME_ONLY.match(line)
+            if name_only:
+                pending = name_only.group(1)
+                continue
+
+            entry = INPUT_SECTION.match(line)
+            if entry and not entry.group(1).startswith("0x") and not entry.group(1).startswith("*"):
+                add(entry.group(1), int(entry.group(3), 16), entry.group(4).strip())
+    return usage
+
+
+def summarize(usage):
+    regions = {r: 0 for r in REGION_ORDER}
+    libraries = {}
+    flash_strings = 0
+    for (region, library, symbol), size in usage.items():
+        regions[region] += size
+        lib = libraries.setdefault(library, {r: 0 for r in REGION_ORDER})
+        lib[region] += size
+        if region == "flash" and library == "src" and symbol.startswith(FLASH_STRING_SECTIONS):
+            flash_strings += size
+    return {"regions": regions, "libraries": libraries, "flash_strings": flash_strings}
+
+
+def demangle(names):
+    tool = shutil.which("xtensa-lx106-elf-c++filt") or shutil.which("c++filt")
+    if not tool or not names:
+        return {n: n for n in names}
+    out = subprocess.run([tool], input="\n".join(names), capture_output=True, text=True).stdout
+    return dict(zip(names, out.splitlines())) if out else {n: n for n in names}
+
+
+def delta(now, then):
+    if then is None:
+        return ""
+    diff = now - then
+    return " (%+d)" % diff if diff else ""
+
+
+def print_flash_strings(summary, baseline=None):
+    before = (baseline or {}).get("flash_strings")
+    print("Flash strings: %d bytes of src/ text kept out of DRAM%s" % (summary["flash_strings"],
+                                                                     delta(summary["flash_strings"], before)))
+
+
+def print_report(usage, summary, baseline=None, top=15):
+    if baseline is None:
+        print("No baseline to diff against (pio run -t memreport-baseline)\n")
+    base_regions = (baseline or {}).get("regions", {})
+    base_libs = (baseline or {}).get("libraries", {})
+
+    print("Region      Bytes")
+    for region in REGION_ORDER:
+        print("%-8s %8d%s" % (region.upper(), summary["regions"][region],
+                                delta(summary["regions"][region], base_regions.get(region))))
+
+    print("\n%-28s %8s %8s %8s" % ("Library", "IRAM", "DRAM", "Flash"))
+    libs = sorted(summary["libraries"].items(), key=lambda kv: -sum(kv[1].values()))
+    for name, sizes in libs:
+        before = base_libs.get(name, {})
+        print("%-28s %8d %8d %8d%s" % (name[:28], sizes["iram"], sizes["dram"], sizes["flash"],
+                                       delta(sizes["dram"], before.get("dram")) if baseline else ""))
+    for name in sorted(set(base_libs) - set(summary["libraries"])):
+        print("%-28s removed" % name[:28])
+
+    for region in ("dram", "iram"):
+        symbols = sorted(((s, k) for k, s in usage.items() if k[0] == region), reverse=True)[:top]
+        names = demangle([k[2] for _, k in symbols])
+        print("\nLargest %s symbols" % region.upper())
+        for size, (_, library, symbol) in symbols:
+            print("%8d  %-16s %s" % (size, library[:16], names.get(symbol, symbol)[:90]))
+
+    print()
+    print_flash_strings(summary, baseline)
+
+
+def check_budget(summary, budget):
+    dram = summary["regions"]["dram"]
+    if budget and dram > budget:
+        print("DRAM budget exceeded: %d of %d bytes (%+d)" % (dram, budget, dram - budget))
+        return False
+    if budget:
+        print("DRAM: %d of %d bytes budgeted (%d left)" % (dram, budget, budget - dram))
+    return True
+
+
+def load_baseline(path):
+    if path and os.path.isfile(path):
+        with open(path) as f:
+            return json.load(f)
+    return None
+
+
+def write_baseline(path, summary):
+    with open(path, "w") as f:
+        json.dump(summary, f, indent=2, sort_keys=True)
+        f.write("\n")
+    print("Wrote %s" % path)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("map", help="linker map file")
+    parser.add_argument("--baseline", help="baseline JSON to diff against")
+    parser.add_argument("--budget", type=int, default=0, help="fail above this many bytes of DRAM")
+    parser.add_argument("--write-baseline", action="store_true", help="store this build as the baseline")
+    parser.add_argument("--top", type=int, default=15, help="symbols to list per region")
+    args = parser.parse_args(argv)
+
+    usage = parse_map(args.map)
+    summary = summarize(usage)
+    if args.write_baseline:
+        write_baseline(args.baseline or "memory_baseline.json", summary)
+        return 0
+    print_report(usage, summary, load_baseline(args.baseline), args.top)
+    return 0 if check_budget(summary, args.budget) else 1
+
+
+def register(env):
+    map_path = os.path.join(env.subst("$BUILD_DIR"), "firmware.map")
+    elf = "$BUILD_DIR/${PROGNAME}.elf"
+    baseline = os.path.join(env.subst("$PROJECT_DIR"), "memory_baseline.json")
+    budget = int(env.GetProjectOption("custom_dram_budget", "0"))
+
+    env.Append(LINKFLAGS=["-Wl,-Map," + map_path])
+
+    def after_link(target, source, env):
+        summary = summarize(parse_map(map_path))
+        if not os.path.isfile(baseline):
+            print("No memory baseline yet; recording this build. Commit memory_baseline.json.")
+            write_baseline(baseline, summary)
+        print_flash_strings(summary, load_baseline(baseline))
+        return 0 if check_budget(summary, budget) else 1
+
+    def report(target, source, env):
+        usage = parse_map(map_path)
+        summary = summarize(usage)
+        print_report(usage, summary, load_baseline(baseline))
+        return 0 if check_budget(summary, budget) else 1
+
+    def rebaseline(target, source, env):
+        write_baseline(baseline, summarize(parse_map(map_path)))
+
+    env.AddPostAction(elf, after_link)
+    env.AddCustomTarget("memreport", elf, report, title="Memory Report",
+                        description="IRAM/DRAM/flash use per library and symbol")
+    env.AddCustomTarget("memreport-baseline", elf, rebaseline, title="Memory Baseline",
+                        description="Store current memory use in memory_baseline.json")
+
+
+if __name__ == "__main__":
+    sys.exit(main())
+else:
+    Import("env")  # noqa: F821 - provided by PlatformIO's SCons
+    register(env)  # noqa: F821
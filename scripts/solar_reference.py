@@ -0,0 +1,99 @@
+"""Prints the reference sun times used by test/test_solar.
+
+NOAA's full solar calculator (the Meeus-based equations of its spreadsheet:
+apparent longitude, obliquity with nutation, equation of time), with each
+event iterated to the instant it happens instead of evaluated at noon.
+That is good to well under a minute outside the polar circles, so it checks
+the firmware's single-evaluation fractional-year series. Run from the
+project root and paste the rows into the test:
+
+  python scripts/solar_reference.py
+"""
+
+import math
+
+RISE_SET = 90.833
+CIVIL = 96.0
+
+# name, latitude, longitude, year, month, day, UTC offset in minutes
+PLACES = (
+    ("London", 51.5074, -0.1278, 2024, 6, 21, 60),
+    ("London", 51.5074, -0.1278, 2024, 12, 21, 0),
+    ("New York", 40.7128, -74.0060, 2024, 3, 20, -240),
+    ("Sydney", -33.8688, 151.2093, 2024, 12, 21, 660),
+    ("Cape Town", -33.9249, 18.4241, 2024, 6, 21, 120),
+    ("Quito", -0.1807, -78.4678, 2024, 9, 22, -300),
+    ("Tokyo", 35.6762, 139.6503, 2025, 1, 1, 540),
+    ("Anchorage", 61.2181, -149.9003, 2024, 2, 29, -540),
+    ("Reykjavik", 64.1466, -21.9426, 2024, 6, 21, 0),
+    ("Tromso", 69.6492, 18.9553, 2024, 6, 21, 120),
+    ("Tromso", 69.6492, 18.9553, 2024, 12, 21, 60),
+)
+
+
+def sin(deg):
+    return math.sin(math.radians(deg))
+
+
+def cos(deg):
+    return math.cos(math.radians(deg))
+
+
+def julian_day(year, month, day):
+    if month <= 2:
+        year -= 1
+        month += 12
+    a = year // 100
+    b = 2 - a + a // 4
+    return int(365.25 * (year + 4716)) + int(30.6001 * (month + 1)) + day + b - 1524.5
+
+
+def sun(jd):
+    """Declination (degrees) and equation of time (minutes) at jd."""
+    t = (jd - 2451545) / 36525
+    l0 = (280.46646 + t * (36000.76983 + 0.0003032 * t)) % 360
+    m = 357.52911 + t * (35999.05029 - 0.0001537 * t)
+    e = 0.016708634 - t * (0.000042037 + 0.0000001267 * t)
+    c = (sin(m) * (1.914602 - t * (0.004817 + 0.000014 * t)) + sin(2 * m) * (0.019993 - 0.000101 * t)
+         + sin(3 * m) * 0.000289)
+    omega = 125.04 - 1934.136 * t
+    apparent = l0 + c - 0.00569 - 0.00478 * sin(omega)
+    mean_obliquity = 23 + (26 + (21.448 - t * (46.815 + t * (0.00059 - t * 0.001813))) / 60) / 60
+    obliquity = mean_obliquity + 0.00256 * cos(omega)
+    declination = math.degrees(math.asin(sin(obliquity) * sin(apparent)))
+    y = math.tan(math.radians(obliquity / 2)) ** 2
+    eq_time = 4 * math.degrees(y * sin(2 * l0) - 2 * e * sin(m) + 4 * e * y * sin(m) * cos(2 * l0)
+                               - 0.5 * y * y * sin(4 * l0) - 1.25 * e * e * sin(2 * m))
+    return declination, eq_time
+
+
+def event(jd0, lat, lon, zenith, sign):
+    """UTC minutes of the crossing (sign -1 rising, +1 setting), or None."""
+    minutes = 720 - 4 * lon
+    for _ in range(4):
+        declination, eq_time = sun(jd0 + minutes / 1440)
+        cos_ha = cos(zenith) / (cos(lat) * cos(declination)) - math.tan(math.radians(lat)) * math.tan(
+            math.radians(declination))
+        if abs(cos_ha) > 1:
+            return None
+        minutes = 720 - 4 * lon - eq_time + sign * 4 * math.degrees(math.acos(cos_ha))
+    return minutes
+
+
+def local(minutes, offset):
+    return "MINUTE_UNKNOWN" if minutes is None else str(round(minutes + offset) % 1440)
+
+
+def main():
+    for name, lat, lon, year, month, day, offset in PLACES:
+        jd0 = julian_day(year, month, day)
+        _, eq_time = sun(jd0 + (720 - 4 * lon) / 1440)
+        noon = 720 - 4 * lon - eq_time
+        times = (event(jd0, lat, lon, CIVIL, -1), event(jd0, lat, lon, RISE_SET, -1), noon,
+                 event(jd0, lat, lon, RISE_SET, 1), event(jd0, lat, lon, CIVIL, 1))
+        print('  {"%s", %.4f, %.4f, %d, %d, %d, %d, {%s}},' % (
+            name, lat, lon, year, month, day, offset, ", ".join(local(t, offset) for t in times)))
+
+
+if __name__ == "__main__":
+    main()
@@ -1,14 +1,94 @@
-#include <Arduino.h>
-#include <ESP8266WiFi.h>
-#include <ESP8266HTTPClient.h>
-#include <ESP8266WebServer.h>
-#include <time.h>
-#include <Wire.h>
-#include <Adafruit_GFX.h>
-#include <Adafruit_SSD1306.h>
-#include <WiFiManager.h>
-#include <LittleFS.h>
+#include "hal.h"  // display, clock, HTTP, filesystem and WiFi
 #include <ArduinoJson.h>
+#include "lunar_table.h"  // generated by scripts/gen_lunar_table.py
+
+// --- LOGGING ---
+// LOG_ERROR/WARN/INFO/DEBUG take a printf format kept in flash. Levels above
+// LOG_LEVEL (build flag, default info) compile to nothing, arguments
+// included. A message is formatted at the call into a RAM ring of recent
+// entries; the "log" task trickles them out to Serial as the UART FIFO has
+// room, so logging never waits on 115200 baud. /log serves the same ring.
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+const char LOG_LEVEL_LETTERS[] = "-EWID";
+const int LOG_ENTRIES = 32;
+const int LOG_TEXT_LENGTH = 67;
+
+struct LogEntry {
+  uint32_t ms;
+  uint8_t level;
+  char text[LOG_TEXT_LENGTH];  // truncated to fit
+};
+
+LogEntry logEntries[LOG_ENTRIES];
+uint32_t logCount = 0;    // entries ever written; the newest is logCount - 1
+uint32_t logDrained = 0;  // next entry to go out on Serial
+char logLine[96];         // entry being written to Serial
+uint8_t logLineLength = 0;
+uint8_t logLineSent = 0;
+
+void logWrite(uint8_t level, PGM_P format, ...) {
+  LogEntry& entry = logEntries[logCount % LOG_ENTRIES];
+  entry.ms = millis();
+  entry.level = level;
+  va_list args;
+  va_start(args, format);
+  vsnprintf_P(entry.text, sizeof(entry.text), format, args);
+  va_end(args);
+  logCount++;
+}
+
+// Writes only what the UART can take without blocking
+void drainLog() {
+  while (true) {
+    if (logLineSent == logLineLength) {
+      if (logDrained == logCount) return;
+      int n;
+      if (logCount - logDrained > LOG_ENTRIES) {
+        uint32_t lost = logCount - LOG_ENTRIES - logDrained;
+        logDrained += lost;
+        n = snprintf_P(logLine, sizeof(logLine), PSTR("... %u log entries dropped\n"), (unsigned)lost);
+      } else {
+        const LogEntry& entry = logEntries[logDrained++ % LOG_ENTRIES];
+        n = snprintf_P(logLine, sizeof(logLine), PSTR("[%6u.%03u] %c %s\n"), (unsigned)(entry.ms / 1000),
+                       (unsigned)(entry.ms % 1000), LOG_LEVEL_LETTERS[entry.level], entry.text);
+      }
+      logLineLength = min<int>(n, sizeof(logLine) - 1);
+      logLineSent = 0;
+    }
+    size_t room = Serial.availableForWrite();
+    if (room == 0) return;
+    logLineSent += Serial.write((const uint8_t*)logLine + logLineSent, min<size_t>(room, logLineLength - logLineSent));
+  }
+}
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(format, ...) logWrite(LOG_LEVEL_ERROR, PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_ERROR(format, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(format, ...) logWrite(LOG_LEVEL_WARN, PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_WARN(format, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(format, ...) logWrite(LOG_LEVEL_INFO, PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_INFO(format, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(format, ...) logWrite(LOG_LEVEL_DEBUG, PSTR(format), ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(format, ...) do {} while (0)
+#endif
 
 // --- CONFIGURATION ---
 char gmtOffset[6] = "3600";
@@ -18,7 +98,7 @@ char longitude[10] = "9.18";
 // Location Configuration
 char cityName[50] = "Kreuzlingen, Switzerland";
 char displayName[30] = "Kreuzlingen, CH";
-char timezone[50] = "CET-1CEST,M3.5.0,M10.5.0/3";
+char timeZone[50] = "CET-1CEST,M3.5.0,M10.5.0/3";
 char tempUnit[2] = "C";
 int viewDuration = 5000;
 bool manualCoordinates = false;
@@ -30,9 +110,15 @@ bool manualCoordinates = false;
 #define SCREEN_ADDRESS 0x3C
 
 // Time settings
-const char* NTP_SERVER = "pool.ntp.org";
-long GMT_OFFSET_SEC = 3600;
-const int DAYLIGHT_OFFSET_SEC = 0;
+const char NTP_SERVER[] PROGMEM = "pool.ntp.org";
+
+// One local-time snapshot shared by everything drawn in a frame or served in
+// a request, instead of a getLocalTime() call per helper.
+struct TimeContext {
+  time_t epoch;
+  struct tm local;
+  bool valid;
+};
 
 // Weather settings
 String weatherApiUrl = "";
@@ -40,42 +126,202 @@ String weatherApiUrl = "";
 // Slideshow settings
 const int VIEW_CHANGE_INTERVAL_MS = 5000;
 
+// --- HTTP SERVER ---
+// Non-blocking replacement for ESP8266WebServer with the same handler API.
+// Connections live in a fixed pool with their own request buffers and are
+// advanced a little on every handleClient() call: reads take only what has
+// arrived and writes only what the TCP window accepts, so one slow client
+// can no longer stall the display or the other connections. With every slot
+// busy, new connections wait in the listen backlog until one frees up.
+const int HTTP_MAX_CONNECTIONS = 4;
+const size_t HTTP_REQUEST_BUFFER_SIZE = 1024;
+const size_t HTTP_WRITE_CHUNK_SIZE = 536;  // one segment at lwIP's default MSS
+const unsigned long HTTP_TIMEOUT_MS = 5000;
+const int HTTP_MAX_ROUTES = 12;
+
+class DashboardServer {
+public:
+  typedef void (*Handler)();
+  // Appends the next piece of a streamed body; returns false when done
+  typedef bool (*Generator)(String& out, uint32_t& cursor);
+
+  explicit DashboardServer(uint16_t port) : listener(port) {}
+
+  void on(const char* path, Handler handler) { on(path, HTTP_ANY, handler); }
+  void on(const char* path, HTTPMethod method, Handler handler);
+  void onPrefix(const char* prefix, HTTPMethod method, Handler handler);
+  void begin();
+  void handleClient();
+
+  // Request accessors, valid while a handler runs
+  HTTPMethod method() const;
+  String uri() const;
+  bool hasArg(const char* name) const;
+  String arg(const char* name) const;
+  String header(const char* name) const;
+
+  // Response bodies go out as far as the TCP window allows; the rest is
+  // buffered per connection and drained by handleClient()
+  void sendHeader(const char* name, const String& value);
+  void setContentLength(size_t length) { pendingContentLength = length; }
+  void send(int code, const char* contentType, const String& content);
+  void send_P(int code, const char* contentType, PGM_P content);
+  void sendContent(const char* data, size_t length);
+  void sendContent(const String& data) { sendContent(data.c_str(), data.length()); }
+  void sendStream(int code, const char* contentType, Generator generator);
+
+private:
+  enum ConnectionState { CONN_FREE, CONN_READING, CONN_WRITING };
+
+  struct Route {
+    const char* path;
+    HTTPMethod method;
+    Handler handler;
+    bool prefix;
+  };
+
+  struct Connection {
+    WiFiClient client;
+    ConnectionState state = CONN_FREE;
+    unsigned long lastActivity = 0;
+    char request[HTTP_REQUEST_BUFFER_SIZE];
+    size_t requestLength = 0;
+    size_t bodyOffset = 0;
+    HTTPMethod method = HTTP_ANY;
+    const char* path = nullptr;
+    size_t pathLength = 0;
+    const char* query = nullptr;
+    size_t queryLength = 0;
+    String head;
+    String body;
+    PGM_P staticBody = nullptr;
+    size_t staticLength = 0;
+    Generator generator = nullptr;
+    uint32_t cursor = 0;
+    size_t sent = 0;
+  };
+
+  WiFiServer listener;
+  Route routes[HTTP_MAX_ROUTES];
+  int routeCount = 0;
+  Connection connections[HTTP_MAX_CONNECTIONS];
+  Connection* current = nullptr;
+  String pendingHeaders;
+  size_t pendingContentLength = CONTENT_LENGTH_UNKNOWN;
+
+  void accept();
+  Connection* freeConnection();
+  void readRequest(Connection& c);
+  bool parseRequest(Connection& c);
+  void dispatch(Connection& c);
+  void writeResponse(Connection& c);
+  bool drain(Connection& c);
+  void beginResponse(Connection& c, int code, const char* contentType, size_t length);
+  void close(Connection& c);
+  void reject(WiFiClient& client, int code, const char* message);
+  const char* findHeader(const Connection& c, const char* name, size_t* length) const;
+};
+
 // --- GLOBAL VARIABLES ---
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
-ESP8266WebServer server(80);
-enum View { CLOCK_VIEW, DATE_VIEW, WEATHER_VIEW, QUOTE_VIEW, SUN_TIMES_VIEW, MOON_VIEW, FORECAST_VIEW, SYSTEM_INFO_VIEW };
+DashboardServer server(80);
+enum View { CLOCK_VIEW, DATE_VIEW, WEATHER_VIEW, QUOTE_VIEW, SUN_TIMES_VIEW, MOON_VIEW, FORECAST_VIEW, SYSTEM_INFO_VIEW, VIEW_COUNT };
 View currentView = CLOCK_VIEW;
-const int TOTAL_SLIDESHOW_VIEWS = 8;
 unsigned long lastViewChangeTime = 0;
-String weatherTemp = "N/A";
+enum TaskId { TASK_HTTP, TASK_WIFI, TASK_TIME, TASK_JOBS, TASK_HEAP, TASK_SKY, TASK_DISPLAY, TASK_RTC, TASK_WEATHER, TASK_LOG, TASK_COUNT };
+
+// Per-view settings, saved in the config record. A view's seconds of 0
+// means it follows viewDuration.
+uint8_t viewEnabledMask = (1 << VIEW_COUNT) - 1;
+uint8_t viewSeconds[VIEW_COUNT];
+TimeContext frameTime;
+char wifiSsid[33] = "";
+int currentQuoteIndex = 0;
 float previousTemp = -100.0;
-int weatherCode = -1;
 bool shouldSaveConfig = false;
 
-// Sun Times
-String sunriseTime = "N/A";
-String sunsetTime = "N/A";
-unsigned long lastSunFetch = 0;
-const unsigned long SUN_FETCH_INTERVAL = 3600000;
+// Weather, filled once per fetch and read directly by views and /api.
+// Temperatures are tenths of a degree Celsius and dates are packed by
+// packDate().
+const int16_t TEMP_UNKNOWN = INT16_MIN;
+const int16_t MINUTE_UNKNOWN = -1;
+const int16_t CODE_UNKNOWN = -1;
+const int FORECAST_DAYS = 3;
+
+struct ForecastDay {
+  uint16_t date;
+  int16_t maxDeci;
+  int16_t minDeci;
+  int16_t code;
+};
+
+struct WeatherSnapshot {
+  int16_t tempDeci;
+  int16_t code;
+  ForecastDay forecast[FORECAST_DAYS];
+};
+
+WeatherSnapshot weather = {
+  TEMP_UNKNOWN, CODE_UNKNOWN,
+  {{0, TEMP_UNKNOWN, TEMP_UNKNOWN, CODE_UNKNOWN},
+   {0, TEMP_UNKNOWN, TEMP_UNKNOWN, CODE_UNKNOWN},
+   {0, TEMP_UNKNOWN, TEMP_UNKNOWN, CODE_UNKNOWN}}
+};
+time_t weatherFetchedAt = 0;  // clock at the last successful fetch, 0 if unknown
+
+// Sun Times, computed on the device for the local date (see updateSolarDay).
+// Minutes since local midnight; MINUTE_UNKNOWN when the sun does not cross
+// that altitude today (polar day or night).
+struct SolarDay {
+  uint16_t date;  // packed, 0 until computed
+  float latitude;
+  float longitude;
+  int16_t dawnMinute;  // civil twilight begins
+  int16_t sunriseMinute;
+  int16_t noonMinute;
+  int16_t sunsetMinute;
+  int16_t duskMinute;  // civil twilight ends
+};
+
+SolarDay solarDay = {0, 0, 0, MINUTE_UNKNOWN, MINUTE_UNKNOWN, MINUTE_UNKNOWN, MINUTE_UNKNOWN, MINUTE_UNKNOWN};
+uint32_t solarComputeCycles = 0;  // CPU cycles of the latest computeSolarDay(), for /metrics
+
+// Moon Phase, recomputed hourly (see updateMoon)
+struct MoonState {
+  time_t computedAt;  // 0 until the clock is set
+  uint8_t phase;      // 0-7, index into MOON_PHASE_NAMES
+  uint8_t illumination;  // percent of the disc lit
+  uint16_t ageDeci;   // tenths of a day since the last new moon
+  time_t lastNewMoon;
+  time_t nextNewMoon;
+  time_t nextFullMoon;
+};
 
-// Moon Phase
-int moonPhase = 0;
-float moonIllumination = 0.0;
+MoonState moon = {};
 
 // Extended Forecast (3-day)
-String forecastDays[3] = {"", "", ""};
-float forecastMaxTemps[3] = {0, 0, 0};
-float forecastMinTemps[3] = {0, 0, 0};
-int forecastCodes[3] = {-1, -1, -1};
 unsigned long lastForecastFetch = 0;
 const unsigned long FORECAST_FETCH_INTERVAL = 21600000;
 
 // System Info
 unsigned long bootTime = 0;
 
+// Last write of the RTC state block (see saveRtcState)
+const unsigned long RTC_SAVE_INTERVAL = 10000;
+
+// WiFi link, driven by updateWifi()
+enum WifiState { WIFI_UP, WIFI_FAST_RETRY, WIFI_SCAN_RETRY, WIFI_BACKOFF, WIFI_PORTAL, WIFI_STATE_COUNT };
+const char WIFI_STATE_NAMES[WIFI_STATE_COUNT][8] PROGMEM = {"up", "fast", "scan", "backoff", "portal"};
+WifiState wifiState = WIFI_UP;
+unsigned long wifiDownSince = 0;
+uint32_t wifiDisconnects = 0;
+uint32_t wifiLastConnectMs = 0;  // latest (re)connect
+bool wifiLastConnectFast = false;
+
 // --- QUOTES (Shortened for legibility) ---
 const int NUM_QUOTES = 26;
-const char* quotes[NUM_QUOTES] = {
+const int QUOTE_MAX_LEN = 28;
+const char quotes[NUM_QUOTES][QUOTE_MAX_LEN] PROGMEM = {
   "Love what you do.",
   "Believe you can.",
   "Follow your dreams.",
@@ -105,8 +351,243 @@ const char* quotes[NUM_QUOTES] = {
 };
 
 
+// --- METRICS ---
+// Hot-path timings and counters for /metrics. Everything is fixed-size and
+// recorded in microseconds; histograms keep per-bucket (non-cumulative)
+// counts and are only summed up when scraped.
+const int MAX_HISTOGRAM_BUCKETS = 10;
+const int MAX_STATUS_CODES = 8;
+
+struct Histogram {
+  const uint32_t* boundsUs;
+  uint8_t bucketCount;
+  uint32_t buckets[MAX_HISTOGRAM_BUCKETS];
+  uint32_t count;
+  uint64_t sumUs;
+
+  void observe(uint32_t us) {
+    uint8_t i = 0;
+    while (i < bucketCount && us > boundsUs[i]) i++;
+    buckets[i]++;  // index bucketCount is +Inf
+    count++;
+    sumUs += us;
+  }
+};
+
+struct TimingSummary {
+  uint32_t count;
+  uint64_t sumUs;
+  uint32_t maxUs;
+
+  void observe(uint32_t us) {
+    count++;
+    sumUs += us;
+    if (us > maxUs) maxUs = us;
+  }
+};
+
+struct StatusCounter {
+  int16_t codes[MAX_STATUS_CODES];
+  uint32_t counts[MAX_STATUS_CODES];
+  uint8_t used;
+
+  void increment(int code) {
+    for (uint8_t i = 0; i < used; i++) {
+      if (codes[i] == code) {
+        counts[i]++;
+        return;
+      }
+    }
+    if (used < MAX_STATUS_CODES) {
+      codes[used] = code;
+      counts[used++] = 1;
+    }
+  }
+};
+
+enum FetchTarget { FETCH_WEATHER, FETCH_GEOCODE, FETCH_TARGET_COUNT };
+const char FETCH_TARGET_NAMES[FETCH_TARGET_COUNT][8] PROGMEM = {"weather", "geocode"};
+
+const uint32_t FETCH_BUCKETS_US[] = {250000, 500000, 1000000, 2000000, 5000000, 10000000};
+const uint32_t LOOP_BUCKETS_US[] = {250, 1000, 5000, 10000, 50000, 100000, 250000, 1000000, 5000000};
+
+Histogram fetchLatency[FETCH_TARGET_COUNT] = {
+  {FETCH_BUCKETS_US, 6, {}, 0, 0},
+  {FETCH_BUCKETS_US, 6, {}, 0, 0},
+};
+StatusCounter fetchStatus[FETCH_TARGET_COUNT];
+uint32_t parseFailures[FETCH_TARGET_COUNT];
+Histogram loopPeriod = {LOOP_BUCKETS_US, 9, {}, 0, 0};
+Histogram wifiConnectTime = {FETCH_BUCKETS_US, 6, {}, 0, 0};
+TimingSummary renderTime[VIEW_COUNT];
+TimingSummary displayFlushTime;
+StatusCounter httpResponses;
+
+enum ApiFormat { API_FORMAT_JSON, API_FORMAT_MSGPACK, API_FORMAT_COUNT };
+const char API_FORMAT_NAMES[API_FORMAT_COUNT][8] PROGMEM = {"json", "msgpack"};
+TimingSummary apiEncodeTime[API_FORMAT_COUNT];
+uint32_t apiPayloadBytes[API_FORMAT_COUNT];
+
+// Heap health. The largest free block is checked every HEAP_CHECK_INTERVAL
+// for a low watermark, and an hourly sample goes into a ring buffer so the
+// slow fragmentation of weeks of uptime shows up as a trend.
+const int HEAP_SAMPLES = 24;
+const unsigned long HEAP_SAMPLE_INTERVAL = 3600000;
+const unsigned long HEAP_CHECK_INTERVAL = 10000;
+
+struct HeapSample {
+  uint16_t freeHeap;
+  uint16_t maxBlock;
+  uint8_t fragmentation;  // percent
+};
+
+HeapSample heapHistory[HEAP_SAMPLES];
+uint8_t heapHistoryHead = 0;   // next slot to write
+uint8_t heapHistoryCount = 0;
+uint32_t heapSamplesTaken = 0;
+uint16_t heapMinMaxBlock = UINT16_MAX;
+
+HeapSample readHeap() {
+  HeapSample sample;
+  sample.freeHeap = min<uint32_t>(ESP.getFreeHeap(), UINT16_MAX);
+  sample.maxBlock = min<uint32_t>(ESP.getMaxFreeBlockSize(), UINT16_MAX);
+  sample.fragmentation = ESP.getHeapFragmentation();
+  return sample;
+}
+
+// Oldest first, i in [0, heapHistoryCount)
+const HeapSample& heapHistoryAt(uint8_t i) {
+  return heapHistory[(heapHistoryHead + HEAP_SAMPLES - heapHistoryCount + i) % HEAP_SAMPLES];
+}
+
+// Runs every HEAP_CHECK_INTERVAL as a scheduler task
+void updateHeapStats() {
+  static unsigned long lastSample = 0;
+  unsigned long now = millis();
+  HeapSample sample = readHeap();
+  if (sample.maxBlock < heapMinMaxBlock) heapMinMaxBlock = sample.maxBlock;
+
+  if (heapSamplesTaken == 0 || now - lastSample >= HEAP_SAMPLE_INTERVAL) {
+    lastSample = now;
+    heapHistory[heapHistoryHead] = sample;
+    heapHistoryHead = (heapHistoryHead + 1) % HEAP_SAMPLES;
+    if (heapHistoryCount < HEAP_SAMPLES) heapHistoryCount++;
+    heapSamplesTaken++;
+  }
+}
+
+// Boot timeline: millis() at which each phase finished, 0 while pending or
+// skipped; a phase done in the first millisecond is stamped 1. millis()
+// counts from reset, so the ROM/SDK boot is included. setup() only brings
+// up the display and config and draws the first frame; WiFi, the web
+// server, time sync and the first fetch follow from loop(). The first fetch
+// runs as a background job, the only job whose geocode and fetch count as
+// boot phases.
+enum BootPhase {
+  BOOT_DISPLAY, BOOT_CONFIG, BOOT_WIFI, BOOT_SERVER, BOOT_FIRST_FRAME,
+  BOOT_TIME, BOOT_GEOCODE, BOOT_WEATHER, BOOT_READY, BOOT_PHASE_COUNT
+};
+const char BOOT_PHASE_NAMES[BOOT_PHASE_COUNT][11] PROGMEM = {
+  "display", "config", "wifi", "server", "firstFrame", "time", "geocode", "weather", "ready"
+};
+uint32_t bootPhaseMs[BOOT_PHASE_COUNT];
+int bootJobId = -1;  // the job setup() queued, until it finishes
+
+void markBootPhase(BootPhase phase) {
+  if (bootPhaseMs[phase] != 0) return;
+  bootPhaseMs[phase] = max<uint32_t>(millis(), 1);
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+  char name[sizeof(BOOT_PHASE_NAMES[0])];
+  strlcpy_P(name, BOOT_PHASE_NAMES[phase], sizeof(name));
+  LOG_INFO("Boot: %s at %u ms", name, (unsigned)bootPhaseMs[phase]);
+#endif
+}
+
+// Build + serialize time per /api format, also reported as Server-Timing
+void recordApiEncode(ApiFormat format, uint32_t us, size_t bytes) {
+  apiEncodeTime[format].observe(us);
+  apiPayloadBytes[format] = bytes;
+  server.sendHeader("Server-Timing", "encode;dur=" + String(us / 1000.0, 3));
+}
+
+// --- TRACING ---
+// Begin/end events of a few slow paths go into a RAM ring buffer that
+// /trace dumps in Chrome trace format (load it in chrome://tracing or
+// Perfetto). An event is the CPU cycle counter plus two bytes, so a span
+// costs a few dozen cycles. Build with -DTRACE_ENABLED=0 to compile the
+// spans out entirely.
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+enum TraceName : uint8_t {
+  TRACE_FETCH_WEATHER, TRACE_FETCH_GEOCODE, TRACE_DRAW_VIEW, TRACE_DISPLAY_FLUSH,
+  TRACE_HANDLE_API, TRACE_HANDLE_ROOT, TRACE_SAVE_CONFIG, TRACE_NAME_COUNT
+};
+
+#if TRACE_ENABLED
+const char TRACE_NAMES[TRACE_NAME_COUNT][20] PROGMEM = {
+  "fetchWeatherData", "fetchGeocodingData", "drawView", "display", "handleAPI", "handleRoot", "saveConfig"
+};
+const uint32_t TRACE_EVENTS = 128;  // power of two; 8 bytes each
+static_assert((TRACE_EVENTS & (TRACE_EVENTS - 1)) == 0, "TRACE_EVENTS must be a power of two");
+
+struct TraceEvent {
+  uint32_t cycles;
+  uint16_t wraps;  // cycle counter overflows (every ~54 s at 80 MHz) before it
+  uint8_t name;
+  char phase;      // 'B' or 'E'
+};
+
+TraceEvent traceEvents[TRACE_EVENTS];
+uint32_t traceCount = 0;  // events ever recorded; the newest is traceCount - 1
+uint32_t traceLastCycles = 0;
+uint16_t traceWraps = 0;
+
+// Also called every loop() pass so no overflow goes unseen between events
+inline uint32_t traceClock() {
+  uint32_t cycles = ESP.getCycleCount();
+  if (cycles < traceLastCycles) traceWraps++;
+  traceLastCycles = cycles;
+  return cycles;
+}
+
+inline void traceRecord(uint8_t name, char phase) {
+  uint32_t cycles = traceClock();
+  TraceEvent& event = traceEvents[traceCount++ & (TRACE_EVENTS - 1)];
+  event.cycles = cycles;
+  event.wraps = traceWraps;
+  event.name = name;
+  event.phase = phase;
+}
+
+struct TraceSpan {
+  uint8_t name;
+  explicit TraceSpan(uint8_t name) : name(name) { traceRecord(name, 'B'); }
+  ~TraceSpan() { traceRecord(name, 'E'); }
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_BEGIN(name) traceRecord(name, 'B')
+#define TRACE_END(name) traceRecord(name, 'E')
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)  // until the end of the scope
+#define TRACE_TICK() traceClock()
+#else
+#define TRACE_BEGIN(name) do {} while (0)
+#define TRACE_END(name) do {} while (0)
+#define TRACE_SPAN(name) do {} while (0)
+#define TRACE_TICK() do {} while (0)
+#endif
+
 // --- FORWARD DECLARATIONS ---
 void drawView(View view);
+void renderView(View view);
+bool isViewEnabled(int view);
+View nextEnabledView(View view);
+unsigned long viewDurationMs(View view);
+bool viewNeedsRedraw(View view);
+void requestViewRedraw();
 void drawClockView();
 void drawDateView();
 void drawWeatherView();
@@ -115,33 +596,65 @@ void drawSunTimesView();
 void drawMoonView();
 void drawForecastView();
 void drawSystemInfoView();
-void setupTime();
-String getFormattedTimeHHMM();
-String getFormattedDate();
-String getDayOfWeek();
-void fetchWeatherData();
-void fetchGeocodingData(String city);
-int calculateMoonPhase();
-String getMoonPhaseName(int phase);
+void startNetworkTime();
+void applyTimeZone();
+void updateNetworkTime();
+void captureTime(TimeContext& t);
+void updateSolarDay(const TimeContext& t);
+const char* formatTimeHHMM(const TimeContext& t, char* out, size_t size);
+const char* formatDate(const TimeContext& t, char* out, size_t size);
+const char* formatDayOfWeek(const TimeContext& t, char* out, size_t size);
+bool fetchWeatherData();
+bool fetchGeocodingData(String city);
+void updateMoon(const TimeContext& t);
+const __FlashStringHelper* getMoonPhaseName(int phase);
 void drawMoonIcon(int x, int y, int phase);
 float celsiusToFahrenheit(float celsius);
-String formatTemperature(float tempC, bool showBoth);
-String calculateDayLength();
-String calculateTimeUntilSunset();
-String getUptime();
+int16_t toDeciDegrees(float celsius);
+float fromDeciDegrees(int16_t deci);
+char* formatWholeDegrees(int16_t deci, char* out, size_t size);
+int parseMinuteOfDay(const char* hhmm);
+const char* formatMinuteOfDay(int16_t minute, char* out, size_t size);
+uint16_t packDate(int year, int month, int day);
+uint16_t parsePackedDate(const char* iso);
+const char* formatPackedDate(uint16_t date, char* out, size_t size);
+const char* formatDayLength(char* out, size_t size);
+const char* formatTimeUntilSunset(const TimeContext& t, char* out, size_t size);
+const char* formatUptime(char* out, size_t size);
 int getWiFiSignalStrength();
-String getWiFiSignalBars();
-String getWeatherDescription(int weatherCode);
+const __FlashStringHelper* getWiFiSignalBars();
+const __FlashStringHelper* getWeatherDescription(int weatherCode);
 void saveConfigCallback();
+const uint32_t FNV_OFFSET_BASIS = 2166136261UL;
+uint32_t fnv1a(uint32_t hash, const void* data, size_t length);
+uint32_t fnv1a(uint32_t hash, int32_t value);
 void loadConfig();
-void saveConfig();
+bool saveConfig();
+void startWifi();
+void recordWifiConnect(unsigned long start, bool fast);
+void updateWifi();
+bool restoreRtcState();
+void saveRtcState();
+bool weatherIsFresh();
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t len);
 void updateWeatherUrl();
 void setupWebServer();
 void handleRoot();
 void handleAPI();
 void handleSettings();
 void handleSettingsSave();
-String getWebInterface();
+void handleJobStatus();
+int queueSettingsJob(bool geocode, bool save = true);
+void runJobs();
+void runTasks();
+void startTasks();
+void scheduleTask(TaskId id, uint32_t delayMs);
+void handleScreenPBM();
+void handleScreenPNG();
+void handleMetrics();
+void handleTrace();
+void handleLog();
+const char* getWebInterface();
 
 // --- SETUP ---
 void setup() {
@@ -159,182 +672,296 @@ void setup() {
   display.setTextSize(1);
   display.setTextColor(WHITE);
   display.setCursor(0,0);
-  display.println("Starting up...");
+  display.println(F("Starting up..."));
   display.display();
+  markBootPhase(BOOT_DISPLAY);
 
   if (LittleFS.begin()) {
     loadConfig();
   }
+  bool warmStart = restoreRtcState();
+  markBootPhase(BOOT_CONFIG);
 
-  WiFiManager wifiManager;
-  wifiManager.setSaveConfigCallback(saveConfigCallback);
+  if (strlen(displayName) == 0) {
+    strcpy(displayName, cityName);
+  }
 
-  char durationStr[5];
-  sprintf(durationStr, "%d", viewDuration / 1000);
-  char manualStr[2];
-  sprintf(manualStr, "%d", manualCoordinates ? 1 : 0);
-
-  WiFiManagerParameter custom_city("city", "City, Country", cityName, 50);
-  WiFiManagerParameter custom_display("display", "Display Name (optional)", displayName, 30);
-  WiFiManagerParameter custom_temp("temp", "Temp Unit (C/F/B)", tempUnit, 2);
-  WiFiManagerParameter custom_duration("duration", "View Duration (sec)", durationStr, 4);
-  WiFiManagerParameter custom_manual("manual", "Manual Coords? (0/1)", manualStr, 2);
-  WiFiManagerParameter custom_lat("lat", "Latitude (if manual)", latitude, 10);
-  WiFiManagerParameter custom_lon("lon", "Longitude (if manual)", longitude, 10);
-
-  wifiManager.addParameter(&custom_city);
-  wifiManager.addParameter(&custom_display);
-  wifiManager.addParameter(&custom_temp);
-  wifiManager.addParameter(&custom_duration);
-  wifiManager.addParameter(&custom_manual);
-  wifiManager.addParameter(&custom_lat);
-  wifiManager.addParameter(&custom_lon);
-
-  // Show WiFi setup message on display
-  display.clearDisplay();
-  display.setTextSize(1);
-  display.setCursor(0, 0);
-  display.println("WiFi Setup Mode");
-  display.println("");
-  display.println("Connect to:");
-  display.setTextSize(2);
-  display.println("ESP-Config");
-  display.setTextSize(1);
-  display.println("");
-  display.println("Then open:");
-  display.println("192.168.4.1");
-  display.display();
+  // Time sync, geocoding and the first fetch all wait for the link from
+  // loop(), and all start on the pass it comes up
+  startNetworkTime();
+  if (!weatherIsFresh()) {
+    LOG_INFO("=== Queueing initial weather fetch ===");
+    bootJobId = queueSettingsJob(false, false);
+  } else {
+    LOG_INFO("Weather restored from RTC memory, skipping initial fetch");
+  }
 
-  if (!wifiManager.autoConnect("ESP-Config")) {
-    ESP.reset();
+  if (!warmStart) {
+    currentView = CLOCK_VIEW;
+    currentQuoteIndex = random(NUM_QUOTES);
+  }
+  if (!isViewEnabled(currentView)) {
+    currentView = nextEnabledView(currentView);
   }
+  drawView(currentView);
+  lastViewChangeTime = millis();
+  startTasks();
+  startWifi();
+}
 
-  // Show connected message
-  display.clearDisplay();
-  display.setTextSize(1);
-  display.setCursor(0, 0);
-  display.println("WiFi Connected!");
-  display.println("");
-  display.print("SSID: ");
-  display.println(WiFi.SSID());
-  display.print("IP: ");
-  display.println(WiFi.localIP());
-  display.display();
-  delay(2000);
+// --- MAIN LOOP ---
+void loop() {
+  static uint32_t lastLoopStart = micros();
+  uint32_t loopStart = micros();
+  loopPeriod.observe(loopStart - lastLoopStart);
+  lastLoopStart = loopStart;
+  TRACE_TICK();
 
-  strcpy(cityName, custom_city.getValue());
-  strcpy(displayName, custom_display.getValue());
-  strcpy(tempUnit, custom_temp.getValue());
-  viewDuration = atoi(custom_duration.getValue()) * 1000;
-  manualCoordinates = (atoi(custom_manual.getValue()) == 1);
+  runTasks();
+}
 
-  if (manualCoordinates) {
-    strcpy(latitude, custom_lat.getValue());
-    strcpy(longitude, custom_lon.getValue());
-    Serial.println("Using manual coordinates");
-  } else {
-    fetchGeocodingData(String(cityName));
+// --- TASK SCHEDULER ---
+// Cooperative: every loop() pass runs the tasks that are due, in table
+// order, each to completion. Per task it records how late it started
+// (for tasks run every pass, the gap since their previous run), how long
+// it ran, and how often it blew its time budget or start deadline, so
+// /metrics shows which task holds up the web server or the display.
+const unsigned long WEATHER_UPDATE_INTERVAL = 600000;
+
+void serveHttp() { server.handleClient(); }
+
+// Sun times for the new day and the hourly moon; retried every second
+// until the clock is set
+void updateSky() {
+  TimeContext now;
+  captureTime(now);
+  if (now.valid) markBootPhase(BOOT_TIME);
+  updateSolarDay(now);
+  updateMoon(now);
+  if (solarDay.date == 0) {
+    scheduleTask(TASK_SKY, 1000);
   }
+}
 
-  if (strlen(displayName) == 0) {
-    strcpy(displayName, cityName);
+void updateDisplay() {
+  if (wifiState == WIFI_PORTAL) return;  // the setup screen stays up
+  if (millis() - lastViewChangeTime > viewDurationMs(currentView)) {
+    currentView = nextEnabledView(currentView);
+    if (currentView == QUOTE_VIEW) {
+      currentQuoteIndex = random(NUM_QUOTES);
+    }
+    drawView(currentView);
+    lastViewChangeTime = millis();
+    saveRtcState();
+  } else if (viewNeedsRedraw(currentView)) {
+    drawView(currentView);
   }
+}
 
-  if (shouldSaveConfig) {
-    saveConfig();
-  }
+void refreshWeather() { fetchWeatherData(); }
+
+struct TaskDescriptor {
+  void (*run)();
+  uint32_t periodMs;    // 0: every pass
+  uint32_t budgetUs;    // expected longest run
+  uint32_t deadlineMs;  // longest acceptable start delay
+};
+
+// Weather fetches and job steps block on the network, hence their budgets
+const TaskDescriptor TASKS[TASK_COUNT] = {
+  {serveHttp, 0, 20000, 50},
+  {updateWifi, 100, 5000, 1000},
+  {updateNetworkTime, 50, 2000, 500},
+  {runJobs, 0, 10000000, 1000},
+  {updateHeapStats, HEAP_CHECK_INTERVAL, 1000, 5000},
+  {updateSky, 60000, 5000, 5000},
+  {updateDisplay, 50, 40000, 100},
+  {saveRtcState, RTC_SAVE_INTERVAL, 2000, 5000},
+  {refreshWeather, WEATHER_UPDATE_INTERVAL, 10000000, 60000},
+  {drainLog, 10, 500, 100},
+};
+
+// Metric labels, in TASKS order
+const char TASK_NAMES[TASK_COUNT][8] PROGMEM = {
+  "http", "wifi", "time", "jobs", "heap", "sky", "display", "rtc", "weather", "log"
+};
 
-  updateWeatherUrl();
+const uint32_t LATENESS_BUCKETS_US[] = {100, 1000, 5000, 20000, 100000, 500000, 2000000};
 
-  Serial.println("Configuring time...");
-  configTime(timezone, NTP_SERVER);
+struct TaskState {
+  uint32_t nextDueUs;
+  Histogram lateness;
+  TimingSummary runTime;
+  uint32_t overruns;
+  uint32_t deadlineMisses;
+};
+
+TaskState taskState[TASK_COUNT];
 
-  // Wait for time sync
-  Serial.println("Waiting for time synchronization...");
-  int timeAttempts = 0;
-  struct tm timeinfo;
-  while (!getLocalTime(&timeinfo) && timeAttempts < 10) {
-    delay(500);
-    timeAttempts++;
+void startTasks() {
+  uint32_t now = micros();
+  for (int i = 0; i < TASK_COUNT; i++) {
+    taskState[i].nextDueUs = now;
+    taskState[i].lateness = {LATENESS_BUCKETS_US, 7, {}, 0, 0};
   }
+  scheduleTask(TASK_WEATHER, WEATHER_UPDATE_INTERVAL);  // setup() covers the first fetch
+}
 
-  if (!getLocalTime(&timeinfo)) {
-    Serial.println("WARNING: Failed to obtain time");
-  } else {
-    Serial.printf("Time synchronized: %s %s\n", getDayOfWeek().c_str(), getFormattedTimeHHMM().c_str());
+// Moves a task's next run; a task may call this for itself while running
+void scheduleTask(TaskId id, uint32_t delayMs) {
+  taskState[id].nextDueUs = micros() + delayMs * 1000;
+}
+
+void runTasks() {
+  for (int i = 0; i < TASK_COUNT; i++) {
+    const TaskDescriptor& task = TASKS[i];
+    TaskState& state = taskState[i];
+    uint32_t start = micros();
+    int32_t late = start - state.nextDueUs;
+    if (late < 0) continue;
+
+    // Keep the cadence when slightly late, restart it after a long stall
+    uint32_t periodUs = task.periodMs * 1000;
+    state.nextDueUs = (uint32_t)late < periodUs ? state.nextDueUs + periodUs : start + periodUs;
+    state.lateness.observe(late);
+    if ((uint32_t)late > task.deadlineMs * 1000) state.deadlineMisses++;
+
+    task.run();
+
+    uint32_t ran = micros() - start;
+    state.runTime.observe(ran);
+    if (ran > task.budgetUs) state.overruns++;
   }
+}
+
+// --- VIEW REGISTRY ---
+// Each view declares how it goes stale. Static views are drawn once per
+// visit, per-second views whenever the clock ticks, and on-change views
+// when a fingerprint of the data they show changes (checked once a second).
+enum RefreshPolicy { REFRESH_STATIC, REFRESH_PER_SECOND, REFRESH_ON_CHANGE };
+const char REFRESH_POLICY_NAMES[][7] PROGMEM = {"static", "second", "change"};
+
+enum ViewData : uint8_t {
+  DATA_MINUTE = 1 << 0,   // wall clock minute
+  DATA_DAY = 1 << 1,      // calendar date
+  DATA_WEATHER = 1 << 2,  // current weather and forecast
+  DATA_SKY = 1 << 3,      // sun times and moon
+};
+
+struct ViewDescriptor {
+  void (*render)();
+  RefreshPolicy refresh;
+  uint8_t data;  // ViewData bits an on-change view depends on
+};
 
-  // Ensure WiFi is ready
-  Serial.printf("WiFi status: %d (3=connected)\n", WiFi.status());
-  Serial.printf("WiFi SSID: %s\n", WiFi.SSID().c_str());
-  Serial.printf("WiFi IP: %s\n", WiFi.localIP().toString().c_str());
+const ViewDescriptor VIEWS[VIEW_COUNT] = {
+  {drawClockView, REFRESH_PER_SECOND, 0},
+  {drawDateView, REFRESH_ON_CHANGE, DATA_DAY},
+  {drawWeatherView, REFRESH_ON_CHANGE, DATA_WEATHER},
+  {drawQuoteView, REFRESH_STATIC, 0},
+  {drawSunTimesView, REFRESH_ON_CHANGE, DATA_SKY | DATA_MINUTE},
+  {drawMoonView, REFRESH_ON_CHANGE, DATA_SKY},
+  {drawForecastView, REFRESH_ON_CHANGE, DATA_WEATHER},
+  {drawSystemInfoView, REFRESH_PER_SECOND, 0},
+};
 
-  delay(1000); // Give WiFi some time to stabilize
+// API and metric names, in VIEWS order
+const char VIEW_NAMES[VIEW_COUNT][9] PROGMEM = {
+  "clock", "date", "weather", "quote", "sun", "moon", "forecast", "system"
+};
 
-  Serial.println("=== Fetching initial weather data ===");
-  fetchWeatherData();
+// Settings page and dashboard labels, in VIEWS order
+const char VIEW_TITLES[VIEW_COUNT][12] PROGMEM = {
+  "Clock", "Date", "Weather", "Quote", "Sun Times", "Moon", "Forecast", "System Info"
+};
 
-  setupWebServer();
+time_t viewCheckedSecond = 0;  // clock second of the last draw or data check
+uint32_t viewDrawnStamp = 0;   // data fingerprint the panel was drawn from
+bool viewRedrawPending = false;
 
-  currentView = CLOCK_VIEW;
-  drawView(currentView);
-  lastViewChangeTime = millis();
+bool isViewEnabled(int view) { return viewEnabledMask & (1 << view); }
+
+// Next enabled view in rotation order; the same view when it is the only one
+View nextEnabledView(View view) {
+  for (int i = 1; i <= VIEW_COUNT; i++) {
+    View next = static_cast<View>((view + i) % VIEW_COUNT);
+    if (isViewEnabled(next)) return next;
+  }
+  return view;
 }
 
-// --- MAIN LOOP ---
-void loop() {
-  server.handleClient();
+unsigned long viewDurationMs(View view) {
+  return viewSeconds[view] ? viewSeconds[view] * 1000UL : viewDuration;
+}
 
-  if (millis() - lastViewChangeTime > viewDuration) {
-    View nextView = static_cast<View>((currentView + 1) % TOTAL_SLIDESHOW_VIEWS);
-    currentView = nextView;
-    drawView(currentView);
-    lastViewChangeTime = millis();
+uint32_t viewDataStamp(uint8_t data, time_t now) {
+  uint32_t h = FNV_OFFSET_BASIS;
+  if (data & DATA_MINUTE) h = fnv1a(h, (int32_t)(now / 60));
+  if (data & DATA_DAY) h = fnv1a(h, (int32_t)solarDay.date);
+  if (data & DATA_WEATHER) h = fnv1a(h, &weather, sizeof(weather));
+  if (data & DATA_SKY) {
+    h = fnv1a(h, &solarDay, sizeof(solarDay));
+    h = fnv1a(h, (int32_t)moon.computedAt);
   }
-  if (currentView == CLOCK_VIEW) {
-    drawView(currentView);
-    delay(100);
+  return h;
+}
+
+// Settings changes (units, names, enabled views) affect every view
+void requestViewRedraw() {
+  viewRedrawPending = true;
+  if (!isViewEnabled(currentView)) {
+    lastViewChangeTime = 0;  // rotate away on the next loop
   }
+}
 
-  // Periodic weather updates (every 10 minutes)
-  static unsigned long lastWeatherUpdate = 0;
-  if (millis() - lastWeatherUpdate > 600000) {
-    fetchWeatherData();
-    lastWeatherUpdate = millis();
+bool viewNeedsRedraw(View view) {
+  if (viewRedrawPending) return true;
+  timeval tv;
+  halGetTime(tv);
+  if (tv.tv_sec == viewCheckedSecond) return false;  // nothing changes faster
+  switch (VIEWS[view].refresh) {
+    case REFRESH_PER_SECOND:
+      return true;
+    case REFRESH_ON_CHANGE:
+      viewCheckedSecond = tv.tv_sec;
+      return viewDataStamp(VIEWS[view].data, tv.tv_sec) != viewDrawnStamp;
+    default:
+      return false;
   }
 }
 
 // --- VIEW DRAWING & ICONS ---
 void drawView(View view) {
+  TRACE_SPAN(TRACE_DRAW_VIEW);
+  timeval tv;
+  halGetTime(tv);
+  viewCheckedSecond = tv.tv_sec;
+  viewDrawnStamp = viewDataStamp(VIEWS[view].data, tv.tv_sec);
+  viewRedrawPending = false;
+
+  renderView(view);
+  uint32_t start = micros();
+  TRACE_BEGIN(TRACE_DISPLAY_FLUSH);
+  display.display();
+  TRACE_END(TRACE_DISPLAY_FLUSH);
+  displayFlushTime.observe(micros() - start);
+
+  markBootPhase(BOOT_FIRST_FRAME);
+  if (frameTime.valid && bootPhaseMs[BOOT_READY] == 0) {
+    markBootPhase(BOOT_TIME);
+    markBootPhase(BOOT_READY);  // first frame with real data on the panel
+  }
+}
+
+// Draws a view into the RAM frame buffer only; the panel keeps showing
+// whatever was last pushed with display.display().
+void renderView(View view) {
+  uint32_t start = micros();
+  captureTime(frameTime);
   display.clearDisplay();
   display.setCursor(0, 0);
-  switch (view) {
-    case CLOCK_VIEW:
-      drawClockView();
-      break;
-    case DATE_VIEW:
-      drawDateView();
-      break;
-    case WEATHER_VIEW:
-      drawWeatherView();
-      break;
-    case QUOTE_VIEW:
-      drawQuoteView();
-      break;
-    case SUN_TIMES_VIEW:
-      drawSunTimesView();
-      break;
-    case MOON_VIEW:
-      drawMoonView();
-      break;
-    case FORECAST_VIEW:
-      drawForecastView();
-      break;
-    case SYSTEM_INFO_VIEW:
-      drawSystemInfoView();
-      break;
-  }
-  display.display();
+  VIEWS[view].render();
+  renderTime[view].observe(micros() - start);
 }
 
 void drawClockView() {
@@ -342,9 +969,9 @@ void drawClockView() {
   display.setCursor(0, 0);
   display.println(displayName);
   display.drawFastHLine(0, 12, SCREEN_WIDTH, WHITE);
-  struct tm timeinfo;
-  if (!getLocalTime(&timeinfo)) { return; }
-  String timeStr = getFormattedTimeHHMM();
+  if (!frameTime.valid) { return; }
+  char timeStr[6];
+  formatTimeHHMM(frameTime, timeStr, sizeof(timeStr));
   display.setTextSize(3);
   int16_t x1, y1;
   uint16_t w, h;
@@ -352,20 +979,19 @@ void drawClockView() {
   display.setCursor((SCREEN_WIDTH - w) / 2, 25);
   display.println(timeStr);
   int barHeight = 3;
-  int seconds = timeinfo.tm_sec;
+  int seconds = frameTime.local.tm_sec;
   int barWidth = map(seconds, 0, 59, 0, SCREEN_WIDTH);
   display.fillRect(0, SCREEN_HEIGHT - barHeight, barWidth, barHeight, WHITE);
 }
 
 void drawDateView() {
-  struct tm timeinfo;
-  if (!getLocalTime(&timeinfo)) { return; }
+  if (!frameTime.valid) { return; }
   
   // Draw Month and Calendar Week in top (yellow) section
   char monthStr[12];
   char weekStr[6];
-  strftime(monthStr, sizeof(monthStr), "%B", &timeinfo);
-  strftime(weekStr, sizeof(weekStr), "CW %V", &timeinfo);
+  strftime(monthStr, sizeof(monthStr), "%B", &frameTime.local);
+  strftime(weekStr, sizeof(weekStr), "CW %V", &frameTime.local);
   display.setTextSize(1);
   display.setCursor(2, 2);
   display.print(monthStr);
@@ -374,12 +1000,14 @@ void drawDateView() {
   display.drawFastHLine(0, 12, SCREEN_WIDTH, WHITE);
 
   // Draw Day of Week and Date in bottom (blue) section
+  char dayStr[10];
+  char dateStr[11];
   display.setTextSize(2);
   display.setCursor(5, 20);
-  display.println(getDayOfWeek());
+  display.println(formatDayOfWeek(frameTime, dayStr, sizeof(dayStr)));
   display.setTextSize(1);
   display.setCursor(5, 45);
-  display.println(getFormattedDate());
+  display.println(formatDate(frameTime, dateStr, sizeof(dateStr)));
 }
 
 void drawSun(int x, int y) { display.fillCircle(x + 10, y + 10, 8, WHITE); display.drawLine(x + 10, y, x + 10, y + 20, WHITE); display.drawLine(x, y + 10, x + 20, y + 10, WHITE); display.drawLine(x + 3, y + 3, x + 17, y + 17, WHITE); display.drawLine(x + 3, y + 17, x + 17, y + 3, WHITE); }
@@ -391,25 +1019,26 @@ void drawThunderstorm(int x, int y) { drawCloud(x, y); display.drawLine(x + 10,
 void drawWeatherView() {
   display.setTextSize(1);
   display.setCursor(0, 0);
-  display.println("Current Weather");
+  display.println(F("Current Weather"));
   display.drawFastHLine(0, 12, SCREEN_WIDTH, WHITE);
 
   int iconX = 10;
   int iconY = 18;
 
   // Draw weather icon
-  switch (weatherCode) {
+  switch (weather.code) {
     case 0: case 1: drawSun(iconX, iconY); break;  // Clear & Mainly clear
     case 2: case 3: drawCloud(iconX, iconY); break;  // Partly cloudy & Overcast
     case 45: case 48: drawCloud(iconX, iconY); break;  // Fog
     case 51: case 53: case 55: case 61: case 63: case 65: case 80: case 81: case 82: drawRain(iconX, iconY); break;
     case 71: case 73: case 75: case 77: case 85: case 86: drawSnow(iconX, iconY); break;
     case 95: case 96: case 99: drawThunderstorm(iconX, iconY); break;
-    default: display.setCursor(iconX, iconY); display.println("?"); break;
+    default: display.setCursor(iconX, iconY); display.println('?'); break;
   }
 
   // Temperature (number only in size 3)
-  float tempValue = weatherTemp.toFloat();
+  bool known = weather.tempDeci != TEMP_UNKNOWN;
+  float tempValue = fromDeciDegrees(weather.tempDeci);
   int tempInt;
   if (tempUnit[0] == 'F') {
     float tempF = celsiusToFahrenheit(tempValue);
@@ -420,7 +1049,10 @@ void drawWeatherView() {
 
   // Draw temperature number
   display.setTextSize(3);
-  String tempNumStr = String(tempInt);
+  char tempNumStr[8] = "--";
+  if (known) {
+    snprintf_P(tempNumStr, sizeof(tempNumStr), PSTR("%d"), tempInt);
+  }
   int16_t x1, y1;
   uint16_t w, h;
   display.getTextBounds(tempNumStr, 50, 20, &x1, &y1, &w, &h);
@@ -431,50 +1063,48 @@ void drawWeatherView() {
   display.setTextSize(1);
   display.setCursor(50 + w + 2, 20);
   if (tempUnit[0] == 'F') {
-    display.print("o");
+    display.print('o');
     display.setCursor(50 + w + 8, 20);
-    display.print("F");
+    display.print('F');
   } else {
-    display.print("o");
+    display.print('o');
     display.setCursor(50 + w + 8, 20);
-    display.print("C");
+    display.print('C');
   }
 
   // Weather description below
   display.setTextSize(1);
   display.setCursor(2, 54);
-  String weatherDesc = getWeatherDescription(weatherCode);
-  display.print(weatherDesc);
+  display.print(getWeatherDescription(weather.code));
 
   // Temperature with unit
   display.setCursor(60, 54);
-  if (tempUnit[0] == 'B') {
-    display.print(String(tempValue, 1) + "C");
-    display.print("/");
-    float tempF = celsiusToFahrenheit(tempValue);
-    display.print(String(tempF, 0) + "F");
+  char tempText[16];
+  float tempF = celsiusToFahrenheit(tempValue);
+  if (!known) {
+    strlcpy_P(tempText, PSTR("N/A"), sizeof(tempText));
+  } else if (tempUnit[0] == 'B') {
+    snprintf_P(tempText, sizeof(tempText), PSTR("%.1fC/%.0fF"), tempValue, tempF);
   } else if (tempUnit[0] == 'F') {
-    float tempF = celsiusToFahrenheit(tempValue);
-    display.print(String(tempF, 1) + "F");
+    snprintf_P(tempText, sizeof(tempText), PSTR("%.1fF"), tempF);
   } else {
-    display.print(String(tempValue, 1) + "C");
+    snprintf_P(tempText, sizeof(tempText), PSTR("%.1fC"), tempValue);
   }
+  display.print(tempText);
 }
 
 void drawQuoteView() {
   // Draw WiFi SSID in top (yellow) section
   display.setTextSize(1);
   display.setCursor(2, 2);
-  String ssid = WiFi.SSID();
-  display.println(ssid);
+  display.println(wifiSsid);
   display.drawFastHLine(0, 12, SCREEN_WIDTH, WHITE);
 
   // Draw quote in bottom (blue) section with word wrapping
-  int quoteIndex = random(NUM_QUOTES);
-  const char* quote = quotes[quoteIndex];
-
-  String text = String(quote);
-  int textLen = text.length();
+  // (picked on view change so snapshots re-render the same quote)
+  char text[QUOTE_MAX_LEN];
+  strlcpy_P(text, quotes[currentQuoteIndex], sizeof(text));
+  int textLen = strlen(text);
   
   // Choose font size based on quote length
   // Size 2: ~50-70 chars fit, line height ~16px, fits ~2 lines
@@ -486,22 +1116,23 @@ void drawQuoteView() {
   // Size 2: ~2 lines + padding = 40px, so center it (start at ~12px)
   // Size 1: ~3 lines + padding = 28px, so give more space (start at ~18px)
   int cursorY = (fontSize == 2) ? 18 : 18;
-  int availableHeight = SCREEN_HEIGHT - cursorY;
   
   display.setTextSize(fontSize);
   int cursorX = 5;
   int maxWidth = SCREEN_WIDTH - 10; // Leave margins
 
   int startIndex = 0;
+  char line[64];
 
-  while (startIndex < text.length() && cursorY < SCREEN_HEIGHT) {
+  while (startIndex < textLen && cursorY < SCREEN_HEIGHT) {
     // Find how much text fits on current line
     int endIndex = startIndex;
     int lastSpaceIndex = -1;
-    String testLine = "";
+    int lineLen = 0;
 
-    while (endIndex < text.length()) {
-      testLine += text[endIndex];
+    while (endIndex < textLen && lineLen < (int)sizeof(line) - 1) {
+      line[lineLen++] = text[endIndex];
+      line[lineLen] = '\0';
 
       // Track last space position for word breaking
       if (text[endIndex] == ' ') {
@@ -511,7 +1142,7 @@ void drawQuoteView() {
       // Check if line width exceeds max width
       int16_t x1, y1;
       uint16_t w, h;
-      display.getTextBounds(testLine, 0, 0, &x1, &y1, &w, &h);
+      display.getTextBounds(line, 0, 0, &x1, &y1, &w, &h);
 
       if (w > maxWidth) {
         // Line is too long, break at last space if available
@@ -526,9 +1157,13 @@ void drawQuoteView() {
       endIndex++;
     }
 
-    // Draw the line
-    String line = text.substring(startIndex, endIndex);
-    line.trim(); // Remove leading/trailing spaces
+    // Draw the line without leading/trailing spaces
+    int from = startIndex;
+    int to = endIndex;
+    while (from < to && text[from] == ' ') from++;
+    while (to > from && text[to - 1] == ' ') to--;
+    memcpy(line, text + from, to - from);
+    line[to - from] = '\0';
     display.setCursor(cursorX, cursorY);
     display.println(line);
 
@@ -537,7 +1172,7 @@ void drawQuoteView() {
     startIndex = endIndex;
 
     // Skip spaces at the start of next line
-    while (startIndex < text.length() && text[startIndex] == ' ') {
+    while (startIndex < textLen && text[startIndex] == ' ') {
       startIndex++;
     }
   }
@@ -546,7 +1181,7 @@ void drawQuoteView() {
 void drawSunTimesView() {
   display.setTextSize(1);
   display.setCursor(2, 2);
-  display.println("Sun Times");
+  display.println(F("Sun Times"));
   display.drawFastHLine(0, 12, SCREEN_WIDTH, WHITE);
 
   // Rise row
@@ -556,9 +1191,10 @@ void drawSunTimesView() {
   display.drawLine(0, sunIconY, 1, sunIconY, WHITE);            // Left ray
   display.drawLine(7, sunIconY, 8, sunIconY, WHITE);            // Right ray
   
+  char hhmm[6];
   display.setCursor(12, 20);
-  display.print("Rise ");
-  display.println(sunriseTime);
+  display.print(F("Rise "));
+  display.println(formatMinuteOfDay(solarDay.sunriseMinute, hhmm, sizeof(hhmm)));
 
   // Set row
   sunIconY = 32;
@@ -568,53 +1204,58 @@ void drawSunTimesView() {
   display.drawLine(7, sunIconY, 8, sunIconY, WHITE);            // Right ray
   
   display.setCursor(12, 30);
-  display.print("Set  ");
-  display.println(sunsetTime);
+  display.print(F("Set  "));
+  display.println(formatMinuteOfDay(solarDay.sunsetMinute, hhmm, sizeof(hhmm)));
 
   // Day length
+  char duration[12];
   display.setCursor(2, 44);
-  display.print("Length: ");
-  display.println(calculateDayLength());
+  display.print(F("Length: "));
+  display.println(formatDayLength(duration, sizeof(duration)));
 
   // Time until sunset
   display.setCursor(2, 54);
-  display.print("Left: ");
-  String timeLeft = calculateTimeUntilSunset();
-  display.println(timeLeft);
+  display.print(F("Left: "));
+  display.println(formatTimeUntilSunset(frameTime, duration, sizeof(duration)));
 }
 
 void drawMoonView() {
-  moonPhase = calculateMoonPhase();
-
   display.setTextSize(1);
   display.setCursor(2, 2);
-  display.println("Moon Phase");
+  display.println(F("Moon Phase"));
   display.drawFastHLine(0, 12, SCREEN_WIDTH, WHITE);
 
   // Draw moon icon on left side
   int moonX = 5;
   int moonY = 18;
-  drawMoonIcon(moonX, moonY, moonPhase);
+  drawMoonIcon(moonX, moonY, moon.phase);
+
+  if (moon.computedAt == 0) {
+    display.setCursor(2, 40);
+    display.println(F("Waiting for time"));
+    return;
+  }
 
   // Illumination percentage next to moon icon
-  int illuminationPct = (int)(moonIllumination * 100);
   display.setTextSize(1);
   display.setCursor(moonX + 20, 22);
-  display.print(illuminationPct);
-  display.print("%");
+  display.print(moon.illumination);
+  display.print('%');
 
   // Phase name (left-aligned, size 1 to prevent truncation)
   display.setTextSize(1);
-  String phaseName = getMoonPhaseName(moonPhase);
   display.setCursor(2, 40);
-  display.println(phaseName);
-
-  // Lunar day info (left-aligned)
+  display.println(getMoonPhaseName(moon.phase));
+
+  // Lunar day and the next principal phase (left-aligned)
+  bool fullFirst = moon.nextFullMoon < moon.nextNewMoon;
+  time_t next = fullFirst ? moon.nextFullMoon : moon.nextNewMoon;
+  int days = (int)((next - frameTime.epoch + 43200) / 86400);
+  char line[24];
+  snprintf_P(line, sizeof(line), fullFirst ? PSTR("Day %d  Full in %dd") : PSTR("Day %d  New in %dd"),
+             moon.ageDeci / 10 + 1, days);
   display.setCursor(2, 50);
-  int lunarDay = (int)(moonIllumination * 29.53);
-  display.print("Day ");
-  display.print(lunarDay);
-  display.print(" of 29");
+  display.print(line);
 }
 
 void drawMoonIcon(int x, int y, int phase) {
@@ -660,69 +1301,55 @@ void drawMoonIcon(int x, int y, int phase) {
 void drawForecastView() {
   display.setTextSize(1);
   display.setCursor(2, 2);
-  display.println("3-Day Forecast");
+  display.println(F("3-Day Forecast"));
   display.drawFastHLine(0, 12, SCREEN_WIDTH, WHITE);
 
   int yPos = 16;
   int lineHeight = 11;
 
-  for (int i = 0; i < 3; i++) {
-    int iconCode = forecastCodes[i];
-    Serial.printf("Draw forecast %d: Code=%d\n", i, iconCode);
+  for (int i = 0; i < FORECAST_DAYS; i++) {
+    const ForecastDay& fc = weather.forecast[i];
+    int iconCode = fc.code;
+    LOG_DEBUG("Draw forecast %d: Code=%d", i, iconCode);
 
     // Get weather icon character
-    String iconChar = " ";
+    char iconChar = ' ';
     if (iconCode == 0 || iconCode == 1) {
-      iconChar = "O";  // Sun
+      iconChar = 'O';  // Sun
     } else if (iconCode == 2 || iconCode == 3) {
-      iconChar = "~";  // Cloud
+      iconChar = '~';  // Cloud
     } else if (iconCode == 45 || iconCode == 48) {
-      iconChar = "=";  // Fog
+      iconChar = '=';  // Fog
     } else if ((iconCode >= 51 && iconCode <= 67) || (iconCode >= 80 && iconCode <= 82)) {
-      iconChar = "'";  // Rain
+      iconChar = '\'';  // Rain
     } else if ((iconCode >= 71 && iconCode <= 77) || (iconCode >= 85 && iconCode <= 86)) {
-      iconChar = "*";  // Snow
+      iconChar = '*';  // Snow
     } else if (iconCode >= 95) {
-      iconChar = "#";  // Storm
+      iconChar = '#';  // Storm
     }
 
-    // Day number
-    String dateStr = forecastDays[i];
-    String dayNum = "  ";
-    if (dateStr.length() >= 10) {
-      dayNum = dateStr.substring(8, 10);
+    // Day of month
+    char dayNum[3] = "  ";
+    if (fc.date != 0) {
+      snprintf_P(dayNum, sizeof(dayNum), PSTR("%02d"), fc.date & 0x1F);
     }
 
-    // Weather description
-    String weatherDesc = getWeatherDescription(iconCode);
+    // Weather description, copied out of flash
+    char weatherDesc[9];
+    strlcpy_P(weatherDesc, (PGM_P)getWeatherDescription(iconCode), sizeof(weatherDesc));
 
-    // Pad weather description to fixed width
-    while (weatherDesc.length() < 8) {
-      weatherDesc += " ";
-    }
-
-    // Temperature range
-    String tempRange = "";
-    if (tempUnit[0] == 'B') {
-      tempRange = String((int)forecastMaxTemps[i]) + "/" +
-                  String((int)forecastMinTemps[i]) + "C";
-    } else if (tempUnit[0] == 'F') {
-      tempRange = String((int)celsiusToFahrenheit(forecastMaxTemps[i])) + "/" +
-                  String((int)celsiusToFahrenheit(forecastMinTemps[i])) + "F";
-    } else {
-      tempRange = String((int)forecastMaxTemps[i]) + "/" +
-                  String((int)forecastMinTemps[i]) + "C";
-    }
+    // Temperature range, "--" for a day the API left out
+    char maxTemp[6];
+    char minTemp[6];
+    formatWholeDegrees(fc.maxDeci, maxTemp, sizeof(maxTemp));
+    formatWholeDegrees(fc.minDeci, minTemp, sizeof(minTemp));
+    char unit = tempUnit[0] == 'F' ? 'F' : 'C';
 
-    // Build complete line: Icon Day Desc Temp
+    // Build complete line: Icon Day Desc Temp (description padded to 8)
+    char line[32];
+    snprintf_P(line, sizeof(line), PSTR("%c %s %-8s %s/%s%c"), iconChar, dayNum, weatherDesc, maxTemp, minTemp, unit);
     display.setCursor(2, yPos);
-    display.print(iconChar);
-    display.print(" ");
-    display.print(dayNum);
-    display.print(" ");
-    display.print(weatherDesc);
-    display.print(" ");
-    display.print(tempRange);
+    display.print(line);
 
     yPos += lineHeight;
   }
@@ -730,22 +1357,24 @@ void drawForecastView() {
   // Show current weather in last line
   display.drawFastHLine(0, 51, SCREEN_WIDTH, WHITE);
   display.setCursor(2, 54);
-  display.print("Now: ");
-  display.print(getWeatherDescription(weatherCode));
-  display.print(" ");
-  display.print(weatherTemp);
-  if (tempUnit[0] == 'F') {
-    float tempF = celsiusToFahrenheit(weatherTemp.toFloat());
-    display.print("F");
+  display.print(F("Now: "));
+  display.print(getWeatherDescription(weather.code));
+  char nowTemp[12];
+  float nowC = fromDeciDegrees(weather.tempDeci);
+  if (weather.tempDeci == TEMP_UNKNOWN) {
+    strlcpy_P(nowTemp, PSTR(" N/A"), sizeof(nowTemp));
+  } else if (tempUnit[0] == 'F') {
+    snprintf_P(nowTemp, sizeof(nowTemp), PSTR(" %.1fF"), celsiusToFahrenheit(nowC));
   } else {
-    display.print("C");
+    snprintf_P(nowTemp, sizeof(nowTemp), PSTR(" %.1fC"), nowC);
   }
+  display.print(nowTemp);
 }
 
 void drawSystemInfoView() {
   display.setTextSize(1);
   display.setCursor(2, 2);
-  display.println("System Info");
+  display.println(F("System Info"));
   display.drawFastHLine(0, 12, SCREEN_WIDTH, WHITE);
 
   int yPos = 18;
@@ -753,186 +1382,221 @@ void drawSystemInfoView() {
 
   // WiFi strength
   display.setCursor(2, yPos);
-  display.print("WiFi:");
-  display.print(getWiFiSignalBars());
-  display.print(" ");
-  display.print(getWiFiSignalStrength());
-  display.println("dBm");
+  display.print(F("WiFi:"));
+  if (wifiState == WIFI_UP) {
+    display.print(getWiFiSignalBars());
+    display.print(' ');
+    display.print(getWiFiSignalStrength());
+    display.println(F("dBm"));
+  } else {
+    char lost[17];  // "lost 4294967295s"
+    snprintf_P(lost, sizeof(lost), PSTR("lost %us"), (unsigned)((uint32_t)(millis() - wifiDownSince) / 1000));
+    display.print(lost);
+  }
   yPos += lineHeight;
 
   // Uptime
   display.setCursor(2, yPos);
-  display.print("Up: ");
-  display.println(getUptime());
+  char uptime[12];
+  display.print(F("Up: "));
+  display.println(formatUptime(uptime, sizeof(uptime)));
   yPos += lineHeight;
 
-  // Free memory
+  // Free memory, largest block and fragmentation
+  HeapSample heap = readHeap();
+  char ram[24];
+  snprintf_P(ram, sizeof(ram), PSTR("RAM:%uK blk:%uK f:%u%%"),
+             heap.freeHeap / 1024, heap.maxBlock / 1024, heap.fragmentation);
   display.setCursor(2, yPos);
-  display.print("RAM: ");
-  display.print(ESP.getFreeHeap() / 1024);
-  display.println("KB");
+  display.println(ram);
   yPos += lineHeight;
 
   // IP address
   display.setCursor(2, yPos);
-  display.print("IP: ");
-  display.println(WiFi.localIP().toString());
+  display.print(F("IP: "));
+  display.println(WiFi.localIP());
 }
 
 // --- TIME & WEATHER UTILS ---
-void setupTime() { configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, NTP_SERVER); struct tm timeinfo; if (!getLocalTime(&timeinfo)) { Serial.println("Failed to obtain time"); return; } Serial.println("Time synchronized"); }
-String getFormattedTimeHHMM() { struct tm timeinfo; if (!getLocalTime(&timeinfo)) { return "??:??"; } char timeString[6]; strftime(timeString, sizeof(timeString), "%H:%M", &timeinfo); return String(timeString); }
-String getFormattedDate() { struct tm timeinfo; if (!getLocalTime(&timeinfo)) { return "??-??-????"; } char dateString[11]; strftime(dateString, sizeof(dateString), "%d-%m-%Y", &timeinfo); return String(dateString); }
-String getDayOfWeek() { struct tm timeinfo; if (!getLocalTime(&timeinfo)) { return "??"; } char dayString[10]; strftime(dayString, sizeof(dayString), "%A", &timeinfo); return String(dayString); }
+// Unlike getLocalTime() this never waits for NTP; before the first sync the
+// snapshot is simply marked invalid.
+void captureTime(TimeContext& t) {
+  timeval tv;
+  halGetTime(tv);
+  t.epoch = tv.tv_sec;
+  localtime_r(&t.epoch, &t.local);
+  t.valid = t.local.tm_year > (2016 - 1900);
+}
+
+// Formatters write into caller-provided buffers and return them.
+const char* formatTimeHHMM(const TimeContext& t, char* out, size_t size) { if (!t.valid) { strlcpy_P(out, PSTR("??:??"), size); } else { strftime(out, size, "%H:%M", &t.local); } return out; }
+const char* formatDate(const TimeContext& t, char* out, size_t size) { if (!t.valid) { strlcpy_P(out, PSTR("?\?-?\?-????"), size); } else { strftime(out, size, "%d-%m-%Y", &t.local); } return out; }
+const char* formatDayOfWeek(const TimeContext& t, char* out, size_t size) { if (!t.valid) { strlcpy_P(out, PSTR("??"), size); } else { strftime(out, size, "%A", &t.local); } return out; }
 
 float celsiusToFahrenheit(float celsius) {
   return (celsius * 9.0 / 5.0) + 32.0;
 }
 
-String formatTemperature(float tempC, bool showBoth) {
-  if (tempUnit[0] == 'F') {
-    float tempF = celsiusToFahrenheit(tempC);
-    return String(tempF, 1) + "F";
-  } else if (tempUnit[0] == 'B' || showBoth) {
-    float tempF = celsiusToFahrenheit(tempC);
-    return String(tempC, 1) + "C/" + String(tempF, 0) + "F";
-  } else {
-    return String(tempC, 1) + "C";
+// "HH:MM" to minutes since midnight, -1 if it is not a time
+int parseMinuteOfDay(const char* hhmm) {
+  for (int i : {0, 1, 3, 4}) {
+    if (hhmm[i] < '0' || hhmm[i] > '9') return -1;
   }
+  if (hhmm[2] != ':') return -1;
+  return ((hhmm[0] - '0') * 10 + (hhmm[1] - '0')) * 60 + (hhmm[3] - '0') * 10 + (hhmm[4] - '0');
 }
 
-String calculateDayLength() {
-  if (sunriseTime == "N/A" || sunsetTime == "N/A") {
-    return "N/A";
+const char* formatMinuteOfDay(int16_t minute, char* out, size_t size) {
+  if (minute < 0) {
+    strlcpy_P(out, PSTR("N/A"), size);
+  } else {
+    unsigned clamped = min<int16_t>(minute, 1439);
+    snprintf_P(out, size, PSTR("%02u:%02u"), clamped / 60, clamped % 60);
   }
+  return out;
+}
 
-  int riseH = sunriseTime.substring(0, 2).toInt();
-  int riseM = sunriseTime.substring(3, 5).toInt();
-  int setH = sunsetTime.substring(0, 2).toInt();
-  int setM = sunsetTime.substring(3, 5).toInt();
-
-  int totalMinutes = (setH * 60 + setM) - (riseH * 60 + riseM);
-  int hours = totalMinutes / 60;
-  int minutes = totalMinutes % 60;
-
-  return String(hours) + "h " + String(minutes) + "m";
+// A missing or null reading arrives as NaN and stays unknown
+int16_t toDeciDegrees(float celsius) {
+  return isnan(celsius) ? TEMP_UNKNOWN : (int16_t)lroundf(celsius * 10);
 }
 
-String calculateTimeUntilSunset() {
-  if (sunsetTime == "N/A") {
-    return "N/A";
-  }
+float fromDeciDegrees(int16_t deci) {
+  return deci == TEMP_UNKNOWN ? 0.0f : deci / 10.0f;
+}
 
-  struct tm timeinfo;
-  if (!getLocalTime(&timeinfo)) {
-    return "N/A";
+// Whole degrees in the display unit, truncated like the forecast always was
+char* formatWholeDegrees(int16_t deci, char* out, size_t size) {
+  if (deci == TEMP_UNKNOWN) {
+    strlcpy_P(out, PSTR("--"), size);
+    return out;
   }
+  float celsius = fromDeciDegrees(deci);
+  int whole = tempUnit[0] == 'F' ? (int)celsiusToFahrenheit(celsius) : (int)celsius;
+  snprintf_P(out, size, PSTR("%d"), whole);
+  return out;
+}
 
-  int nowH = timeinfo.tm_hour;
-  int nowM = timeinfo.tm_min;
-  int setH = sunsetTime.substring(0, 2).toInt();
-  int setM = sunsetTime.substring(3, 5).toInt();
+// Dates pack as 7 bits of years since 2000, 4 of month, 5 of day; 0 is unset
+uint16_t packDate(int year, int month, int day) {
+  return (uint16_t)(((year - 2000) << 9) | (month << 5) | day);
+}
 
-  int nowMinutes = nowH * 60 + nowM;
-  int setMinutes = setH * 60 + setM;
-  int remaining = setMinutes - nowMinutes;
+// "YYYY-MM-DD" to a packed date, 0 if it does not parse
+uint16_t parsePackedDate(const char* iso) {
+  int year, month, day;
+  if (iso == nullptr || sscanf(iso, "%4d-%2d-%2d", &year, &month, &day) != 3) return 0;
+  if (year < 2000 || year > 2127 || month < 1 || month > 12 || day < 1 || day > 31) return 0;
+  return packDate(year, month, day);
+}
 
-  if (remaining < 0) {
-    return "Set"; // Sun already set
+const char* formatPackedDate(uint16_t date, char* out, size_t size) {
+  if (date == 0) {
+    if (size > 0) out[0] = '\0';
+    return out;
   }
+  snprintf_P(out, size, PSTR("%04d-%02d-%02d"), 2000 + (date >> 9), (date >> 5) & 0x0F, date & 0x1F);
+  return out;
+}
 
-  int hours = remaining / 60;
-  int minutes = remaining % 60;
-
+const char* formatDuration(int totalMinutes, char* out, size_t size) {
+  int hours = totalMinutes / 60;
+  int minutes = totalMinutes % 60;
   if (hours > 0) {
-    return String(hours) + "h " + String(minutes) + "m";
+    snprintf_P(out, size, PSTR("%dh %dm"), hours, minutes);
   } else {
-    return String(minutes) + "m";
+    snprintf_P(out, size, PSTR("%dm"), minutes);
   }
+  return out;
 }
 
-int calculateMoonPhase() {
-  time_t now = time(nullptr);
-  struct tm* timeinfo = localtime(&now);
-
-  int year = timeinfo->tm_year + 1900;
-  int month = timeinfo->tm_mon + 1;
-  int day = timeinfo->tm_mday;
-
-  if (month < 3) {
-    year--;
-    month += 12;
+const char* formatDayLength(char* out, size_t size) {
+  int rise = solarDay.sunriseMinute;
+  int set = solarDay.sunsetMinute;
+  if (rise < 0 || set < 0) {
+    strlcpy_P(out, PSTR("N/A"), size);
+    return out;
   }
+  int totalMinutes = set - rise;
+  if (totalMinutes < 0) totalMinutes += 1440;  // sets after local midnight
+  snprintf_P(out, size, PSTR("%dh %dm"), totalMinutes / 60, totalMinutes % 60);
+  return out;
+}
 
-  int a = year / 100;
-  int b = a / 4;
-  int c = 2 - a + b;
-  int e = 365.25 * (year + 4716);
-  int f = 30.6001 * (month + 1);
-
-  double jd = c + day + e + f - 1524.5;
-  double daysSinceNew = jd - 2451549.5;
-  double newMoons = daysSinceNew / 29.53;
-  double phase = (newMoons - (int)newMoons);
+const char* formatTimeUntilSunset(const TimeContext& t, char* out, size_t size) {
+  int setMinutes = solarDay.sunsetMinute;
+  if (setMinutes < 0 || !t.valid) {
+    strlcpy_P(out, PSTR("N/A"), size);
+    return out;
+  }
 
-  moonIllumination = phase;
+  int nowMinutes = t.local.tm_hour * 60 + t.local.tm_min;
+  int remaining = setMinutes - nowMinutes;
 
-  if (phase < 0.0625) return 0;
-  if (phase < 0.1875) return 1;
-  if (phase < 0.3125) return 2;
-  if (phase < 0.4375) return 3;
-  if (phase < 0.5625) return 4;
-  if (phase < 0.6875) return 5;
-  if (phase < 0.8125) return 6;
-  return 7;
+  if (remaining < 0) {
+    strlcpy_P(out, PSTR("Set"), size); // Sun already set
+    return out;
+  }
+  return formatDuration(remaining, out, size);
 }
 
-String getMoonPhaseName(int phase) {
-  const char* names[] = {
-    "New Moon",
-    "Waxing Crescent",
-    "First Quarter",
-    "Waxing Gibbous",
-    "Full Moon",
-    "Waning Gibbous",
-    "Last Quarter",
-    "Waning Crescent"
-  };
-  return String(names[phase]);
+const char MOON_NEW[] PROGMEM = "New Moon";
+const char MOON_WAXING_CRESCENT[] PROGMEM = "Waxing Crescent";
+const char MOON_FIRST_QUARTER[] PROGMEM = "First Quarter";
+const char MOON_WAXING_GIBBOUS[] PROGMEM = "Waxing Gibbous";
+const char MOON_FULL[] PROGMEM = "Full Moon";
+const char MOON_WANING_GIBBOUS[] PROGMEM = "Waning Gibbous";
+const char MOON_LAST_QUARTER[] PROGMEM = "Last Quarter";
+const char MOON_WANING_CRESCENT[] PROGMEM = "Waning Crescent";
+const char* const MOON_PHASE_NAMES[] PROGMEM = {
+  MOON_NEW,
+  MOON_WAXING_CRESCENT,
+  MOON_FIRST_QUARTER,
+  MOON_WAXING_GIBBOUS,
+  MOON_FULL,
+  MOON_WANING_GIBBOUS,
+  MOON_LAST_QUARTER,
+  MOON_WANING_CRESCENT
+};
+
+const __FlashStringHelper* getMoonPhaseName(int phase) {
+  return FPSTR(pgm_read_ptr(&MOON_PHASE_NAMES[phase]));
 }
 
-String getUptime() {
+const char* formatUptime(char* out, size_t size) {
   unsigned long uptime = (millis() - bootTime) / 1000;
   int days = uptime / 86400;
   int hours = (uptime % 86400) / 3600;
   int minutes = (uptime % 3600) / 60;
 
   if (days > 0) {
-    return String(days) + "d " + String(hours) + "h";
+    snprintf_P(out, size, PSTR("%dd %dh"), days, hours);
   } else if (hours > 0) {
-    return String(hours) + "h " + String(minutes) + "m";
+    snprintf_P(out, size, PSTR("%dh %dm"), hours, minutes);
   } else {
-    return String(minutes) + "m";
+    snprintf_P(out, size, PSTR("%dm"), minutes);
   }
+  return out;
 }
 
 int getWiFiSignalStrength() {
   return WiFi.RSSI();
 }
 
-String getWiFiSignalBars() {
+const __FlashStringHelper* getWiFiSignalBars() {
   int rssi = WiFi.RSSI();
-  if (rssi >= -50) return "####";
-  if (rssi >= -60) return "###.";
-  if (rssi >= -70) return "##..";
-  if (rssi >= -80) return "#...";
-  return "....";
+  if (rssi >= -50) return F("####");
+  if (rssi >= -60) return F("###.");
+  if (rssi >= -70) return F("##..");
+  if (rssi >= -80) return F("#...");
+  return F("....");
 }
 
-void fetchGeocodingData(String city) {
+bool fetchGeocodingData(String city) {
+  TRACE_SPAN(TRACE_FETCH_GEOCODE);
   if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("Geocoding failed: WiFi not connected");
-    return;
+    LOG_WARN("Geocoding failed: WiFi not connected");
+    return false;
   }
 
   String url = "http://geocoding-api.open-meteo.com/v1/search?name=" + city + "&count=1&language=en&format=json";
@@ -941,328 +1605,2688 @@ void fetchGeocodingData(String city) {
   WiFiClient client;
   http.begin(client, url);
 
+  bool found = false;
+  uint32_t start = micros();
   int httpCode = http.GET();
+  fetchStatus[FETCH_GEOCODE].increment(httpCode);
   if (httpCode > 0) {
     String payload = http.getString();
+    fetchLatency[FETCH_GEOCODE].observe(micros() - start);
     DynamicJsonDocument doc(1024);
-    deserializeJson(doc, payload);
+    if (deserializeJson(doc, payload)) {
+      parseFailures[FETCH_GEOCODE]++;
+    }
 
     if (doc["results"].size() > 0) {
       float lat = doc["results"][0]["latitude"];
       float lon = doc["results"][0]["longitude"];
       const char* tz = doc["results"][0]["timezone"];
-      const char* name = doc["results"][0]["name"];
-      const char* country = doc["results"][0]["country"];
 
       dtostrf(lat, 8, 4, latitude);
       dtostrf(lon, 8, 4, longitude);
 
-      if (tz != nullptr) {
-        strcpy(timezone, tz);
+      if (tz != nullptr && strcmp(tz, timeZone) != 0) {
+        strlcpy(timeZone, tz, sizeof(timeZone));
+        applyTimeZone();
       }
 
-      Serial.printf("Geocoding success: %s, %s (%.4f, %.4f)\n", name, country, lat, lon);
-      Serial.printf("Timezone: %s\n", timezone);
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+      const char* name = doc["results"][0]["name"];
+      const char* country = doc["results"][0]["country"];
+      LOG_INFO("Geocoding success: %s, %s (%.4f, %.4f)", name, country, lat, lon);
+#endif
+      LOG_INFO("Timezone: %s", timeZone);
+      found = true;
     } else {
-      Serial.println("City not found, using defaults");
+      LOG_WARN("City not found, using defaults");
     }
   } else {
-    Serial.printf("Geocoding failed: %s\n", http.errorToString(httpCode).c_str());
+    LOG_WARN("Geocoding failed: %s", http.errorToString(httpCode).c_str());
   }
   http.end();
+  return found;
 }
 
-void fetchWeatherData() {
+bool fetchWeatherData() {
+  TRACE_SPAN(TRACE_FETCH_WEATHER);
   if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("Weather fetch failed: WiFi not connected");
-    return;
+    LOG_WARN("Weather fetch failed: WiFi not connected");
+    return false;
   }
 
   weatherApiUrl = "http://api.open-meteo.com/v1/forecast?";
   weatherApiUrl += "latitude=" + String(latitude);
   weatherApiUrl += "&longitude=" + String(longitude);
   weatherApiUrl += "&current_weather=true";
-  weatherApiUrl += "&daily=temperature_2m_max,temperature_2m_min,weathercode,sunrise,sunset";
+  weatherApiUrl += "&daily=temperature_2m_max,temperature_2m_min,weathercode";
   weatherApiUrl += "&forecast_days=3";
   weatherApiUrl += "&timezone=auto";
 
-  Serial.println("Fetching weather from: " + weatherApiUrl);
+  LOG_DEBUG("Fetching weather from: %s", weatherApiUrl.c_str());
 
   HTTPClient http;
   WiFiClient client;
 
   if (!http.begin(client, weatherApiUrl)) {
-    Serial.println("ERROR: http.begin() failed!");
-    return;
+    LOG_ERROR("http.begin() failed");
+    return false;
   }
 
   http.setTimeout(10000);
 
-  Serial.println("Sending HTTP GET request...");
+  LOG_DEBUG("Sending HTTP GET request...");
+  uint32_t start = micros();
   int httpCode = http.GET();
-  Serial.printf("HTTP Code: %d\n", httpCode);
+  LOG_DEBUG("HTTP Code: %d", httpCode);
+  fetchStatus[FETCH_WEATHER].increment(httpCode);
 
   if (httpCode == 200) {
     String payload = http.getString();
-    Serial.printf("Payload size: %d bytes\n", payload.length());
+    fetchLatency[FETCH_WEATHER].observe(micros() - start);
+    LOG_DEBUG("Payload size: %d bytes", payload.length());
 
     DynamicJsonDocument doc(4096);
     DeserializationError error = deserializeJson(doc, payload);
 
     if (error) {
-      Serial.printf("JSON parsing failed: %s\n", error.c_str());
-      Serial.println("Payload: " + payload.substring(0, 200));
+      parseFailures[FETCH_WEATHER]++;
+      LOG_ERROR("JSON parsing failed: %s", error.c_str());
+      LOG_DEBUG("Payload: %.200s", payload.c_str());
       http.end();
-      return;
+      return false;
     }
 
     // Check if current_weather exists
     if (!doc.containsKey("current_weather")) {
-      Serial.println("ERROR: No current_weather in response!");
+      parseFailures[FETCH_WEATHER]++;
+      LOG_ERROR("No current_weather in response");
       http.end();
-      return;
+      return false;
     }
 
     float currentTemp = doc["current_weather"]["temperature"];
-    weatherTemp = String(currentTemp, 1);
-    weatherCode = doc["current_weather"]["weathercode"].as<int>();
+    weather.tempDeci = toDeciDegrees(currentTemp);
+    weather.code = doc["current_weather"]["weathercode"].as<int>();
 
     if (previousTemp > -99.0) {
       // Temperature trend tracking
     }
     previousTemp = currentTemp;
 
-    Serial.printf("Weather code: %d, Temp: %.1f\n", weatherCode, currentTemp);
+    LOG_DEBUG("Weather code: %d, Temp: %.1f", weather.code, currentTemp);
 
     // Check if daily data exists
     if (!doc.containsKey("daily")) {
-      Serial.println("ERROR: No daily data in response!");
+      parseFailures[FETCH_WEATHER]++;
+      LOG_ERROR("No daily data in response");
       http.end();
-      return;
+      return false;
     }
 
-    const char* sunrise = doc["daily"]["sunrise"][0];
-    const char* sunset = doc["daily"]["sunset"][0];
-    if (sunrise != nullptr) {
-      sunriseTime = String(sunrise).substring(11, 16);
-    } else {
-      Serial.println("WARNING: No sunrise data");
-    }
-    if (sunset != nullptr) {
-      sunsetTime = String(sunset).substring(11, 16);
-    } else {
-      Serial.println("WARNING: No sunset data");
-    }
-
-    for (int i = 0; i < 3; i++) {
-      forecastMaxTemps[i] = doc["daily"]["temperature_2m_max"][i];
-      forecastMinTemps[i] = doc["daily"]["temperature_2m_min"][i];
-      forecastCodes[i] = doc["daily"]["weathercode"][i];
+    for (int i = 0; i < FORECAST_DAYS; i++) {
+      ForecastDay& fc = weather.forecast[i];
+      fc.maxDeci = toDeciDegrees(doc["daily"]["temperature_2m_max"][i] | NAN);
+      fc.minDeci = toDeciDegrees(doc["daily"]["temperature_2m_min"][i] | NAN);
+      fc.code = doc["daily"]["weathercode"][i] | CODE_UNKNOWN;
       const char* date = doc["daily"]["time"][i];
       if (date != nullptr) {
-        forecastDays[i] = String(date);
+        fc.date = parsePackedDate(date);
       }
-      Serial.printf("Forecast day %d: Code=%d, Max=%.1f, Min=%.1f\n",
-                    i, forecastCodes[i], forecastMaxTemps[i], forecastMinTemps[i]);
+      LOG_DEBUG("Forecast day %d: Code=%d, Max=%d, Min=%d (deci C)",
+                    i, fc.code, fc.maxDeci, fc.minDeci);
     }
 
     lastForecastFetch = millis();
-    lastSunFetch = millis();
+    TimeContext fetchedAt;
+    captureTime(fetchedAt);
+    weatherFetchedAt = fetchedAt.valid ? fetchedAt.epoch : 0;
+    saveRtcState();
 
-    Serial.printf("Weather updated: %s°C, Code: %d\n", weatherTemp.c_str(), weatherCode);
-    Serial.printf("Sunrise: %s, Sunset: %s\n", sunriseTime.c_str(), sunsetTime.c_str());
+    LOG_INFO("Weather updated: %d deci C, Code: %d", weather.tempDeci, weather.code);
   } else {
-    Serial.printf("Weather fetch failed: HTTP %d - %s\n", httpCode, http.errorToString(httpCode).c_str());
+    LOG_WARN("Weather fetch failed: HTTP %d - %s", httpCode, http.errorToString(httpCode).c_str());
+    http.end();
+    return false;
   }
   http.end();
+  return true;
 }
 
-String getWeatherDescription(int weatherCode) {
+// WMO weather code descriptions, kept in flash
+const char WX_CLEAR[] PROGMEM = "Clear";
+const char WX_MAINLY_CLEAR[] PROGMEM = "M.Clear";
+const char WX_PARTLY_CLOUDY[] PROGMEM = "P.Cloudy";
+const char WX_OVERCAST[] PROGMEM = "Overcast";
+const char WX_FOG[] PROGMEM = "Fog";
+const char WX_DRIZZLE[] PROGMEM = "Drizzle";
+const char WX_RAIN[] PROGMEM = "Rain";
+const char WX_FREEZING_RAIN[] PROGMEM = "Fr.Rain";
+const char WX_SNOW[] PROGMEM = "Snow";
+const char WX_SHOWERS[] PROGMEM = "Showers";
+const char WX_SNOW_SHOWERS[] PROGMEM = "SnowSh";
+const char WX_STORM[] PROGMEM = "Storm";
+const char WX_UNKNOWN[] PROGMEM = "N/A";
+
+const __FlashStringHelper* getWeatherDescription(int weatherCode) {
   // WMO Weather codes to short text
-  if (weatherCode == 0) return "Clear";
-  if (weatherCode == 1) return "M.Clear";  // Mainly clear
-  if (weatherCode == 2) return "P.Cloudy"; // Partly cloudy
-  if (weatherCode == 3) return "Overcast";
-  if (weatherCode == 45 || weatherCode == 48) return "Fog";
-  if (weatherCode >= 51 && weatherCode <= 55) return "Drizzle";
-  if (weatherCode >= 61 && weatherCode <= 65) return "Rain";
-  if (weatherCode == 66 || weatherCode == 67) return "Fr.Rain"; // Freezing rain
-  if (weatherCode >= 71 && weatherCode <= 77) return "Snow";
-  if (weatherCode >= 80 && weatherCode <= 82) return "Showers";
-  if (weatherCode >= 85 && weatherCode <= 86) return "SnowSh";  // Snow showers
-  if (weatherCode >= 95 && weatherCode <= 99) return "Storm";
-  return "N/A";
+  PGM_P text = WX_UNKNOWN;
+  if (weatherCode == 0) text = WX_CLEAR;
+  else if (weatherCode == 1) text = WX_MAINLY_CLEAR;
+  else if (weatherCode == 2) text = WX_PARTLY_CLOUDY;
+  else if (weatherCode == 3) text = WX_OVERCAST;
+  else if (weatherCode == 45 || weatherCode == 48) text = WX_FOG;
+  else if (weatherCode >= 51 && weatherCode <= 55) text = WX_DRIZZLE;
+  else if (weatherCode >= 61 && weatherCode <= 65) text = WX_RAIN;
+  else if (weatherCode == 66 || weatherCode == 67) text = WX_FREEZING_RAIN;
+  else if (weatherCode >= 71 && weatherCode <= 77) text = WX_SNOW;
+  else if (weatherCode >= 80 && weatherCode <= 82) text = WX_SHOWERS;
+  else if (weatherCode >= 85 && weatherCode <= 86) text = WX_SNOW_SHOWERS;
+  else if (weatherCode >= 95 && weatherCode <= 99) text = WX_STORM;
+  return FPSTR(text);
 }
 
-// --- CONFIGURATION MANAGEMENT ---
-void saveConfigCallback() { Serial.println("Should save config"); shouldSaveConfig = true; }
-void updateWeatherUrl() {
-  // This function is deprecated - fetchWeatherData() builds the URL itself
-  Serial.printf("Location set to: %.4f, %.4f\n", atof(latitude), atof(longitude));
-}
-void loadConfig() {
-  if (LittleFS.exists("/config.json")) {
-    File configFile = LittleFS.open("/config.json", "r");
-    if (configFile) {
-      Serial.println("Reading config file");
-      size_t size = configFile.size();
-      std::unique_ptr<char[]> buf(new char[size]);
-      configFile.readBytes(buf.get(), size);
-      DynamicJsonDocument json(2048);
-      if (deserializeJson(json, buf.get()) == DeserializationError::Ok) {
-        Serial.println("Successfully parsed config");
-        strcpy(cityName, json["cityName"] | "Kreuzlingen, Switzerland");
-        strcpy(displayName, json["displayName"] | "Kreuzlingen, CH");
-        strcpy(latitude, json["latitude"] | "47.65");
-        strcpy(longitude, json["longitude"] | "9.18");
-        strcpy(timezone, json["timezone"] | "CET-1CEST,M3.5.0,M10.5.0/3");
-        strcpy(tempUnit, json["tempUnit"] | "C");
-        viewDuration = json["viewDuration"] | 5000;
-        manualCoordinates = json["manualCoordinates"] | false;
-        Serial.printf("Loaded: %s at (%.2f, %.2f)\n", cityName, atof(latitude), atof(longitude));
-      } else {
-        Serial.println("Failed to load json config");
-      }
-      configFile.close();
-    }
+// --- NETWORK TIME ---
+// A small SNTP client in place of the SDK's. One request is in flight at a
+// time and everything, DNS included, is polled from loop(). Each reply
+// gives the clock offset and round-trip delay (RFC 4330); the offsets of
+// consecutive syncs give the crystal's drift, which is folded into a
+// millis()-based clock model. The system clock is steered from that model,
+// so time() stays corrected through outages. The poll interval doubles
+// while the offset stays small and falls back when it does not.
+const uint16_t NTP_PORT = 123;
+const uint16_t NTP_LOCAL_PORT = 2390;
+const uint32_t NTP_UNIX_OFFSET = 2208988800UL;  // 1900 to 1970
+const int NTP_PACKET_SIZE = 48;
+const unsigned long NTP_REPLY_TIMEOUT = 2000;
+const unsigned long NTP_RETRY_INTERVAL = 15000;
+const uint8_t NTP_MAX_FAILURES = 3;  // then resolve the server name again
+const uint32_t NTP_POLL_MIN = 64;    // seconds
+const uint32_t NTP_POLL_MAX = 4096;
+const int32_t NTP_STABLE_OFFSET_MS = 50;
+const int32_t NTP_STEP_OFFSET_MS = 250;
+const unsigned long NTP_DRIFT_MIN_INTERVAL = 60000;
+const float NTP_MAX_DRIFT_PPM = 500;
+const float NTP_UNCALIBRATED_PPM = 100;
+const unsigned long NTP_STEER_INTERVAL = 10000;
+const int32_t NTP_STEER_THRESHOLD_MS = 20;
+
+enum NtpState { NTP_IDLE, NTP_RESOLVING, NTP_WAITING };
+enum NtpDnsResult { NTP_DNS_PENDING, NTP_DNS_FOUND, NTP_DNS_FAILED };
+
+// Unix ms = baseMs + elapsed * (1 + driftPpm / 1e6), elapsed = millis() - baseMillis
+struct NtpClock {
+  bool synced;
+  int64_t baseMs;
+  uint32_t baseMillis;
+  float driftPpm;       // positive when millis() runs slow
+  float driftErrorPpm;  // how far driftPpm may still be off
+  uint32_t lastSyncMillis;
+  int32_t offsetMs;     // correction applied at the last sync
+  uint16_t delayMs;     // round trip of the last sync
+  uint32_t pollSeconds;
+  uint32_t syncs;
+  uint32_t failures;
+};
+
+NtpClock ntpClock = {false, 0, 0, 0, NTP_UNCALIBRATED_PPM, 0, 0, 0, NTP_POLL_MIN, 0, 0};
+WiFiUDP ntpUdp;
+NtpState ntpState = NTP_IDLE;
+IPAddress ntpServerIp;
+IPAddress ntpResolvedIp;
+volatile NtpDnsResult ntpDnsResult = NTP_DNS_PENDING;
+int64_t ntpRequestMs = 0;  // local clock at transmit, echoed back by the server
+unsigned long ntpAttemptAt = 0;
+unsigned long ntpNextDelay = 0;
+uint8_t ntpConsecutiveFailures = 0;
+
+// Model time once synced, the system clock before that
+int64_t clockNowMs() {
+  if (ntpClock.synced) {
+    uint32_t elapsed = millis() - ntpClock.baseMillis;
+    return ntpClock.baseMs + elapsed + (int64_t)(elapsed * ntpClock.driftPpm * 1e-6f);
   }
+  timeval tv;
+  halGetTime(tv);
+  return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
 }
-void saveConfig() {
-  Serial.println("Saving config");
-  DynamicJsonDocument json(2048);
-  json["cityName"] = cityName;
-  json["displayName"] = displayName;
-  json["latitude"] = latitude;
-  json["longitude"] = longitude;
-  json["timezone"] = timezone;
-  json["tempUnit"] = tempUnit;
-  json["viewDuration"] = viewDuration;
-  json["manualCoordinates"] = manualCoordinates;
 
-  File configFile = LittleFS.open("/config.json", "w");
-  if (!configFile) {
-    Serial.println("Failed to open config file for writing");
-    return;
-  }
-  serializeJson(json, configFile);
-  configFile.close();
-  Serial.println("Config saved");
+uint32_t ntpSyncAgeSeconds() {
+  return (millis() - ntpClock.lastSyncMillis) / 1000;
 }
 
-// --- WEB SERVER ---
-void setupWebServer() {
-  server.on("/", handleRoot);
-  server.on("/api", handleAPI);
-  server.on("/settings", handleSettings);
-  server.on("/settings/save", HTTP_POST, handleSettingsSave);
+// Half the round trip at the last sync plus what the drift estimate may
+// have gathered since
+uint32_t ntpErrorMs() {
+  uint32_t age = millis() - ntpClock.lastSyncMillis;
+  return ntpClock.delayMs / 2 + (uint32_t)(age * ntpClock.driftErrorPpm * 1e-6f);
+}
 
-  server.begin();
-  Serial.println("Web server started");
-  Serial.print("Access dashboard at: http://");
-  Serial.println(WiFi.localIP());
+void steerSystemClock(bool force) {
+  int64_t model = clockNowMs();
+  timeval tv;
+  halGetTime(tv);
+  int64_t system = (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+  if (!force && llabs(model - system) < NTP_STEER_THRESHOLD_MS) return;
+  tv.tv_sec = model / 1000;
+  tv.tv_usec = (model % 1000) * 1000;
+  halSetTime(tv);
 }
 
-void handleAPI() {
-  DynamicJsonDocument doc(2048);
+// Local time follows timeZone from here on; sun times are redone for the
+// new UTC offset
+void applyTimeZone() {
+  setenv("TZ", timeZone, 1);
+  tzset();
+  solarDay.date = 0;
+  scheduleTask(TASK_SKY, 0);
+}
 
-  // System info
-  doc["uptime"] = getUptime();
-  doc["freeHeap"] = ESP.getFreeHeap();
-  doc["rssi"] = WiFi.RSSI();
-  doc["ip"] = WiFi.localIP().toString();
-  doc["ssid"] = WiFi.SSID();
+void startNetworkTime() {
+  applyTimeZone();
+  ntpUdp.begin(NTP_LOCAL_PORT);
+}
 
-  // Time
-  struct tm timeinfo;
-  if (getLocalTime(&timeinfo)) {
-    doc["time"] = getFormattedTimeHHMM();
-    doc["date"] = getFormattedDate();
-    doc["day"] = getDayOfWeek();
-  }
+int64_t ntpTimestampMs(const uint8_t* p) {
+  uint32_t seconds = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+  uint32_t fraction = (uint32_t)p[4] << 24 | (uint32_t)p[5] << 16 | (uint32_t)p[6] << 8 | p[7];
+  // uint32 wrap carries the 2036 era rollover through to 2106
+  return (int64_t)(uint32_t)(seconds - NTP_UNIX_OFFSET) * 1000 + (((uint64_t)fraction * 1000) >> 32);
+}
 
-  // Weather
-  doc["temperature"] = weatherTemp.toFloat();
-  doc["weatherCode"] = weatherCode;
-  doc["weatherDesc"] = getWeatherDescription(weatherCode);
-  doc["tempUnit"] = String(tempUnit[0]);
+void ntpDnsFound(const char* /* name */, const ip_addr_t* addr, void* /* arg */) {
+  if (addr != nullptr) {
+    ntpResolvedIp = IPAddress(addr);
+    ntpDnsResult = NTP_DNS_FOUND;
+  } else {
+    ntpDnsResult = NTP_DNS_FAILED;
+  }
+}
 
-  // Sun & Moon
-  doc["sunrise"] = sunriseTime;
-  doc["sunset"] = sunsetTime;
-  doc["dayLength"] = calculateDayLength();
-  doc["moonPhase"] = getMoonPhaseName(calculateMoonPhase());
-  doc["moonIllumination"] = (int)(moonIllumination * 100);
+void sendNtpRequest() {
+  uint8_t packet[NTP_PACKET_SIZE] = {0x23};  // LI 0, version 4, client
+  ntpRequestMs = clockNowMs();
+  memcpy(packet + 40, &ntpRequestMs, sizeof(ntpRequestMs));
+  ntpUdp.beginPacket(ntpServerIp, NTP_PORT);
+  ntpUdp.write(packet, sizeof(packet));
+  ntpUdp.endPacket();
+  ntpState = NTP_WAITING;
+}
+
+void ntpFailed(const __FlashStringHelper* reason) {
+  ntpClock.failures++;
+  if (++ntpConsecutiveFailures >= NTP_MAX_FAILURES) {
+    ntpServerIp = IPAddress();
+  }
+  ntpState = NTP_IDLE;
+  ntpNextDelay = NTP_RETRY_INTERVAL;
+  char text[24];
+  strlcpy_P(text, (PGM_P)reason, sizeof(text));
+  LOG_WARN("NTP: %s", text);
+}
+
+void applyNtpReply(const uint8_t* packet) {
+  int64_t t4 = clockNowMs();
+  if ((packet[0] & 0x07) != 4 || packet[1] == 0 || memcmp(packet + 24, &ntpRequestMs, sizeof(ntpRequestMs)) != 0) {
+    ntpFailed(F("unexpected reply"));
+    return;
+  }
+  int64_t t1 = ntpRequestMs;
+  int64_t t2 = ntpTimestampMs(packet + 32);
+  int64_t t3 = ntpTimestampMs(packet + 40);
+  int64_t offset = ((t2 - t1) + (t3 - t4)) / 2;
+  int64_t delay = (t4 - t1) - (t3 - t2);
+  uint32_t now = millis();
+
+  // The residual offset over the time since the last sync is drift the
+  // model has not caught yet; take half of it to ride out network jitter
+  if (ntpClock.synced && llabs(offset) < NTP_STEP_OFFSET_MS) {
+    uint32_t since = now - ntpClock.lastSyncMillis;
+    if (since >= NTP_DRIFT_MIN_INTERVAL) {
+      float residualPpm = offset * 1e6f / since;
+      ntpClock.driftPpm = constrain(ntpClock.driftPpm + residualPpm / 2, -NTP_MAX_DRIFT_PPM, NTP_MAX_DRIFT_PPM);
+      ntpClock.driftErrorPpm = max(1.0f, fabsf(residualPpm));
+    }
+  }
+
+  if (llabs(offset) < NTP_STABLE_OFFSET_MS) {
+    ntpClock.pollSeconds = min(ntpClock.pollSeconds * 2, NTP_POLL_MAX);
+  } else if (llabs(offset) > NTP_STEP_OFFSET_MS) {
+    ntpClock.pollSeconds = NTP_POLL_MIN;
+  }
+
+  ntpClock.baseMs = t4 + offset;
+  ntpClock.baseMillis = now;
+  ntpClock.synced = true;
+  ntpClock.lastSyncMillis = now;
+  ntpClock.offsetMs = constrain(offset, (int64_t)INT32_MIN, (int64_t)INT32_MAX);
+  ntpClock.delayMs = constrain(delay, (int64_t)0, (int64_t)UINT16_MAX);
+  ntpClock.syncs++;
+  ntpConsecutiveFailures = 0;
+  ntpState = NTP_IDLE;
+  ntpNextDelay = ntpClock.pollSeconds * 1000UL;
+  steerSystemClock(true);
+  LOG_INFO("NTP: offset %ld ms, delay %u ms, drift %.1f ppm, next in %u s",
+                  (long)ntpClock.offsetMs, ntpClock.delayMs, ntpClock.driftPpm, (unsigned)ntpClock.pollSeconds);
+}
+
+// Never waits: each call advances the request by at most one step
+void updateNetworkTime() {
+  static unsigned long lastSteer = 0;
+  unsigned long now = millis();
+  if (ntpClock.synced && now - lastSteer > NTP_STEER_INTERVAL) {
+    steerSystemClock(false);
+    lastSteer = now;
+  }
+
+  switch (ntpState) {
+    case NTP_IDLE: {
+      if (now - ntpAttemptAt < ntpNextDelay || WiFi.status() != WL_CONNECTED) return;
+      ntpAttemptAt = now;
+      if (ntpServerIp.isSet()) {
+        sendNtpRequest();
+        return;
+      }
+      ip_addr_t addr;
+      ntpDnsResult = NTP_DNS_PENDING;
+      char host[sizeof(NTP_SERVER)];
+      strlcpy_P(host, NTP_SERVER, sizeof(host));
+      err_t err = dns_gethostbyname(host, &addr, ntpDnsFound, nullptr);
+      if (err == ERR_OK) {
+        ntpServerIp = IPAddress(&addr);
+        sendNtpRequest();
+      } else if (err == ERR_INPROGRESS) {
+        ntpState = NTP_RESOLVING;
+      } else {
+        ntpFailed(F("DNS lookup failed"));
+      }
+      return;
+    }
+    case NTP_RESOLVING:
+      if (ntpDnsResult == NTP_DNS_FOUND) {
+        ntpServerIp = ntpResolvedIp;
+        ntpAttemptAt = now;
+        sendNtpRequest();
+      } else if (ntpDnsResult == NTP_DNS_FAILED || now - ntpAttemptAt > NTP_REPLY_TIMEOUT) {
+        ntpFailed(F("DNS lookup failed"));
+      }
+      return;
+    case NTP_WAITING: {
+      int size = ntpUdp.parsePacket();
+      if (size >= NTP_PACKET_SIZE) {
+        uint8_t packet[NTP_PACKET_SIZE];
+        ntpUdp.read(packet, sizeof(packet));
+        applyNtpReply(packet);
+      } else if (now - ntpAttemptAt > NTP_REPLY_TIMEOUT) {
+        ntpFailed(F("no reply"));
+      }
+      return;
+    }
+  }
+}
+
+// --- SOLAR CALCULATOR ---
+// NOAA's low-precision solar position equations (fractional-year series for
+// the equation of time and declination), good to about a minute away from
+// the poles. Single-precision float; a day takes a few thousand cycles.
+const float SUN_ZENITH_RISE_SET = 90.833f;  // refraction + solar disc
+const float SUN_ZENITH_CIVIL = 96.0f;
+const int16_t NO_CROSSING = INT16_MIN;  // UTC minutes may legitimately be negative
+
+// Minutes after UTC midnight at which the sun crosses the given zenith
+// angle, before (rising) or after (setting) solar noon. NO_CROSSING if it
+// never does that day.
+int16_t solarCrossing(float latRad, float declination, float noonUtc, float zenithDeg, bool rising) {
+  float cosHourAngle = cosf(zenithDeg * DEG_TO_RAD) / (cosf(latRad) * cosf(declination)) -
+                       tanf(latRad) * tanf(declination);
+  if (cosHourAngle > 1.0f || cosHourAngle < -1.0f) return NO_CROSSING;
+  float hourAngleDeg = acosf(cosHourAngle) * RAD_TO_DEG;
+  return (int16_t)lroundf(rising ? noonUtc - 4.0f * hourAngleDeg : noonUtc + 4.0f * hourAngleDeg);
+}
+
+int16_t toLocalMinute(int16_t utcMinute, int offsetMinutes) {
+  if (utcMinute == NO_CROSSING) return MINUTE_UNKNOWN;
+  int local = (utcMinute + offsetMinutes) % 1440;
+  return local < 0 ? local + 1440 : local;
+}
+
+// dayOfYear is 0-based (tm_yday); offsetMinutes is local time minus UTC
+void computeSolarDay(float latitude, float longitude, int dayOfYear, int year, int offsetMinutes, SolarDay& out) {
+  int daysInYear = (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) ? 366 : 365;
+  float gamma = 2.0f * PI / daysInYear * dayOfYear;  // fractional year at noon
+
+  float eqTime = 229.18f * (0.000075f + 0.001868f * cosf(gamma) - 0.032077f * sinf(gamma) -
+                            0.014615f * cosf(2 * gamma) - 0.040849f * sinf(2 * gamma));
+  float declination = 0.006918f - 0.399912f * cosf(gamma) + 0.070257f * sinf(gamma) -
+                      0.006758f * cosf(2 * gamma) + 0.000907f * sinf(2 * gamma) -
+                      0.002697f * cosf(3 * gamma) + 0.00148f * sinf(3 * gamma);
+
+  float latRad = latitude * DEG_TO_RAD;
+  float noonUtc = 720.0f - 4.0f * longitude - eqTime;
+
+  out.latitude = latitude;
+  out.longitude = longitude;
+  out.noonMinute = toLocalMinute((int16_t)lroundf(noonUtc), offsetMinutes);
+  out.sunriseMinute = toLocalMinute(solarCrossing(latRad, declination, noonUtc, SUN_ZENITH_RISE_SET, true), offsetMinutes);
+  out.sunsetMinute = toLocalMinute(solarCrossing(latRad, declination, noonUtc, SUN_ZENITH_RISE_SET, false), offsetMinutes);
+  out.dawnMinute = toLocalMinute(solarCrossing(latRad, declination, noonUtc, SUN_ZENITH_CIVIL, true), offsetMinutes);
+  out.duskMinute = toLocalMinute(solarCrossing(latRad, declination, noonUtc, SUN_ZENITH_CIVIL, false), offsetMinutes);
+}
+
+// Local time minus UTC, from the snapshot's own broken-down times
+int utcOffsetMinutes(const TimeContext& t) {
+  struct tm utc;
+  gmtime_r(&t.epoch, &utc);
+  int dayDiff = t.local.tm_yday - utc.tm_yday;
+  if (dayDiff > 1) dayDiff = -1;       // local is Jan 1, UTC still Dec 31
+  else if (dayDiff < -1) dayDiff = 1;  // and the other way round
+  return dayDiff * 1440 + (t.local.tm_hour - utc.tm_hour) * 60 + (t.local.tm_min - utc.tm_min);
+}
+
+// Recomputes on local date rollover or when the location changes
+void updateSolarDay(const TimeContext& t) {
+  if (!t.valid) return;
+  uint16_t today = packDate(t.local.tm_year + 1900, t.local.tm_mon + 1, t.local.tm_mday);
+  float lat = atof(latitude);
+  float lon = atof(longitude);
+  if (solarDay.date == today && solarDay.latitude == lat && solarDay.longitude == lon) return;
+
+  uint32_t start = ESP.getCycleCount();
+  computeSolarDay(lat, lon, t.local.tm_yday, t.local.tm_year + 1900, utcOffsetMinutes(t), solarDay);
+  solarComputeCycles = ESP.getCycleCount() - start;
+  solarDay.date = today;
+
+  LOG_INFO("Sun: dawn %d, rise %d, noon %d, set %d, dusk %d (min), %u cycles",
+                  solarDay.dawnMinute, solarDay.sunriseMinute, solarDay.noonMinute,
+                  solarDay.sunsetMinute, solarDay.duskMinute, (unsigned)solarComputeCycles);
+}
+
+// --- LUNAR CALCULATOR ---
+// Within 2020-2060 new and full moons come from the precomputed table in
+// lunar_table.h: a binary search finds the current lunation, and phase and
+// age follow from the time since its new moon. The moon's speed varies too
+// much over a lunation for time to stand in for the phase angle, so
+// illumination always comes from lunarElongation().
+// Outside the table the moon is computed: phase angle and illuminated fraction from
+// Meeus, Astronomical Algorithms ch. 48 (low precision, ~0.5 %), new and
+// full moon instants from ch. 49 with the main periodic terms (a few
+// minutes). Angles are reduced modulo 360 before they reach float so single
+// precision holds over decades.
+const time_t J2000_EPOCH = 946728000;      // 2000-01-01 12:00 UTC
+const time_t NEW_MOON_EPOCH = 947168374;   // mean new moon of lunation 0, 2000-01-06 14:19:34 UTC
+const float SYNODIC_MONTH_DAYS = 29.530588861f;
+const int32_t SYNODIC_MONTH_SECONDS = 2551443;
+
+float wrapDegrees(float deg) {
+  deg = fmodf(deg, 360.0f);
+  return deg < 0 ? deg + 360.0f : deg;
+}
+
+float sinDeg(float deg) { return sinf(deg * DEG_TO_RAD); }
+
+// Degrees from the sun as seen from earth: 0 new, 180 full
+float lunarElongation(time_t t) {
+  int32_t seconds = (int32_t)(t - J2000_EPOCH);
+  int32_t days = seconds / 86400;
+  float dayFraction = (seconds % 86400) / 86400.0f;
+  // Daily rates with whole turns removed, applied to whole days and the rest
+  // separately to keep the products small
+  float D = wrapDegrees(297.8502f + wrapDegrees(12.19074912f * days) + 12.19074912f * dayFraction);
+  float M = wrapDegrees(357.5291f + wrapDegrees(0.98560028f * days) + 0.98560028f * dayFraction);
+  float Mp = wrapDegrees(134.9634f + wrapDegrees(13.06499295f * days) + 13.06499295f * dayFraction);
+
+  float phaseAngle = 180.0f - D - 6.289f * sinDeg(Mp) + 2.100f * sinDeg(M) - 1.274f * sinDeg(2 * D - Mp) -
+                     0.658f * sinDeg(2 * D) - 0.214f * sinDeg(2 * Mp) - 0.110f * sinDeg(D);
+  return wrapDegrees(180.0f - phaseAngle);
+}
+
+// Illuminated fraction (1 + cos phase angle) / 2, in percent
+uint8_t illuminationPercent(float elongation) {
+  return (uint8_t)lroundf((1.0f - cosf(elongation * DEG_TO_RAD)) * 50.0f);
+}
+
+// Instant of new (full = false) or full moon of lunation k
+time_t lunarPhaseTime(int32_t k, bool full) {
+  // Per-lunation rates of M' and F less a whole turn, which only holds for
+  // whole k; a full moon adds half of the unreduced rate
+  float M = wrapDegrees(2.5534f + wrapDegrees(29.10535670f * k) + (full ? 14.55267835f : 0));
+  float Mp = wrapDegrees(201.5643f + wrapDegrees(25.81693528f * k) + (full ? 192.90846764f : 0));
+  float F = wrapDegrees(160.7108f + wrapDegrees(30.67050284f * k) + (full ? 195.33525142f : 0));
+
+  float correction;
+  if (full) {
+    correction = -0.40614f * sinDeg(Mp) + 0.17302f * sinDeg(M) + 0.01614f * sinDeg(2 * Mp) +
+                 0.01043f * sinDeg(2 * F) + 0.00734f * sinDeg(Mp - M) - 0.00515f * sinDeg(Mp + M) +
+                 0.00209f * sinDeg(2 * M) - 0.00111f * sinDeg(Mp - 2 * F) - 0.00057f * sinDeg(Mp + 2 * F) +
+                 0.00056f * sinDeg(2 * Mp + M) - 0.00042f * sinDeg(3 * Mp);
+  } else {
+    correction = -0.40720f * sinDeg(Mp) + 0.17241f * sinDeg(M) + 0.01608f * sinDeg(2 * Mp) +
+                 0.01039f * sinDeg(2 * F) + 0.00739f * sinDeg(Mp - M) - 0.00514f * sinDeg(Mp + M) +
+                 0.00208f * sinDeg(2 * M) - 0.00111f * sinDeg(Mp - 2 * F) - 0.00057f * sinDeg(Mp + 2 * F) +
+                 0.00056f * sinDeg(2 * Mp + M) - 0.00042f * sinDeg(3 * Mp);
+  }
+  int64_t mean = (int64_t)k * SYNODIC_MONTH_SECONDS + (full ? SYNODIC_MONTH_SECONDS / 2 : 0);
+  return NEW_MOON_EPOCH + mean + (int32_t)lroundf(correction * 86400.0f);
+}
+
+time_t lunarNewMoon(int i) { return (time_t)pgm_read_dword(&LUNAR_NEW_MOONS[i]); }
+time_t lunarFullMoon(int i) { return lunarNewMoon(i) + 60 * (time_t)pgm_read_word(&LUNAR_FULL_OFFSETS[i]); }
+
+// Index of the lunation containing t, -1 outside the table
+int lunarTableIndex(time_t t) {
+  int lo = 0;
+  int hi = LUNAR_TABLE_SIZE - 1;
+  if (t < lunarNewMoon(lo) || t >= lunarNewMoon(hi)) return -1;
+  while (hi - lo > 1) {  // new moon lo <= t < new moon hi
+    int mid = (lo + hi) / 2;
+    if (lunarNewMoon(mid) <= t) lo = mid;
+    else hi = mid;
+  }
+  return lo;
+}
+
+void computeMoonFromTable(time_t t, int i, MoonState& out) {
+  out.lastNewMoon = lunarNewMoon(i);
+  out.nextNewMoon = lunarNewMoon(i + 1);
+  out.nextFullMoon = lunarFullMoon(i);
+  if (out.nextFullMoon <= t && i + 1 < LUNAR_TABLE_SIZE) out.nextFullMoon = lunarFullMoon(i + 1);
+
+  // Fraction of this lunation elapsed, 0.5 at its full moon
+  time_t age = t - out.lastNewMoon;
+  time_t full = lunarFullMoon(i) - out.lastNewMoon;
+  float fraction = age < full ? 0.5f * age / full
+                              : 0.5f + 0.5f * (age - full) / (out.nextNewMoon - out.lastNewMoon - full);
+  out.computedAt = t;
+  out.illumination = illuminationPercent(lunarElongation(t));
+  out.phase = (uint8_t)((int)(fraction * 8 + 0.5f) % 8);
+  out.ageDeci = (uint16_t)(age / 8640);
+}
+
+void computeMoon(time_t t, MoonState& out) {
+  int i = lunarTableIndex(t);
+  if (i >= 0) {
+    computeMoonFromTable(t, i, out);
+    return;
+  }
+
+  float elongation = lunarElongation(t);
+  out.computedAt = t;
+  out.illumination = illuminationPercent(elongation);
+  out.phase = (uint8_t)((int)((elongation + 22.5f) / 45.0f) % 8);
+
+  // Mean lunation from the epoch, then step to the one bracketing t
+  int32_t k = (int32_t)floorf((t - NEW_MOON_EPOCH) / (SYNODIC_MONTH_DAYS * 86400.0f));
+  while (lunarPhaseTime(k, false) > t) k--;
+  while (lunarPhaseTime(k + 1, false) <= t) k++;
+
+  out.lastNewMoon = lunarPhaseTime(k, false);
+  out.nextNewMoon = lunarPhaseTime(k + 1, false);
+  out.nextFullMoon = lunarPhaseTime(k, true);
+  if (out.nextFullMoon <= t) out.nextFullMoon = lunarPhaseTime(k + 1, true);
+  out.ageDeci = (uint16_t)((t - out.lastNewMoon) / 8640);
+}
+
+void updateMoon(const TimeContext& t) {
+  if (!t.valid) return;
+  if (moon.computedAt != 0 && t.epoch - moon.computedAt < 3600) return;
+  computeMoon(t.epoch, moon);
+}
+
+// --- CONFIGURATION MANAGEMENT ---
+void saveConfigCallback() { LOG_DEBUG("Should save config"); shouldSaveConfig = true; }
+void updateWeatherUrl() {
+  // This function is deprecated - fetchWeatherData() builds the URL itself
+  LOG_INFO("Location set to: %.4f, %.4f", atof(latitude), atof(longitude));
+}
+// Settings live in one fixed-layout record, /config.bin, loaded with a
+// single read and checked by magic, version, size and CRC32. A /config.json
+// from older firmware is migrated on first boot and then removed. New
+// fields go before crc with a version bump; loadConfig() keeps defaults for
+// fields an older record does not have.
+const char* CONFIG_PATH = "/config.bin";
+const char* CONFIG_TEMP_PATH = "/config.tmp";
+const char* LEGACY_CONFIG_PATH = "/config.json";
+const uint32_t CONFIG_MAGIC = 0x4643444D;  // "MDCF" little-endian
+const uint16_t CONFIG_VERSION = 2;  // 2: per-view enable mask and seconds
+
+struct ConfigRecord {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;  // bytes written, crc included
+  char cityName[sizeof(::cityName)];
+  char displayName[sizeof(::displayName)];
+  char latitude[sizeof(::latitude)];
+  char longitude[sizeof(::longitude)];
+  char timezone[sizeof(::timeZone)];
+  char tempUnit[sizeof(::tempUnit)];
+  uint8_t manualCoordinates;
+  uint8_t reserved;
+  uint32_t viewDuration;
+  uint8_t viewEnabledMask;
+  uint8_t viewSeconds[VIEW_COUNT];
+  uint8_t viewReserved[3];
+  uint32_t crc;  // CRC32 of all bytes before it
+};
+
+static_assert(offsetof(ConfigRecord, crc) + sizeof(uint32_t) == sizeof(ConfigRecord),
+              "crc must be the last field of ConfigRecord");
+
+void captureConfig(ConfigRecord& rec) {
+  memset(&rec, 0, sizeof(rec));
+  rec.magic = CONFIG_MAGIC;
+  rec.version = CONFIG_VERSION;
+  rec.size = sizeof(rec);
+  strlcpy(rec.cityName, cityName, sizeof(rec.cityName));
+  strlcpy(rec.displayName, displayName, sizeof(rec.displayName));
+  strlcpy(rec.latitude, latitude, sizeof(rec.latitude));
+  strlcpy(rec.longitude, longitude, sizeof(rec.longitude));
+  strlcpy(rec.timezone, timeZone, sizeof(rec.timezone));
+  strlcpy(rec.tempUnit, tempUnit, sizeof(rec.tempUnit));
+  rec.manualCoordinates = manualCoordinates;
+  rec.viewDuration = viewDuration;
+  rec.viewEnabledMask = viewEnabledMask;
+  memcpy(rec.viewSeconds, viewSeconds, sizeof(rec.viewSeconds));
+  rec.crc = crc32Update(0, (const uint8_t*)&rec, offsetof(ConfigRecord, crc));
+}
+
+void applyConfig(const ConfigRecord& rec) {
+  strlcpy(cityName, rec.cityName, sizeof(cityName));
+  strlcpy(displayName, rec.displayName, sizeof(displayName));
+  strlcpy(latitude, rec.latitude, sizeof(latitude));
+  strlcpy(longitude, rec.longitude, sizeof(longitude));
+  strlcpy(timeZone, rec.timezone, sizeof(timeZone));
+  strlcpy(tempUnit, rec.tempUnit, sizeof(tempUnit));
+  manualCoordinates = rec.manualCoordinates;
+  viewDuration = rec.viewDuration;
+  viewEnabledMask = rec.viewEnabledMask ? rec.viewEnabledMask : viewEnabledMask;
+  memcpy(viewSeconds, rec.viewSeconds, sizeof(viewSeconds));
+}
+
+bool readConfigRecord(ConfigRecord& rec) {
+  File file = LittleFS.open(CONFIG_PATH, "r");
+  if (!file) return false;
+
+  // Start from the current settings so a shorter, older record only
+  // overrides the fields it has
+  captureConfig(rec);
+  size_t length = file.size();
+  bool ok = length >= offsetof(ConfigRecord, cityName) + sizeof(uint32_t) && length <= sizeof(rec) &&
+            file.read((uint8_t*)&rec, length) == length;
+  file.close();
+  if (!ok) return false;
+
+  uint32_t storedCrc;
+  memcpy(&storedCrc, (const uint8_t*)&rec + length - sizeof(storedCrc), sizeof(storedCrc));
+  if (rec.magic != CONFIG_MAGIC || rec.version > CONFIG_VERSION || rec.size != length ||
+      crc32Update(0, (const uint8_t*)&rec, length - sizeof(storedCrc)) != storedCrc) {
+    return false;
+  }
+  if (length < sizeof(rec)) {
+    // The old crc landed on a newer field; restore the tail from defaults
+    ConfigRecord defaults;
+    captureConfig(defaults);
+    size_t tail = length - sizeof(storedCrc);
+    memcpy((uint8_t*)&rec + tail, (const uint8_t*)&defaults + tail, sizeof(rec) - tail);
+  }
+  return true;
+}
+
+// One-time import of the JSON settings written by older firmware
+bool migrateLegacyConfig() {
+  File configFile = LittleFS.open(LEGACY_CONFIG_PATH, "r");
+  if (!configFile) return false;
+
+  LOG_INFO("Migrating config.json");
+  DynamicJsonDocument json(1024);
+  DeserializationError error = deserializeJson(json, configFile);
+  configFile.close();
+  if (error) {
+    LOG_WARN("Failed to parse config.json: %s", error.c_str());
+    return false;
+  }
+
+  strlcpy(cityName, json["cityName"] | cityName, sizeof(cityName));
+  strlcpy(displayName, json["displayName"] | displayName, sizeof(displayName));
+  strlcpy(latitude, json["latitude"] | latitude, sizeof(latitude));
+  strlcpy(longitude, json["longitude"] | longitude, sizeof(longitude));
+  strlcpy(timeZone, json["timezone"] | timeZone, sizeof(timeZone));
+  strlcpy(tempUnit, json["tempUnit"] | tempUnit, sizeof(tempUnit));
+  viewDuration = json["viewDuration"] | viewDuration;
+  manualCoordinates = json["manualCoordinates"] | manualCoordinates;
+
+  if (!saveConfig()) return false;
+  LittleFS.remove(LEGACY_CONFIG_PATH);
+  return true;
+}
+
+void loadConfig() {
+  [[maybe_unused]] uint32_t start = micros();  // only logged
+  ConfigRecord rec;
+  if (readConfigRecord(rec)) {
+    applyConfig(rec);
+  } else if (!migrateLegacyConfig()) {
+    LOG_WARN("No valid config, using defaults");
+    return;
+  }
+  LOG_INFO("Loaded: %s at (%.2f, %.2f) in %u us", cityName, atof(latitude), atof(longitude),
+                  (unsigned)(micros() - start));
+}
+
+// Written to a temporary file and renamed over the old record, so a reset
+// mid-write leaves the previous settings intact
+bool saveConfig() {
+  TRACE_SPAN(TRACE_SAVE_CONFIG);
+  LOG_INFO("Saving config");
+  ConfigRecord rec;
+  captureConfig(rec);
+
+  File configFile = LittleFS.open(CONFIG_TEMP_PATH, "w");
+  if (!configFile) {
+    LOG_ERROR("Failed to open config file for writing");
+    return false;
+  }
+  bool written = configFile.write((const uint8_t*)&rec, sizeof(rec)) == sizeof(rec);
+  configFile.close();
+  if (!written || !LittleFS.rename(CONFIG_TEMP_PATH, CONFIG_PATH)) {
+    LOG_ERROR("Failed to write config");
+    LittleFS.remove(CONFIG_TEMP_PATH);
+    return false;
+  }
+  LOG_INFO("Config saved");
+  return true;
+}
+
+// --- WIFI CONNECTION ---
+// The last good association (BSSID, channel) and DHCP lease are cached in
+// /wifi.bin. With a cached lease the station joins that access point
+// directly with a static IP, skipping the scan and DHCP. Nothing here
+// waits: setup() starts the first attempt and updateWifi() sees it through,
+// down to the WiFiManager portal when no attempt gets through before the
+// link has ever been up. Credentials stay in the SDK's own flash config.
+// The lease is only reused until the DHCP server's lease time runs out.
+// Without a set clock at boot that can't be judged; the link then comes up
+// on the cached IP and moves to DHCP once the clock shows it has expired.
+// Once up, updateWifi() watches the link from loop() without blocking: a
+// fast attempt on the cached BSSID, then a full scan with DHCP, then
+// retries with a doubling backoff.
+const char* WIFI_LEASE_PATH = "/wifi.bin";
+const uint32_t WIFI_LEASE_MAGIC = 0x4C46494D;  // "MIFL" little-endian
+const unsigned long WIFI_FAST_TIMEOUT = 4000;
+const unsigned long WIFI_SCAN_TIMEOUT = 15000;
+const unsigned long WIFI_RETRY_MIN = 5000;
+const unsigned long WIFI_RETRY_MAX = 300000;
+const uint32_t WIFI_LEASE_FALLBACK = 3600;  // seconds, when the server's lease time is unknown
+
+struct WifiLease {
+  uint32_t magic;
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t reserved;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+  uint32_t leasedAt;      // clock when DHCP granted it, 0 until the clock is set
+  uint32_t leaseSeconds;  // as granted by the DHCP server
+  uint32_t crc;  // CRC32 of all bytes before it
+};
+
+// The settings fields on the portal page, while it is open
+struct PortalFields {
+  PortalFields(const char* durationStr, const char* manualStr)
+      : city("city", "City, Country", cityName, 50),
+        display("display", "Display Name (optional)", displayName, 30),
+        temp("temp", "Temp Unit (C/F/B)", tempUnit, 2),
+        duration("duration", "View Duration (sec)", durationStr, 4),
+        manual("manual", "Manual Coords? (0/1)", manualStr, 2),
+        lat("lat", "Latitude (if manual)", latitude, 10),
+        lon("lon", "Longitude (if manual)", longitude, 10) {}
+  WiFiManagerParameter city, display, temp, duration, manual, lat, lon;
+};
+
+WiFiManager wifiManager;
+PortalFields* portalFields = nullptr;
+WifiLease wifiLease;
+bool wifiLeaseValid = false;
+bool wifiStaticLease = false;      // link is up on the cached IP, not DHCP
+unsigned long wifiLeaseGrantedMs;  // millis() of the DHCP connect, to date the lease
+unsigned long wifiAttemptStart = 0;  // latest WiFi.begin()
+unsigned long wifiBackoffStart = 0;
+unsigned long wifiRetryDelay = WIFI_RETRY_MIN;
+
+bool loadWifiLease() {
+  File file = LittleFS.open(WIFI_LEASE_PATH, "r");
+  if (!file) return false;
+  bool ok = file.size() == sizeof(wifiLease) &&
+            file.read((uint8_t*)&wifiLease, sizeof(wifiLease)) == sizeof(wifiLease);
+  file.close();
+  wifiLeaseValid = ok && wifiLease.magic == WIFI_LEASE_MAGIC &&
+                   crc32Update(0, (const uint8_t*)&wifiLease, offsetof(WifiLease, crc)) == wifiLease.crc;
+  return wifiLeaseValid;
+}
+
+bool writeWifiLease(WifiLease& lease) {
+  lease.crc = crc32Update(0, (const uint8_t*)&lease, offsetof(WifiLease, crc));
+  File file = LittleFS.open(WIFI_LEASE_PATH, "w");
+  if (!file) {
+    LOG_ERROR("Failed to open wifi lease for writing");
+    return false;
+  }
+  bool written = file.write((const uint8_t*)&lease, sizeof(lease)) == sizeof(lease);
+  file.close();
+  if (!written) {
+    LOG_ERROR("Failed to write wifi lease");
+    return false;
+  }
+  wifiLease = lease;
+  wifiLeaseValid = true;
+  return true;
+}
+
+// After a DHCP connect: the access point and the lease just granted
+void saveWifiLease() {
+  WifiLease lease;
+  memset(&lease, 0, sizeof(lease));
+  lease.magic = WIFI_LEASE_MAGIC;
+  memcpy(lease.bssid, WiFi.BSSID(), sizeof(lease.bssid));
+  lease.channel = WiFi.channel();
+  lease.ip = (uint32_t)WiFi.localIP();
+  lease.gateway = (uint32_t)WiFi.gatewayIP();
+  lease.subnet = (uint32_t)WiFi.subnetMask();
+  lease.dns = (uint32_t)WiFi.dnsIP();
+  lease.leaseSeconds = halDhcpLeaseSeconds();
+  if (lease.leaseSeconds == 0) lease.leaseSeconds = WIFI_LEASE_FALLBACK;
+  TimeContext now;
+  captureTime(now);
+  lease.leasedAt = now.valid ? now.epoch : 0;
+  wifiLeaseGrantedMs = millis();
+  if (writeWifiLease(lease)) {
+    LOG_INFO("WiFi lease cached: channel %u, %s for %u s", lease.channel, WiFi.localIP().toString().c_str(),
+             (unsigned)lease.leaseSeconds);
+  }
+}
+
+// A lease granted before the clock was set is dated once it is
+void dateWifiLease() {
+  TimeContext now;
+  captureTime(now);
+  if (!now.valid) return;
+  WifiLease lease = wifiLease;
+  lease.leasedAt = now.epoch - (millis() - wifiLeaseGrantedMs) / 1000;
+  writeWifiLease(lease);
+}
+
+// False once the cached lease has run out, or when it was never dated.
+// With the clock not set yet it is taken on trust.
+bool wifiLeaseUsable() {
+  if (!wifiLeaseValid || wifiLease.leasedAt == 0) return false;
+  TimeContext now;
+  captureTime(now);
+  return !now.valid || now.epoch < (time_t)wifiLease.leasedAt + (time_t)wifiLease.leaseSeconds;
+}
+
+// Starts an association without waiting for it. persistent(false) keeps the
+// BSSID pin out of the SDK's flash config, so a later scan is a real scan.
+void beginWifiAttempt(bool fast) {
+  String ssid = WiFi.SSID();
+  String psk = WiFi.psk();
+  WiFi.persistent(false);
+  if (fast) {
+    WiFi.config(IPAddress(wifiLease.ip), IPAddress(wifiLease.gateway),
+                IPAddress(wifiLease.subnet), IPAddress(wifiLease.dns));
+    WiFi.begin(ssid.c_str(), psk.c_str(), wifiLease.channel, wifiLease.bssid);
+  } else {
+    WiFi.config(0U, 0U, 0U);  // back to DHCP
+    WiFi.begin(ssid.c_str(), psk.c_str());
+  }
+  WiFi.persistent(true);
+  wifiState = fast ? WIFI_FAST_RETRY : WIFI_SCAN_RETRY;
+  wifiAttemptStart = millis();
+}
+
+void recordWifiConnect(unsigned long start, bool fast) {
+  wifiLastConnectMs = millis() - start;
+  wifiLastConnectFast = fast;
+  wifiConnectTime.observe(wifiLastConnectMs * 1000);
+  wifiState = WIFI_UP;
+  wifiStaticLease = fast;
+  WiFi.setAutoReconnect(false);  // updateWifi() owns reconnects
+  LOG_INFO("WiFi connected (%s) in %u ms", fast ? "fast" : "scan", (unsigned)wifiLastConnectMs);
+  if (!fast) saveWifiLease();
+  strlcpy(wifiSsid, WiFi.SSID().c_str(), sizeof(wifiSsid));
+  if (bootPhaseMs[BOOT_SERVER] == 0) {
+    markBootPhase(BOOT_WIFI);
+    setupWebServer();  // not before: the portal holds port 80 until the link is up
+    markBootPhase(BOOT_SERVER);
+  }
+}
+
+// Non-blocking WiFiManager portal on the "ESP-Config" access point
+void startWifiPortal() {
+  char durationStr[12];  // any int, though the field takes 4 digits
+  snprintf(durationStr, sizeof(durationStr), "%d", viewDuration / 1000);
+  char manualStr[2] = {manualCoordinates ? '1' : '0', '\0'};
+  portalFields = new PortalFields(durationStr, manualStr);
+  wifiManager.setSaveConfigCallback(saveConfigCallback);
+  wifiManager.addParameter(&portalFields->city);
+  wifiManager.addParameter(&portalFields->display);
+  wifiManager.addParameter(&portalFields->temp);
+  wifiManager.addParameter(&portalFields->duration);
+  wifiManager.addParameter(&portalFields->manual);
+  wifiManager.addParameter(&portalFields->lat);
+  wifiManager.addParameter(&portalFields->lon);
+  wifiManager.setConfigPortalBlocking(false);
+
+  display.clearDisplay();
+  display.setTextSize(1);
+  display.setCursor(0, 0);
+  display.println(F("WiFi Setup Mode"));
+  display.println();
+  display.println(F("Connect to:"));
+  display.setTextSize(2);
+  display.println(F("ESP-Config"));
+  display.setTextSize(1);
+  display.println();
+  display.println(F("Then open:"));
+  display.println(F("192.168.4.1"));
+  display.display();
+
+  wifiState = WIFI_PORTAL;
+  wifiAttemptStart = millis();
+  wifiManager.autoConnect("ESP-Config");
+}
+
+// Takes over what was entered in the portal. Saved coordinates are reused;
+// only a changed city needs geocoding, done by the boot job.
+void applyPortalSettings() {
+  PortalFields& fields = *portalFields;
+  bool cityChanged = strcmp(cityName, fields.city.getValue()) != 0;
+  strcpy(cityName, fields.city.getValue());
+  strcpy(displayName, fields.display.getValue());
+  strcpy(tempUnit, fields.temp.getValue());
+  viewDuration = atoi(fields.duration.getValue()) * 1000;
+  manualCoordinates = (atoi(fields.manual.getValue()) == 1);
+
+  if (manualCoordinates) {
+    strcpy(latitude, fields.lat.getValue());
+    strcpy(longitude, fields.lon.getValue());
+    LOG_INFO("Using manual coordinates");
+  }
+
+  if (strlen(displayName) == 0) {
+    strcpy(displayName, cityName);
+  }
+
+  bool geocode = cityChanged && !manualCoordinates;
+  if (geocode || shouldSaveConfig) {
+    bootJobId = queueSettingsJob(geocode, shouldSaveConfig);
+  }
+  delete portalFields;
+  portalFields = nullptr;
+}
+
+// Starts the first association and returns at once: the cached access
+// point when its lease still holds, else a scan with DHCP
+void startWifi() {
+  WiFi.mode(WIFI_STA);
+  if (WiFi.SSID().length() == 0) {
+    startWifiPortal();
+    return;
+  }
+  loadWifiLease();
+  beginWifiAttempt(wifiLeaseUsable());
+}
+
+void updateWifi() {
+  unsigned long now = millis();
+  bool connected = WiFi.status() == WL_CONNECTED;
+  switch (wifiState) {
+    case WIFI_UP:
+      if (connected) {
+        if (wifiStaticLease && !wifiLeaseUsable()) {
+          LOG_INFO("WiFi lease expired, renewing over DHCP");
+          wifiDownSince = now;
+          beginWifiAttempt(false);
+        } else if (!wifiStaticLease && wifiLeaseValid && wifiLease.leasedAt == 0) {
+          dateWifiLease();
+        }
+        return;
+      }
+      wifiDisconnects++;
+      wifiDownSince = now;
+      wifiRetryDelay = WIFI_RETRY_MIN;
+      LOG_WARN("WiFi lost, reconnecting");
+      beginWifiAttempt(wifiLeaseUsable());
+      return;
+    case WIFI_FAST_RETRY:
+    case WIFI_SCAN_RETRY: {
+      bool fast = wifiState == WIFI_FAST_RETRY;
+      if (connected) {
+        bool reconnect = bootPhaseMs[BOOT_WIFI] != 0;
+        recordWifiConnect(wifiAttemptStart, fast);
+        if (reconnect) LOG_INFO("WiFi was down for %lu ms", now - wifiDownSince);
+        return;
+      }
+      if (now - wifiAttemptStart < (fast ? WIFI_FAST_TIMEOUT : WIFI_SCAN_TIMEOUT)) return;
+      if (fast) {
+        beginWifiAttempt(false);
+      } else if (bootPhaseMs[BOOT_WIFI] == 0) {
+        LOG_WARN("WiFi not up after boot, starting the setup portal");
+        startWifiPortal();
+      } else {
+        LOG_WARN("WiFi still down, retrying in %lu s", wifiRetryDelay / 1000);
+        wifiState = WIFI_BACKOFF;
+        wifiBackoffStart = now;
+      }
+      return;
+    }
+    case WIFI_BACKOFF:
+      if (connected) {
+        // The last scan attempt got through late; timed from its WiFi.begin()
+        recordWifiConnect(wifiAttemptStart, false);
+        return;
+      }
+      if (now - wifiBackoffStart < wifiRetryDelay) return;
+      wifiRetryDelay = min(wifiRetryDelay * 2, WIFI_RETRY_MAX);
+      beginWifiAttempt(wifiLeaseUsable());
+      return;
+    case WIFI_PORTAL:
+      if (!wifiManager.process() && !connected) return;
+      applyPortalSettings();
+      recordWifiConnect(wifiAttemptStart, false);
+      drawView(currentView);
+      lastViewChangeTime = millis();
+      return;
+    default:
+      return;
+  }
+}
+
+// --- RTC STATE ---
+// Weather, the clock and the current view are mirrored into the RTC user
+// memory, which keeps its contents across every reset except a power
+// cycle. After a watchdog, exception or software reset setup() restores
+// them, so the dashboard comes back with data on screen and skips the
+// initial fetch while the weather is still fresh. The first 128 bytes of
+// RTC user memory belong to the OTA bootloader, so the block starts after.
+const uint32_t RTC_STATE_OFFSET = 32;  // in 4-byte blocks
+const uint32_t RTC_STATE_MAGIC = 0x5354524D;  // "MRTS" little-endian
+const uint16_t RTC_STATE_VERSION = 2;
+const time_t WEATHER_MAX_AGE = 600;  // seconds, matches the loop() refresh
+
+struct RtcState {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;
+  uint32_t epoch;         // clock when written, 0 if not yet set
+  uint32_t weatherEpoch;  // weatherFetchedAt
+  uint8_t view;
+  uint8_t quoteIndex;
+  uint16_t epochMs;       // milliseconds past epoch, read with it
+  WeatherSnapshot weather;
+  uint32_t crc;  // CRC32 of all bytes before it
+};
+
+static_assert(sizeof(RtcState) % 4 == 0, "RTC user memory is accessed in 4-byte blocks");
+static_assert(RTC_STATE_OFFSET * 4 + sizeof(RtcState) <= 512, "RtcState must fit in RTC user memory");
+
+void captureRtcState(RtcState& state) {
+  memset(&state, 0, sizeof(state));
+  state.magic = RTC_STATE_MAGIC;
+  state.version = RTC_STATE_VERSION;
+  state.size = sizeof(state);
+  timeval tv;
+  halGetTime(tv);
+  TimeContext now;
+  captureTime(now);
+  if (now.valid) {
+    state.epoch = tv.tv_sec;
+    state.epochMs = tv.tv_usec / 1000;
+  }
+  state.weatherEpoch = weatherFetchedAt;
+  state.view = currentView;
+  state.quoteIndex = currentQuoteIndex;
+  state.weather = weather;
+  state.crc = crc32Update(0, (const uint8_t*)&state, offsetof(RtcState, crc));
+}
+
+bool isValidRtcState(const RtcState& state) {
+  return state.magic == RTC_STATE_MAGIC && state.version == RTC_STATE_VERSION &&
+         state.size == sizeof(state) &&
+         crc32Update(0, (const uint8_t*)&state, offsetof(RtcState, crc)) == state.crc;
+}
+
+void saveRtcState() {
+  RtcState state;
+  captureRtcState(state);
+  ESP.rtcUserMemoryWrite(RTC_STATE_OFFSET, (uint32_t*)&state, sizeof(state));
+}
+
+bool restoreRtcState() {
+  // After power-on the RTC memory holds noise; the CRC would catch it too
+  if (ESP.getResetInfoPtr()->reason == REASON_DEFAULT_RST) return false;
+
+  RtcState state;
+  if (!ESP.rtcUserMemoryRead(RTC_STATE_OFFSET, (uint32_t*)&state, sizeof(state)) ||
+      !isValidRtcState(state)) {
+    LOG_INFO("No RTC state, cold start");
+    return false;
+  }
+
+  weather = state.weather;
+  weatherFetchedAt = state.weatherEpoch;
+  if (state.view < VIEW_COUNT) {
+    currentView = static_cast<View>(state.view);
+  }
+  currentQuoteIndex = state.quoteIndex % NUM_QUOTES;
+  if (state.epoch != 0) {
+    // millis() restarted with the reset, so the time between the save and
+    // the reset (up to RTC_SAVE_INTERVAL plus the reset itself) is lost and
+    // the clock comes back that far behind; SNTP corrects it
+    uint32_t ms = state.epochMs + millis();
+    timeval tv = {(time_t)(state.epoch + ms / 1000), (suseconds_t)(ms % 1000) * 1000};
+    halSetTime(tv);
+  }
+  LOG_INFO("Warm start (%s): restored view %u, weather from %u",
+                  ESP.getResetReason().c_str(), state.view, (unsigned)state.weatherEpoch);
+  return true;
+}
+
+bool weatherIsFresh() {
+  TimeContext now;
+  captureTime(now);
+  return weatherFetchedAt != 0 && now.valid && now.epoch - weatherFetchedAt < WEATHER_MAX_AGE;
+}
+
+// --- BACKGROUND JOBS ---
+// Settings changes are answered immediately with a job ID; the slow part
+// (geocoding, saving, refetching) is done by runJobs() one step per loop()
+// pass, so the web server and display keep running in between. A save that
+// arrives while another is still queued is merged into it.
+const int MAX_JOBS = 4;
+
+enum JobState { JOB_QUEUED, JOB_RUNNING, JOB_DONE, JOB_FAILED };
+enum JobStep { JOB_STEP_GEOCODE, JOB_STEP_SAVE, JOB_STEP_FETCH };
+
+struct Job {
+  uint16_t id;
+  JobState state;
+  JobStep step;
+  bool geocode;
+  bool save;
+  unsigned long queuedAt;
+  unsigned long finishedAt;
+  PGM_P error;
+};
+
+Job jobs[MAX_JOBS];
+uint16_t nextJobId = 1;
+
+PGM_P jobStateName(JobState state) {
+  switch (state) {
+    case JOB_QUEUED: return PSTR("queued");
+    case JOB_RUNNING: return PSTR("running");
+    case JOB_DONE: return PSTR("done");
+    default: return PSTR("failed");
+  }
+}
+
+PGM_P jobStepName(JobStep step) {
+  switch (step) {
+    case JOB_STEP_GEOCODE: return PSTR("geocode");
+    case JOB_STEP_SAVE: return PSTR("save");
+    default: return PSTR("fetch");
+  }
+}
+
+Job* findJob(long id) {
+  for (int i = 0; i < MAX_JOBS; i++) {
+    if (jobs[i].id != 0 && jobs[i].id == id) {
+      return &jobs[i];
+    }
+  }
+  return nullptr;
+}
+
+// Returns the job ID, or -1 when every slot holds an unfinished job.
+int queueSettingsJob(bool geocode, bool save) {
+  Job* slot = nullptr;
+  for (int i = 0; i < MAX_JOBS; i++) {
+    Job& job = jobs[i];
+    if (job.id != 0 && job.state == JOB_QUEUED) {
+      job.geocode = job.geocode || geocode;
+      job.save = job.save || save;
+      return job.id;
+    }
+    if (job.id == 0) {
+      if (!slot || slot->id != 0) slot = &job;  // prefer unused slots
+      continue;
+    }
+    bool finished = job.state == JOB_DONE || job.state == JOB_FAILED;
+    if (finished && (!slot || (slot->id != 0 && (long)(job.finishedAt - slot->finishedAt) < 0))) {
+      slot = &job;  // otherwise recycle the oldest finished job
+    }
+  }
+  if (!slot) return -1;
+
+  slot->id = nextJobId++;
+  if (nextJobId == 0) nextJobId = 1;
+  slot->state = JOB_QUEUED;
+  slot->step = JOB_STEP_GEOCODE;
+  slot->geocode = geocode;
+  slot->save = save;
+  slot->queuedAt = millis();
+  slot->finishedAt = 0;
+  slot->error = nullptr;
+  return slot->id;
+}
+
+void runJobs() {
+  Job* job = nullptr;
+  for (int i = 0; i < MAX_JOBS && !job; i++) {
+    if (jobs[i].id != 0 && jobs[i].state == JOB_RUNNING) job = &jobs[i];
+  }
+  for (int i = 0; i < MAX_JOBS && !job && wifiState == WIFI_UP; i++) {
+    if (jobs[i].id != 0 && jobs[i].state == JOB_QUEUED) {
+      job = &jobs[i];
+      job->state = JOB_RUNNING;
+      LOG_INFO("Job %u started", job->id);
+      return;  // let pending responses go out before the first step
+    }
+  }
+  if (!job) return;
+
+  switch (job->step) {
+    case JOB_STEP_GEOCODE:
+      if (job->geocode) {
+        if (!fetchGeocodingData(String(cityName))) {
+          job->error = PSTR("Geocoding failed");
+        }
+        if (job->id == bootJobId) markBootPhase(BOOT_GEOCODE);
+      }
+      job->step = JOB_STEP_SAVE;
+      break;
+    case JOB_STEP_SAVE:
+      if (job->save && !saveConfig() && job->error == nullptr) {
+        job->error = PSTR("Saving settings failed");
+      }
+      job->step = JOB_STEP_FETCH;
+      break;
+    case JOB_STEP_FETCH:
+      updateWeatherUrl();
+      if (fetchWeatherData()) {
+        if (job->id == bootJobId) markBootPhase(BOOT_WEATHER);
+      } else if (job->error == nullptr) {
+        job->error = PSTR("Weather fetch failed");
+      }
+      if (job->id == bootJobId) bootJobId = -1;
+      job->state = job->error ? JOB_FAILED : JOB_DONE;
+      job->finishedAt = millis();
+      if (job->error) {
+        LOG_INFO("Job %u failed", job->id);
+      } else {
+        LOG_INFO("Job %u done", job->id);
+      }
+      break;
+  }
+}
+
+// --- HTTP SERVER IMPLEMENTATION ---
+PGM_P httpReason(int code) {
+  switch (code) {
+    case 200: return PSTR("OK");
+    case 202: return PSTR("Accepted");
+    case 400: return PSTR("Bad Request");
+    case 404: return PSTR("Not Found");
+    case 405: return PSTR("Method Not Allowed");
+    case 413: return PSTR("Payload Too Large");
+    case 500: return PSTR("Internal Server Error");
+    case 503: return PSTR("Service Unavailable");
+    default: return PSTR("");
+  }
+}
+
+int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// Looks up name in an application/x-www-form-urlencoded string and decodes
+// its value into *value (if given).
+bool findFormArg(const char* data, size_t length, const char* name, String* value) {
+  size_t nameLength = strlen(name);
+  const char* end = data + length;
+  const char* p = data;
+  while (p && p < end) {
+    const char* next = (const char*)memchr(p, '&', end - p);
+    const char* pairEnd = next ? next : end;
+    const char* eq = (const char*)memchr(p, '=', pairEnd - p);
+    const char* keyEnd = eq ? eq : pairEnd;
+    if ((size_t)(keyEnd - p) == nameLength && strncmp(p, name, nameLength) == 0) {
+      if (value) {
+        *value = "";
+        for (const char* v = eq ? eq + 1 : pairEnd; v < pairEnd; v++) {
+          if (*v == '+') {
+            *value += ' ';
+          } else if (*v == '%' && v + 2 < pairEnd && hexValue(v[1]) >= 0 && hexValue(v[2]) >= 0) {
+            *value += (char)(hexValue(v[1]) * 16 + hexValue(v[2]));
+            v += 2;
+          } else {
+            *value += *v;
+          }
+        }
+      }
+      return true;
+    }
+    p = next ? next + 1 : nullptr;
+  }
+  return false;
+}
+
+void DashboardServer::on(const char* path, HTTPMethod method, Handler handler) {
+  if (routeCount >= HTTP_MAX_ROUTES) {
+    LOG_ERROR("HTTP route table full, dropping %s", path);
+    return;
+  }
+  routes[routeCount++] = {path, method, handler, false};
+}
+
+// Matches any path starting with prefix; the handler reads the rest via uri().
+void DashboardServer::onPrefix(const char* prefix, HTTPMethod method, Handler handler) {
+  on(prefix, method, handler);
+  if (routeCount > 0 && routes[routeCount - 1].path == prefix) {
+    routes[routeCount - 1].prefix = true;
+  }
+}
+
+void DashboardServer::begin() {
+  listener.begin();
+  listener.setNoDelay(true);
+}
+
+void DashboardServer::handleClient() {
+  accept();
+  for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+    Connection& c = connections[i];
+    if (c.state == CONN_FREE) continue;
+
+    if (c.state == CONN_READING) {
+      readRequest(c);
+    }
+    if (c.state == CONN_WRITING) {
+      writeResponse(c);
+    }
+    if (c.state != CONN_FREE &&
+        (!c.client.connected() || millis() - c.lastActivity > HTTP_TIMEOUT_MS)) {
+      close(c);
+    }
+  }
+}
+
+// Takes pending connections only while the pool has room; the others stay
+// queued in the listen backlog instead of being turned away, so a page that
+// opens more connections than there are slots still gets every response.
+void DashboardServer::accept() {
+  while (listener.hasClient()) {
+    Connection* slot = freeConnection();
+    if (!slot) return;
+    WiFiClient client = listener.accept();
+    client.setNoDelay(true);
+    slot->client = client;
+    slot->state = CONN_READING;
+    slot->lastActivity = millis();
+    slot->requestLength = 0;
+    slot->bodyOffset = 0;
+  }
+}
+
+DashboardServer::Connection* DashboardServer::freeConnection() {
+  for (int i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+    if (connections[i].state == CONN_FREE) return &connections[i];
+  }
+  return nullptr;
+}
+
+void DashboardServer::readRequest(Connection& c) {
+  int available = c.client.available();
+  if (available <= 0) return;
+
+  size_t room = HTTP_REQUEST_BUFFER_SIZE - 1 - c.requestLength;
+  if (room == 0) {
+    reject(c.client, 413, "Request too large");
+    close(c);
+    return;
+  }
+  int n = c.client.read((uint8_t*)c.request + c.requestLength, min((size_t)available, room));
+  if (n <= 0) return;
+  c.requestLength += n;
+  c.request[c.requestLength] = '\0';
+  c.lastActivity = millis();
+
+  if (c.bodyOffset == 0) {
+    const char* headerEnd = strstr(c.request, "\r\n\r\n");
+    if (!headerEnd) return;
+    c.bodyOffset = headerEnd + 4 - c.request;
+    if (!parseRequest(c)) {
+      reject(c.client, 400, "Bad request");
+      close(c);
+      return;
+    }
+  }
+
+  size_t headerLength;
+  const char* contentLength = findHeader(c, "Content-Length", &headerLength);
+  size_t bodyLength = contentLength ? strtoul(contentLength, nullptr, 10) : 0;
+  if (c.bodyOffset + bodyLength > HTTP_REQUEST_BUFFER_SIZE - 1) {
+    reject(c.client, 413, "Request too large");
+    close(c);
+    return;
+  }
+  if (c.requestLength >= c.bodyOffset + bodyLength) {
+    dispatch(c);
+  }
+}
+
+// Splits the request line into method, path and query (pointers into the
+// connection buffer, nothing is copied).
+bool DashboardServer::parseRequest(Connection& c) {
+  if (strncmp(c.request, "GET ", 4) == 0) {
+    c.method = HTTP_GET;
+  } else if (strncmp(c.request, "POST ", 5) == 0) {
+    c.method = HTTP_POST;
+  } else {
+    c.method = HTTP_ANY;
+  }
+
+  const char* target = strchr(c.request, ' ');
+  if (!target) return false;
+  target++;
+  const char* targetEnd = strchr(target, ' ');
+  if (!targetEnd) return false;
+
+  const char* q = (const char*)memchr(target, '?', targetEnd - target);
+  c.path = target;
+  c.pathLength = (q ? q : targetEnd) - target;
+  c.query = q ? q + 1 : targetEnd;
+  c.queryLength = targetEnd - c.query;
+  return true;
+}
+
+void DashboardServer::dispatch(Connection& c) {
+  current = &c;
+  pendingHeaders = "";
+  pendingContentLength = CONTENT_LENGTH_UNKNOWN;
+
+  bool pathMatched = false;
+  bool handled = false;
+  for (int i = 0; i < routeCount && !handled; i++) {
+    const Route& r = routes[i];
+    size_t routeLength = strlen(r.path);
+    if (r.prefix ? routeLength > c.pathLength : routeLength != c.pathLength) continue;
+    if (strncmp(r.path, c.path, routeLength) != 0) continue;
+    pathMatched = true;
+    if (r.method != HTTP_ANY && r.method != c.method) continue;
+    r.handler();
+    handled = true;
+  }
+
+  if (c.state != CONN_WRITING) {
+    if (!pathMatched) {
+      send(404, "text/plain", "Not found");
+    } else if (!handled) {
+      send(405, "text/plain", "Method not allowed");
+    } else {
+      send(500, "text/plain", "No response");
+    }
+  }
+  current = nullptr;
+  pendingHeaders = "";
+}
+
+HTTPMethod DashboardServer::method() const {
+  return current ? current->method : HTTP_ANY;
+}
+
+String DashboardServer::uri() const {
+  if (!current) return String();
+  String path;
+  path.concat(current->path, current->pathLength);
+  return path;
+}
+
+bool DashboardServer::hasArg(const char* name) const {
+  if (!current) return false;
+  return findFormArg(current->query, current->queryLength, name, nullptr) ||
+         findFormArg(current->request + current->bodyOffset,
+                     current->requestLength - current->bodyOffset, name, nullptr);
+}
+
+String DashboardServer::arg(const char* name) const {
+  String value;
+  if (current && !findFormArg(current->query, current->queryLength, name, &value)) {
+    findFormArg(current->request + current->bodyOffset,
+                current->requestLength - current->bodyOffset, name, &value);
+  }
+  return value;
+}
+
+String DashboardServer::header(const char* name) const {
+  String value;
+  size_t length;
+  const char* start = current ? findHeader(*current, name, &length) : nullptr;
+  if (start) {
+    value.concat(start, length);
+  }
+  return value;
+}
+
+// Case-insensitive header lookup; returns the trimmed value in place.
+const char* DashboardServer::findHeader(const Connection& c, const char* name, size_t* length) const {
+  size_t nameLength = strlen(name);
+  const char* line = strstr(c.request, "\r\n");
+  const char* end = c.request + c.bodyOffset - 2;
+  while (line && line < end) {
+    line += 2;
+    const char* lineEnd = strstr(line, "\r\n");
+    if (!lineEnd) break;
+    if ((size_t)(lineEnd - line) > nameLength && line[nameLength] == ':' &&
+        strncasecmp(line, name, nameLength) == 0) {
+      const char* value = line + nameLength + 1;
+      while (value < lineEnd && *value == ' ') value++;
+      *length = lineEnd - value;
+      return value;
+    }
+    line = lineEnd;
+  }
+  return nullptr;
+}
+
+void DashboardServer::sendHeader(const char* name, const String& value) {
+  pendingHeaders += name;
+  pendingHeaders += ": ";
+  pendingHeaders += value;
+  pendingHeaders += "\r\n";
+}
+
+void DashboardServer::beginResponse(Connection& c, int code, const char* contentType, size_t length) {
+  char status[16];
+  snprintf_P(status, sizeof(status), PSTR("HTTP/1.1 %d "), code);
+  httpResponses.increment(code);
+  c.head = status;
+  c.head += FPSTR(httpReason(code));
+  c.head += F("\r\nContent-Type: ");
+  c.head += contentType;
+  c.head += F("\r\n");
+  if (length != CONTENT_LENGTH_UNKNOWN) {
+    c.head += F("Content-Length: ");
+    c.head += String((unsigned long)length);
+    c.head += F("\r\n");
+  }
+  c.head += pendingHeaders;
+  c.head += F("Connection: close\r\n\r\n");
+  c.body = "";
+  c.staticBody = nullptr;
+  c.staticLength = 0;
+  c.generator = nullptr;
+  c.cursor = 0;
+  c.sent = 0;
+  c.state = CONN_WRITING;
+  c.lastActivity = millis();
+}
+
+// With setContentLength() set and empty content, the body follows through
+// sendContent(), as with ESP8266WebServer.
+void DashboardServer::send(int code, const char* contentType, const String& content) {
+  if (!current) return;
+  size_t length = pendingContentLength != CONTENT_LENGTH_UNKNOWN ? pendingContentLength : content.length();
+  beginResponse(*current, code, contentType, length);
+  current->body += content;
+}
+
+// Sends a constant body by reference instead of copying it into the
+// connection buffer.
+void DashboardServer::send_P(int code, const char* contentType, PGM_P content) {
+  if (!current) return;
+  beginResponse(*current, code, contentType, strlen_P(content));
+  current->staticBody = content;
+  current->staticLength = strlen_P(content);
+}
+
+// Streams a body produced piece by piece as the TCP window drains, so only
+// one piece is buffered at a time. The end is marked by closing the
+// connection instead of a Content-Length.
+void DashboardServer::sendStream(int code, const char* contentType, Generator generator) {
+  if (!current) return;
+  beginResponse(*current, code, contentType, CONTENT_LENGTH_UNKNOWN);
+  current->generator = generator;
+}
+
+// Pieces are gathered up to a TCP segment and then written through to the
+// socket, as much as the window takes. Only what it refuses stays buffered,
+// so a streamed body no longer sits in RAM whole.
+void DashboardServer::sendContent(const char* data, size_t length) {
+  if (!current) return;
+  Connection& c = *current;
+  c.body.concat(data, length);
+  if (c.body.length() >= HTTP_WRITE_CHUNK_SIZE && drain(c)) {
+    c.body = "";
+    c.sent = c.head.length();
+  }
+}
+
+// Sends buffered head and body bytes while the TCP window has room; true
+// once nothing is left.
+bool DashboardServer::drain(Connection& c) {
+  size_t headLength = c.head.length();
+  size_t bodyLength = c.staticBody ? c.staticLength : c.body.length();
+  size_t total = headLength + bodyLength;
+
+  while (c.sent < total) {
+    size_t room = c.client.availableForWrite();
+    if (room == 0) return false;
+
+    size_t written;
+    if (c.sent < headLength) {
+      written = c.client.write((const uint8_t*)c.head.c_str() + c.sent, min(room, headLength - c.sent));
+    } else {
+      size_t offset = c.sent - headLength;
+      size_t n = min(room, bodyLength - offset);
+      if (c.staticBody) {
+        written = c.client.write_P(c.staticBody + offset, n);
+      } else {
+        written = c.client.write((const uint8_t*)c.body.c_str() + offset, n);
+      }
+    }
+    if (written == 0) return false;
+    c.sent += written;
+    c.lastActivity = millis();
+  }
+  return true;
+}
+
+void DashboardServer::writeResponse(Connection& c) {
+  while (drain(c)) {
+    if (!c.generator) {
+      close(c);
+      return;
+    }
+    c.body = "";
+    c.sent = c.head.length();
+    if (!c.generator(c.body, c.cursor)) {
+      c.generator = nullptr;
+    }
+  }
+}
+
+void DashboardServer::close(Connection& c) {
+  c.client.stop(0);
+  c.state = CONN_FREE;
+  c.requestLength = 0;
+  c.bodyOffset = 0;
+  c.head = String();
+  c.body = String();
+  c.staticBody = nullptr;
+}
+
+// Short responses on connections that never get a pool slot or a handler.
+void DashboardServer::reject(WiFiClient& client, int code, const char* message) {
+  httpResponses.increment(code);
+  char reason[24];
+  strlcpy_P(reason, httpReason(code), sizeof(reason));
+  char response[160];
+  int n = snprintf_P(response, sizeof(response),
+                     PSTR("HTTP/1.1 %d %s\r\nContent-Type: text/plain\r\nContent-Length: %u\r\n"
+                          "Connection: close\r\n\r\n%s"),
+                     code, reason, (unsigned)strlen(message), message);
+  client.write((const uint8_t*)response, n);
+  client.stop(0);
+}
+
+// --- WEB SERVER ---
+void setupWebServer() {
+  server.on("/", handleRoot);
+  server.on("/api", handleAPI);
+  server.on("/settings", handleSettings);
+  server.on("/settings/save", HTTP_POST, handleSettingsSave);
+  server.onPrefix("/api/jobs/", HTTP_GET, handleJobStatus);
+  server.on("/screen.pbm", handleScreenPBM);
+  server.on("/screen.png", handleScreenPNG);
+  server.on("/metrics", HTTP_GET, handleMetrics);
+  server.on("/trace", HTTP_GET, handleTrace);
+  server.on("/log", HTTP_GET, handleLog);
+
+  server.begin();
+  LOG_INFO("Web server started, dashboard at http://%s", WiFi.localIP().toString().c_str());
+}
+
+// --- API VERSIONING ---
+// /api fields are grouped, and each group remembers the data version at
+// which it last changed. Fingerprints are compared on every request, so a
+// client passing ?since=<version> only receives the groups changed after it.
+// Versions handed out are apiBootId * 2^32 + apiVersion. The boot id comes
+// from the hardware RNG, so a version kept across a reboot never matches
+// and gets everything; its 21 bits keep the total exact as a JS number.
+enum ApiGroup { API_SYSTEM, API_TIME, API_WEATHER, API_SUN, API_MOON, API_FORECAST, API_CONFIG, API_HEAP, API_GROUP_COUNT };
+uint32_t apiBootId = 0;
+uint32_t apiVersion = 0;  // changes so far this boot
+uint32_t apiGroupVersions[API_GROUP_COUNT];
+uint32_t apiGroupFingerprints[API_GROUP_COUNT];
+
+uint32_t fnv1a(uint32_t hash, const void* data, size_t length) {
+  const uint8_t* p = (const uint8_t*)data;
+  while (length--) {
+    hash = (hash ^ *p++) * 16777619UL;
+  }
+  return hash;
+}
+
+uint32_t fnv1a(uint32_t hash, const char* text) { return fnv1a(hash, text, strlen(text)); }
+uint32_t fnv1a(uint32_t hash, int32_t value) { return fnv1a(hash, &value, sizeof(value)); }
+uint32_t fnv1a(uint32_t hash, float value) { return fnv1a(hash, &value, sizeof(value)); }
+
+void touchApiGroup(ApiGroup group, uint32_t fingerprint) {
+  if (apiGroupVersions[group] == 0 || apiGroupFingerprints[group] != fingerprint) {
+    apiGroupFingerprints[group] = fingerprint;
+    apiGroupVersions[group] = ++apiVersion;
+  }
+}
+
+uint64_t apiVersionToken(uint32_t version) { return ((uint64_t)apiBootId << 32) | version; }
+
+// The version a ?since= token stands for this boot; 0 (everything) for
+// tokens from another boot or from the future
+uint32_t apiSinceVersion(uint64_t token) {
+  if (token >> 32 != apiBootId || (uint32_t)token > apiVersion) return 0;
+  return (uint32_t)token;
+}
+
+void refreshApiVersions(const TimeContext& now) {
+  if (apiBootId == 0) {
+    apiBootId = 1 + ESP.random() % 0x1FFFFF;
+  }
+
+  // Free heap, fragmentation and RSSI move on every poll; they are left out
+  // and ride along when uptime ticks over a minute, or anything else changes
+  uint32_t h = fnv1a(FNV_OFFSET_BASIS, (int32_t)((millis() - bootTime) / 60000));
+  h = fnv1a(h, (int32_t)heapMinMaxBlock);
+  h = fnv1a(h, (int32_t)(uint32_t)WiFi.localIP());
+  h = fnv1a(h, WiFi.SSID().c_str());
+  h = fnv1a(h, bootPhaseMs, sizeof(bootPhaseMs));
+  h = fnv1a(h, (int32_t)wifiState);
+  h = fnv1a(h, (int32_t)wifiDisconnects);
+  h = fnv1a(h, (int32_t)wifiLastConnectMs);
+  touchApiGroup(API_SYSTEM, h);
+
+  h = FNV_OFFSET_BASIS;
+  if (now.valid) {
+    h = fnv1a(h, (int32_t)(now.local.tm_yday * 1440 + now.local.tm_hour * 60 + now.local.tm_min));
+  }
+  h = fnv1a(h, (int32_t)ntpClock.syncs);
+  h = fnv1a(h, (int32_t)ntpClock.failures);
+  touchApiGroup(API_TIME, h);
+
+  h = fnv1a(FNV_OFFSET_BASIS, (int32_t)weather.tempDeci);
+  h = fnv1a(h, (int32_t)weather.code);
+  h = fnv1a(h, tempUnit);
+  touchApiGroup(API_WEATHER, h);
+
+  h = fnv1a(FNV_OFFSET_BASIS, &solarDay, sizeof(solarDay));
+  touchApiGroup(API_SUN, h);
+
+  h = fnv1a(FNV_OFFSET_BASIS, &moon, sizeof(moon));
+  touchApiGroup(API_MOON, h);
+
+  h = FNV_OFFSET_BASIS;
+  for (const ForecastDay& fc : weather.forecast) {
+    h = fnv1a(h, (int32_t)fc.date);
+    h = fnv1a(h, (int32_t)fc.maxDeci);
+    h = fnv1a(h, (int32_t)fc.minDeci);
+    h = fnv1a(h, (int32_t)fc.code);
+  }
+  touchApiGroup(API_FORECAST, h);
+
+  h = fnv1a(FNV_OFFSET_BASIS, displayName);
+  h = fnv1a(h, (int32_t)viewDuration);
+  h = fnv1a(h, (int32_t)viewEnabledMask);
+  h = fnv1a(h, viewSeconds, sizeof(viewSeconds));
+  touchApiGroup(API_CONFIG, h);
+
+  // The history only changes when a sample lands, not on every heap wobble
+  touchApiGroup(API_HEAP, fnv1a(FNV_OFFSET_BASIS, (int32_t)heapSamplesTaken));
+}
+
+// MessagePack is picked with ?format=msgpack or an Accept header naming it
+bool wantsMsgPack() {
+  if (server.arg("format") == "msgpack") return true;
+  return server.header("Accept").indexOf("msgpack") >= 0;
+}
+
+// Full JSON uses descriptive keys and display strings. The compact MessagePack
+// form uses short keys, integers (temperatures in tenths of a degree C, uptime
+// in seconds, time as epoch) and drops fields derivable from codes.
+void handleAPI() {
+  TRACE_SPAN(TRACE_HANDLE_API);
+  TimeContext now;
+  captureTime(now);
+  refreshApiVersions(now);
+
+  uint32_t since = 0;
+  if (server.hasArg("since")) {
+    since = apiSinceVersion(strtoull(server.arg("since").c_str(), nullptr, 10));
+  }
+
+  const bool compact = wantsMsgPack();
+  auto key = [compact](const char* full, const char* brief) { return compact ? brief : full; };
+  uint32_t start = micros();
+
+  // ArduinoJson keeps const char* by reference, so these outlive the document
+  char hhmm[6], date[11], day[10], uptime[12], dayLength[12];
+  char sunrise[6], sunset[6], dawn[6], noon[6], dusk[6], forecastDates[FORECAST_DAYS][11];
+  DynamicJsonDocument doc(2048 + HEAP_SAMPLES * 64);  // 64 bytes per heap history row
+  doc[key("version", "v")] = apiVersionToken(apiVersion);
+
+  // System info
+  if (apiGroupVersions[API_SYSTEM] > since) {
+    if (compact) {
+      doc["up"] = (millis() - bootTime) / 1000;
+      doc["ip"] = (uint32_t)WiFi.localIP();
+    } else {
+      doc["uptime"] = formatUptime(uptime, sizeof(uptime));
+      doc["ip"] = WiFi.localIP().toString();
+    }
+    doc[key("freeHeap", "hp")] = ESP.getFreeHeap();
+    doc[key("maxFreeBlock", "hb")] = ESP.getMaxFreeBlockSize();
+    doc[key("heapFragmentation", "hf")] = ESP.getHeapFragmentation();
+    doc[key("minMaxFreeBlock", "hm")] = heapMinMaxBlock;
+    doc[key("rssi", "rs")] = WiFi.RSSI();
+    doc[key("ssid", "ss")] = WiFi.SSID();
+
+    // Link state; connectMs is the latest (re)connect, fast = cached BSSID
+    if (compact) {
+      JsonArray wifi = doc.createNestedArray("wi");
+      wifi.add((int)wifiState);
+      wifi.add(wifiLastConnectMs);
+      wifi.add(wifiLastConnectFast);
+      wifi.add(wifiDisconnects);
+    } else {
+      JsonObject wifi = doc.createNestedObject("wifi");
+      wifi["state"] = FPSTR(WIFI_STATE_NAMES[wifiState]);
+      wifi["connectMs"] = wifiLastConnectMs;
+      wifi["fast"] = wifiLastConnectFast;
+      wifi["disconnects"] = wifiDisconnects;
+      if (wifiState != WIFI_UP) wifi["downMs"] = millis() - wifiDownSince;
+    }
+
+    // Boot timeline in ms since reset; phases still pending are left out
+    if (compact) {
+      JsonArray boot = doc.createNestedArray("bt");
+      for (int i = 0; i < BOOT_PHASE_COUNT; i++) boot.add(bootPhaseMs[i]);
+    } else {
+      JsonObject boot = doc.createNestedObject("boot");
+      for (int i = 0; i < BOOT_PHASE_COUNT; i++) {
+        if (bootPhaseMs[i] != 0) boot[FPSTR(BOOT_PHASE_NAMES[i])] = bootPhaseMs[i];
+      }
+    }
+  }
+
+  // Time
+  if (apiGroupVersions[API_TIME] > since && now.valid) {
+    if (compact) {
+      doc["ts"] = (uint32_t)now.epoch;
+    } else {
+      doc["time"] = formatTimeHHMM(now, hhmm, sizeof(hhmm));
+      doc["date"] = formatDate(now, date, sizeof(date));
+      doc["day"] = formatDayOfWeek(now, day, sizeof(day));
+    }
+
+    // Sync age and error are as of this response; both absent until the first sync
+    if (ntpClock.synced) {
+      if (compact) {
+        JsonArray sync = doc.createNestedArray("ny");
+        sync.add(ntpSyncAgeSeconds());
+        sync.add(ntpErrorMs());
+        sync.add(ntpClock.offsetMs);
+        sync.add((int32_t)lroundf(ntpClock.driftPpm * 10));
+        sync.add(ntpClock.pollSeconds);
+      } else {
+        JsonObject sync = doc.createNestedObject("timeSync");
+        sync["ageSeconds"] = ntpSyncAgeSeconds();
+        sync["errorMs"] = ntpErrorMs();
+        sync["offsetMs"] = ntpClock.offsetMs;
+        sync["delayMs"] = ntpClock.delayMs;
+        sync["driftPpm"] = roundf(ntpClock.driftPpm * 10) / 10;
+        sync["pollSeconds"] = ntpClock.pollSeconds;
+        sync["syncs"] = ntpClock.syncs;
+        sync["failures"] = ntpClock.failures;
+      }
+    }
+  }
+
+  // Weather
+  if (apiGroupVersions[API_WEATHER] > since) {
+    bool known = weather.tempDeci != TEMP_UNKNOWN;
+    if (compact) {
+      if (known) doc["t"] = weather.tempDeci;
+      else doc["t"] = nullptr;
+    } else {
+      if (known) doc["temperature"] = fromDeciDegrees(weather.tempDeci);
+      else doc["temperature"] = nullptr;
+      doc["weatherDesc"] = getWeatherDescription(weather.code);
+    }
+    doc[key("weatherCode", "wc")] = weather.code;
+    doc[key("tempUnit", "u")] = String(tempUnit[0]);
+  }
+
+  // Sun & Moon
+  if (apiGroupVersions[API_SUN] > since) {
+    doc[key("sunrise", "sr")] = formatMinuteOfDay(solarDay.sunriseMinute, sunrise, sizeof(sunrise));
+    doc[key("sunset", "st")] = formatMinuteOfDay(solarDay.sunsetMinute, sunset, sizeof(sunset));
+    doc[key("civilDawn", "cd")] = formatMinuteOfDay(solarDay.dawnMinute, dawn, sizeof(dawn));
+    doc[key("solarNoon", "sn")] = formatMinuteOfDay(solarDay.noonMinute, noon, sizeof(noon));
+    doc[key("civilDusk", "ck")] = formatMinuteOfDay(solarDay.duskMinute, dusk, sizeof(dusk));
+    if (!compact) {
+      doc["dayLength"] = formatDayLength(dayLength, sizeof(dayLength));
+    }
+  }
+  if (apiGroupVersions[API_MOON] > since) {
+    if (compact) {
+      doc["mp"] = moon.phase;
+      doc["ma"] = moon.ageDeci;
+    } else {
+      doc["moonPhase"] = getMoonPhaseName(moon.phase);
+      doc["moonAge"] = moon.ageDeci / 10.0f;
+    }
+    doc[key("moonIllumination", "mi")] = moon.illumination;
+    doc[key("nextNewMoon", "nn")] = (uint32_t)moon.nextNewMoon;
+    doc[key("nextFullMoon", "nf")] = (uint32_t)moon.nextFullMoon;
+  }
 
   // Forecast
-  JsonArray forecast = doc.createNestedArray("forecast");
-  for (int i = 0; i < 3; i++) {
-    JsonObject day = forecast.createNestedObject();
-    day["date"] = forecastDays[i];
-    day["maxTemp"] = forecastMaxTemps[i];
-    day["minTemp"] = forecastMinTemps[i];
-    day["code"] = forecastCodes[i];
-    day["desc"] = getWeatherDescription(forecastCodes[i]);
+  if (apiGroupVersions[API_FORECAST] > since) {
+    JsonArray forecast = doc.createNestedArray(key("forecast", "f"));
+    for (int i = 0; i < FORECAST_DAYS; i++) {
+      const ForecastDay& fc = weather.forecast[i];
+      JsonObject day = forecast.createNestedObject();
+      day[key("date", "d")] = formatPackedDate(fc.date, forecastDates[i], sizeof(forecastDates[i]));
+      // Unknown temperatures go out as null, never as a plausible 0
+      if (compact) {
+        if (fc.maxDeci != TEMP_UNKNOWN) day["hi"] = fc.maxDeci;
+        else day["hi"] = nullptr;
+        if (fc.minDeci != TEMP_UNKNOWN) day["lo"] = fc.minDeci;
+        else day["lo"] = nullptr;
+      } else {
+        if (fc.maxDeci != TEMP_UNKNOWN) day["maxTemp"] = fromDeciDegrees(fc.maxDeci);
+        else day["maxTemp"] = nullptr;
+        if (fc.minDeci != TEMP_UNKNOWN) day["minTemp"] = fromDeciDegrees(fc.minDeci);
+        else day["minTemp"] = nullptr;
+        day["desc"] = getWeatherDescription(fc.code);
+      }
+      day[key("code", "c")] = fc.code;
+    }
+  }
+
+  // Heap history, oldest first: [free, largest block, fragmentation %]
+  if (apiGroupVersions[API_HEAP] > since) {
+    JsonArray history = doc.createNestedArray(key("heapHistory", "hh"));
+    for (uint8_t i = 0; i < heapHistoryCount; i++) {
+      const HeapSample& sample = heapHistoryAt(i);
+      JsonArray row = history.createNestedArray();
+      row.add(sample.freeHeap);
+      row.add(sample.maxBlock);
+      row.add(sample.fragmentation);
+    }
   }
 
   // Config
-  doc["location"] = String(displayName);
-  doc["viewDuration"] = viewDuration / 1000;
+  if (apiGroupVersions[API_CONFIG] > since) {
+    doc[key("location", "l")] = String(displayName);
+    doc[key("viewDuration", "vd")] = viewDuration / 1000;
+    JsonArray views = doc.createNestedArray(key("views", "vw"));
+    for (int i = 0; i < VIEW_COUNT; i++) {
+      JsonObject view = views.createNestedObject();
+      view[key("name", "n")] = FPSTR(VIEW_NAMES[i]);
+      view[key("enabled", "e")] = isViewEnabled(i);
+      view[key("seconds", "s")] = viewDurationMs(static_cast<View>(i)) / 1000;
+      if (compact) {
+        view["r"] = (int)VIEWS[i].refresh;
+      } else {
+        view["title"] = FPSTR(VIEW_TITLES[i]);
+        view["refresh"] = FPSTR(REFRESH_POLICY_NAMES[VIEWS[i].refresh]);
+      }
+    }
+  }
 
-  String response;
-  serializeJson(doc, response);
-  server.send(200, "application/json", response);
+  ApiFormat format = compact ? API_FORMAT_MSGPACK : API_FORMAT_JSON;
+  if (compact) {
+    // Serialized into a plain buffer: MessagePack contains NUL bytes
+    size_t length = measureMsgPack(doc);
+    std::unique_ptr<char[]> buffer(new char[length]);
+    serializeMsgPack(doc, buffer.get(), length);
+    recordApiEncode(format, micros() - start, length);
+    server.setContentLength(length);
+    server.send(200, "application/msgpack", "");
+    server.sendContent(buffer.get(), length);
+  } else {
+    String response;
+    serializeJson(doc, response);
+    recordApiEncode(format, micros() - start, response.length());
+    server.send(200, "application/json", response);
+  }
 }
 
 void handleRoot() {
-  server.send(200, "text/html", getWebInterface());
+  TRACE_SPAN(TRACE_HANDLE_ROOT);
+  server.send_P(200, "text/html", getWebInterface());
 }
 
+const char SETTINGS_HEAD[] PROGMEM =
+  "<!DOCTYPE html><html><head><meta charset='UTF-8'><meta name='viewport' content='width=device-width,initial-scale=1'>"
+  "<title>Settings - MicroDashboard</title>"
+  "<style>*{margin:0;padding:0;box-sizing:border-box}body{font-family:-apple-system,BlinkMacSystemFont,'Segoe UI',Roboto,sans-serif;background:linear-gradient(135deg,#667eea 0%,#764ba2 100%);min-height:100vh;padding:20px}.container{max-width:600px;margin:0 auto;background:white;border-radius:20px;padding:30px;box-shadow:0 20px 60px rgba(0,0,0,0.3)}h1{color:#333;margin-bottom:30px;font-size:2em}form{display:flex;flex-direction:column;gap:20px}.form-group{display:flex;flex-direction:column;gap:8px}label{color:#555;font-weight:600;font-size:0.9em}input,select{padding:12px;border:2px solid #e0e0e0;border-radius:8px;font-size:1em;transition:border-color 0.3s}input:focus,select:focus{outline:none;border-color:#667eea}button{background:linear-gradient(135deg,#667eea 0%,#764ba2 100%);color:white;padding:15px;border:none;border-radius:8px;font-size:1.1em;font-weight:600;cursor:pointer;transition:transform 0.2s}button:hover{transform:translateY(-2px)}button:active{transform:translateY(0)}.back-link{display:inline-block;margin-top:20px;color:#667eea;text-decoration:none;font-weight:600}.view-row{display:flex;align-items:center;gap:10px}.view-row label{flex:1;font-weight:normal}.view-row small{color:#999}.view-row input[type=number]{width:80px}}</style></head><body>"
+  "<div class='container'><h1>⚙️ Settings</h1>"
+  "<form method='POST' action='/settings/save'>";
+
 void handleSettings() {
-  String html = "<!DOCTYPE html><html><head><meta charset='UTF-8'><meta name='viewport' content='width=device-width,initial-scale=1'>";
-  html += "<title>Settings - MicroDashboard</title>";
-  html += "<style>*{margin:0;padding:0;box-sizing:border-box}body{font-family:-apple-system,BlinkMacSystemFont,'Segoe UI',Roboto,sans-serif;background:linear-gradient(135deg,#667eea 0%,#764ba2 100%);min-height:100vh;padding:20px}.container{max-width:600px;margin:0 auto;background:white;border-radius:20px;padding:30px;box-shadow:0 20px 60px rgba(0,0,0,0.3)}h1{color:#333;margin-bottom:30px;font-size:2em}form{display:flex;flex-direction:column;gap:20px}.form-group{display:flex;flex-direction:column;gap:8px}label{color:#555;font-weight:600;font-size:0.9em}input,select{padding:12px;border:2px solid #e0e0e0;border-radius:8px;font-size:1em;transition:border-color 0.3s}input:focus,select:focus{outline:none;border-color:#667eea}button{background:linear-gradient(135deg,#667eea 0%,#764ba2 100%);color:white;padding:15px;border:none;border-radius:8px;font-size:1.1em;font-weight:600;cursor:pointer;transition:transform 0.2s}button:hover{transform:translateY(-2px)}button:active{transform:translateY(0)}.back-link{display:inline-block;margin-top:20px;color:#667eea;text-decoration:none;font-weight:600}}</style></head><body>";
-  html += "<div class='container'><h1>⚙️ Settings</h1>";
-  html += "<form method='POST' action='/settings/save'>";
-  html += "<div class='form-group'><label>City/Location:</label><input type='text' name='city' value='" + String(cityName) + "' required></div>";
-  html += "<div class='form-group'><label>Display Name:</label><input type='text' name='displayName' value='" + String(displayName) + "'></div>";
-  html += "<div class='form-group'><label>Temperature Unit:</label><select name='tempUnit'>";
-  html += "<option value='C'" + String(tempUnit[0] == 'C' ? " selected" : "") + ">Celsius</option>";
-  html += "<option value='F'" + String(tempUnit[0] == 'F' ? " selected" : "") + ">Fahrenheit</option>";
-  html += "<option value='B'" + String(tempUnit[0] == 'B' ? " selected" : "") + ">Both</option>";
-  html += "</select></div>";
-  html += "<div class='form-group'><label>View Duration (seconds):</label><input type='number' name='duration' value='" + String(viewDuration / 1000) + "' min='1' max='60'></div>";
-  html += "<button type='submit'>💾 Save Settings</button>";
-  html += "</form><a href='/' class='back-link'>← Back to Dashboard</a></div></body></html>";
+  String html;
+  html.reserve(sizeof(SETTINGS_HEAD) + 2048);
+  html += FPSTR(SETTINGS_HEAD);
+  html += F("<div class='form-group'><label>City/Location:</label><input type='text' name='city' value='");
+  html += cityName;
+  html += F("' required></div>");
+  html += F("<div class='form-group'><label>Display Name:</label><input type='text' name='displayName' value='");
+  html += displayName;
+  html += F("'></div>");
+  html += F("<div class='form-group'><label>Temperature Unit:</label><select name='tempUnit'>");
+  html += F("<option value='C'");
+  if (tempUnit[0] == 'C') html += F(" selected");
+  html += F(">Celsius</option><option value='F'");
+  if (tempUnit[0] == 'F') html += F(" selected");
+  html += F(">Fahrenheit</option><option value='B'");
+  if (tempUnit[0] == 'B') html += F(" selected");
+  html += F(">Both</option>");
+  html += F("</select></div>");
+  html += F("<div class='form-group'><label>View Duration (seconds):</label><input type='number' name='duration' value='");
+  html += viewDuration / 1000;
+  html += F("' min='1' max='60'></div>");
+  html += F("<div class='form-group'><label>Views (seconds, 0 = default duration):</label><input type='hidden' name='views' value='1'>");
+  for (int i = 0; i < VIEW_COUNT; i++) {
+    char row[96];
+    snprintf_P(row, sizeof(row), PSTR("<div class='view-row'><label><input type='checkbox' name='v%d'%s> "),
+               i, isViewEnabled(i) ? " checked" : "");
+    html += row;
+    html += FPSTR(VIEW_TITLES[i]);
+    html += F("</label><small>");
+    html += FPSTR(REFRESH_POLICY_NAMES[VIEWS[i].refresh]);
+    snprintf_P(row, sizeof(row), PSTR("</small><input type='number' name='s%d' value='%u' min='0' max='255'></div>"),
+               i, viewSeconds[i]);
+    html += row;
+  }
+  html += F("</div>");
+  html += F("<button type='submit'>💾 Save Settings</button>");
+  html += F("</form><a href='/' class='back-link'>← Back to Dashboard</a></div></body></html>");
   server.send(200, "text/html", html);
 }
 
+const char SETTINGS_SAVED_HEAD[] PROGMEM =
+  "<!DOCTYPE html><html><head><meta charset='UTF-8'><meta name='viewport' content='width=device-width,initial-scale=1'><meta http-equiv='refresh' content='30;url=/'>"
+  "<style>*{margin:0;padding:0}body{font-family:sans-serif;display:flex;align-items:center;justify-content:center;min-height:100vh;background:linear-gradient(135deg,#667eea 0%,#764ba2 100%);color:white}.message{text-align:center;font-size:1.5em}}</style></head>"
+  "<body><div class='message'>✅ Settings saved!<br><small id='status'>Updating weather...</small></div>"
+  "<script>function poll(){fetch('";
+const char SETTINGS_SAVED_POLL[] PROGMEM =
+  "').then(r=>r.json()).then(j=>{"
+  "if(j.state==='done'||j.state==='failed'){document.getElementById('status').textContent=j.state==='done'?'Redirecting...':'⚠️ '+j.error;setTimeout(()=>location.href='/',2000);}"
+  "else setTimeout(poll,1000);}).catch(()=>setTimeout(poll,1000));}poll();</script></body></html>";
+
 void handleSettingsSave() {
+  bool cityChanged = false;
   if (server.hasArg("city")) {
-    strcpy(cityName, server.arg("city").c_str());
+    String city = server.arg("city");
+    cityChanged = strcmp(city.c_str(), cityName) != 0;
+    strlcpy(cityName, city.c_str(), sizeof(cityName));
   }
   if (server.hasArg("displayName")) {
-    strcpy(displayName, server.arg("displayName").c_str());
+    strlcpy(displayName, server.arg("displayName").c_str(), sizeof(displayName));
   }
   if (server.hasArg("tempUnit")) {
-    strcpy(tempUnit, server.arg("tempUnit").c_str());
+    strlcpy(tempUnit, server.arg("tempUnit").c_str(), sizeof(tempUnit));
   }
   if (server.hasArg("duration")) {
     viewDuration = server.arg("duration").toInt() * 1000;
   }
+  if (server.hasArg("views")) {
+    uint8_t mask = 0;
+    char name[4];
+    for (int i = 0; i < VIEW_COUNT; i++) {
+      snprintf(name, sizeof(name), "v%d", i);
+      if (server.hasArg(name)) mask |= 1 << i;
+      snprintf(name, sizeof(name), "s%d", i);
+      viewSeconds[i] = constrain(server.arg(name).toInt(), 0L, 255L);
+    }
+    viewEnabledMask = mask ? mask : 1 << CLOCK_VIEW;  // never an empty rotation
+  }
+  requestViewRedraw();
 
-  saveConfig();
-  fetchGeocodingData(String(cityName));
-  updateWeatherUrl();
-  fetchWeatherData();
+  // Saving, geocoding and refetching run in the background (see runJobs)
+  int jobId = queueSettingsJob(cityChanged && !manualCoordinates);
+  if (jobId < 0) {
+    server.send(503, "text/plain", "Job queue full");
+    return;
+  }
+  String jobUrl = "/api/jobs/" + String(jobId);
+  server.sendHeader("Location", jobUrl);
+
+  String html;
+  html.reserve(sizeof(SETTINGS_SAVED_HEAD) + sizeof(SETTINGS_SAVED_POLL) + 32);
+  html += FPSTR(SETTINGS_SAVED_HEAD);
+  html += jobUrl;
+  html += FPSTR(SETTINGS_SAVED_POLL);
+  server.send(202, "text/html", html);
+}
 
-  String html = "<!DOCTYPE html><html><head><meta charset='UTF-8'><meta name='viewport' content='width=device-width,initial-scale=1'><meta http-equiv='refresh' content='2;url=/'>";
-  html += "<style>*{margin:0;padding:0}body{font-family:sans-serif;display:flex;align-items:center;justify-content:center;min-height:100vh;background:linear-gradient(135deg,#667eea 0%,#764ba2 100%);color:white}.message{text-align:center;font-size:1.5em}}</style></head>";
-  html += "<body><div class='message'>✅ Settings saved!<br><small>Redirecting...</small></div></body></html>";
-  server.send(200, "text/html", html);
+void handleJobStatus() {
+  String uri = server.uri();
+  long id = uri.substring(strlen("/api/jobs/")).toInt();
+  const Job* job = findJob(id);
+  if (!job) {
+    server.send(404, "application/json", "{\"error\":\"Unknown job\"}");
+    return;
+  }
+
+  DynamicJsonDocument doc(256);
+  doc["id"] = job->id;
+  doc["state"] = FPSTR(jobStateName(job->state));
+  if (job->state == JOB_RUNNING) {
+    doc["step"] = FPSTR(jobStepName(job->step));
+  }
+  if (job->error != nullptr) {
+    doc["error"] = FPSTR(job->error);
+  }
+  bool finished = job->state == JOB_DONE || job->state == JOB_FAILED;
+  doc["elapsedMs"] = (finished ? job->finishedAt : millis()) - job->queuedAt;
+
+  String response;
+  serializeJson(doc, response);
+  server.send(200, "application/json", response);
+}
+
+// --- METRICS EXPOSITION ---
+// Prometheus text format, generated one metric family per call so only a
+// single family is ever buffered (see DashboardServer::sendStream). Names,
+// help text and formats all stay in flash.
+const char METRIC_COUNTER[] PROGMEM = "counter";
+const char METRIC_GAUGE[] PROGMEM = "gauge";
+const char METRIC_HISTOGRAM[] PROGMEM = "histogram";
+const char METRIC_SUMMARY[] PROGMEM = "summary";
+
+void appendMetricV(String& out, PGM_P name, PGM_P format, va_list args) {
+  char line[128];
+  vsnprintf_P(line, sizeof(line), format, args);
+  out += FPSTR(name);
+  out += line;
+}
+
+// One sample: the name, then format (labels, value, newline) filled in
+void appendMetric(String& out, PGM_P name, PGM_P format, ...) {
+  va_list args;
+  va_start(args, format);
+  appendMetricV(out, name, format, args);
+  va_end(args);
+}
+
+void appendFamily(String& out, PGM_P name, PGM_P type, PGM_P help) {
+  out += F("# HELP ");
+  out += FPSTR(name);
+  out += ' ';
+  out += FPSTR(help);
+  out += F("\n# TYPE ");
+  out += FPSTR(name);
+  out += ' ';
+  out += FPSTR(type);
+  out += '\n';
+}
+
+// A family with a single unlabelled sample
+void appendScalar(String& out, PGM_P name, PGM_P type, PGM_P help, PGM_P format, ...) {
+  appendFamily(out, name, type, help);
+  va_list args;
+  va_start(args, format);
+  appendMetricV(out, name, format, args);
+  va_end(args);
+}
+
+void appendHistogram(String& out, PGM_P name, const char* labels, const Histogram& h) {
+  uint32_t cumulative = 0;
+  const char* sep = labels[0] ? "," : "";
+  for (uint8_t i = 0; i < h.bucketCount; i++) {
+    cumulative += h.buckets[i];
+    appendMetric(out, name, PSTR("_bucket{%s%sle=\"%g\"} %u\n"), labels, sep,
+                 h.boundsUs[i] / 1e6, (unsigned)cumulative);
+  }
+  appendMetric(out, name, PSTR("_bucket{%s%sle=\"+Inf\"} %u\n"), labels, sep, (unsigned)h.count);
+  char braced[40] = "";
+  if (labels[0]) {
+    snprintf_P(braced, sizeof(braced), PSTR("{%s}"), labels);
+  }
+  appendMetric(out, name, PSTR("_sum%s %.6f\n"), braced, h.sumUs / 1e6);
+  appendMetric(out, name, PSTR("_count%s %u\n"), braced, (unsigned)h.count);
+}
+
+void appendStatusCounter(String& out, PGM_P name, const char* labels, const StatusCounter& c) {
+  const char* sep = labels[0] ? "," : "";
+  for (uint8_t i = 0; i < c.used; i++) {
+    appendMetric(out, name, PSTR("{%s%scode=\"%d\"} %u\n"), labels, sep, c.codes[i], (unsigned)c.counts[i]);
+  }
+}
+
+bool generateMetrics(String& out, uint32_t& cursor) {
+  char labels[32];
+  char label[12];  // a name copied out of flash
+  PGM_P name;
+  switch (cursor++) {
+    case 0:
+      appendScalar(out, PSTR("dashboard_uptime_seconds"), METRIC_COUNTER, PSTR("Seconds since boot"),
+                   PSTR(" %lu\n"), (millis() - bootTime) / 1000);
+      appendScalar(out, PSTR("dashboard_heap_free_bytes"), METRIC_GAUGE, PSTR("Free heap"),
+                   PSTR(" %u\n"), (unsigned)ESP.getFreeHeap());
+      appendScalar(out, PSTR("dashboard_heap_max_free_block_bytes"), METRIC_GAUGE, PSTR("Largest free heap block"),
+                   PSTR(" %u\n"), (unsigned)ESP.getMaxFreeBlockSize());
+      appendScalar(out, PSTR("dashboard_heap_fragmentation_percent"), METRIC_GAUGE, PSTR("Heap fragmentation"),
+                   PSTR(" %u\n"), (unsigned)ESP.getHeapFragmentation());
+      appendScalar(out, PSTR("dashboard_heap_max_free_block_min_bytes"), METRIC_GAUGE,
+                   PSTR("Smallest largest-free-block seen since boot"), PSTR(" %u\n"), (unsigned)heapMinMaxBlock);
+      appendScalar(out, PSTR("dashboard_wifi_rssi_dbm"), METRIC_GAUGE, PSTR("WiFi signal strength"),
+                   PSTR(" %d\n"), (int)WiFi.RSSI());
+      appendScalar(out, PSTR("dashboard_wifi_up"), METRIC_GAUGE, PSTR("1 while the WiFi link is up"),
+                   PSTR(" %d\n"), wifiState == WIFI_UP ? 1 : 0);
+      appendScalar(out, PSTR("dashboard_wifi_disconnects_total"), METRIC_COUNTER, PSTR("WiFi links lost since boot"),
+                   PSTR(" %u\n"), (unsigned)wifiDisconnects);
+      return true;
+    case 1:
+      name = PSTR("dashboard_loop_period_seconds");
+      appendFamily(out, name, METRIC_HISTOGRAM, PSTR("Time between loop() iterations"));
+      appendHistogram(out, name, "", loopPeriod);
+      return true;
+    case 2:
+      name = PSTR("dashboard_fetch_duration_seconds");
+      appendFamily(out, name, METRIC_HISTOGRAM, PSTR("Upstream request latency"));
+      for (int i = 0; i < FETCH_TARGET_COUNT; i++) {
+        strlcpy_P(label, FETCH_TARGET_NAMES[i], sizeof(label));
+        snprintf_P(labels, sizeof(labels), PSTR("target=\"%s\""), label);
+        appendHistogram(out, name, labels, fetchLatency[i]);
+      }
+      return true;
+    case 3:
+      name = PSTR("dashboard_fetch_responses_total");
+      appendFamily(out, name, METRIC_COUNTER, PSTR("Upstream responses by HTTP status (negative: client error)"));
+      for (int i = 0; i < FETCH_TARGET_COUNT; i++) {
+        strlcpy_P(label, FETCH_TARGET_NAMES[i], sizeof(label));
+        snprintf_P(labels, sizeof(labels), PSTR("target=\"%s\""), label);
+        appendStatusCounter(out, name, labels, fetchStatus[i]);
+      }
+      name = PSTR("dashboard_parse_failures_total");
+      appendFamily(out, name, METRIC_COUNTER, PSTR("Upstream responses that failed to parse"));
+      for (int i = 0; i < FETCH_TARGET_COUNT; i++) {
+        strlcpy_P(label, FETCH_TARGET_NAMES[i], sizeof(label));
+        appendMetric(out, name, PSTR("{target=\"%s\"} %u\n"), label, (unsigned)parseFailures[i]);
+      }
+      return true;
+    case 4:
+      name = PSTR("dashboard_render_seconds");
+      appendFamily(out, name, METRIC_SUMMARY, PSTR("Time to render a view into the frame buffer"));
+      for (int i = 0; i < VIEW_COUNT; i++) {
+        strlcpy_P(label, VIEW_NAMES[i], sizeof(label));
+        appendMetric(out, name, PSTR("_sum{view=\"%s\"} %.6f\n"), label, renderTime[i].sumUs / 1e6);
+        appendMetric(out, name, PSTR("_count{view=\"%s\"} %u\n"), label, (unsigned)renderTime[i].count);
+      }
+      name = PSTR("dashboard_render_max_seconds");
+      appendFamily(out, name, METRIC_GAUGE, PSTR("Slowest render per view"));
+      for (int i = 0; i < VIEW_COUNT; i++) {
+        strlcpy_P(label, VIEW_NAMES[i], sizeof(label));
+        appendMetric(out, name, PSTR("{view=\"%s\"} %.6f\n"), label, renderTime[i].maxUs / 1e6);
+      }
+      return true;
+    case 5:
+      name = PSTR("dashboard_display_flush_seconds");
+      appendFamily(out, name, METRIC_SUMMARY, PSTR("Time to push the frame buffer over I2C"));
+      appendMetric(out, name, PSTR("_sum %.6f\n"), displayFlushTime.sumUs / 1e6);
+      appendMetric(out, name, PSTR("_count %u\n"), (unsigned)displayFlushTime.count);
+      appendScalar(out, PSTR("dashboard_display_flush_max_seconds"), METRIC_GAUGE, PSTR("Slowest I2C flush"),
+                   PSTR(" %.6f\n"), displayFlushTime.maxUs / 1e6);
+      appendScalar(out, PSTR("dashboard_solar_compute_cycles"), METRIC_GAUGE,
+                   PSTR("CPU cycles of the latest sun times computation"), PSTR(" %u\n"), (unsigned)solarComputeCycles);
+      return true;
+    case 6:
+      name = PSTR("dashboard_http_responses_total");
+      appendFamily(out, name, METRIC_COUNTER, PSTR("Responses served by status code"));
+      appendStatusCounter(out, name, "", httpResponses);
+      return true;
+    case 7:
+      name = PSTR("dashboard_api_encode_seconds");
+      appendFamily(out, name, METRIC_SUMMARY, PSTR("Time to build and serialize /api"));
+      for (int i = 0; i < API_FORMAT_COUNT; i++) {
+        strlcpy_P(label, API_FORMAT_NAMES[i], sizeof(label));
+        appendMetric(out, name, PSTR("_sum{format=\"%s\"} %.6f\n"), label, apiEncodeTime[i].sumUs / 1e6);
+        appendMetric(out, name, PSTR("_count{format=\"%s\"} %u\n"), label, (unsigned)apiEncodeTime[i].count);
+      }
+      name = PSTR("dashboard_api_payload_bytes");
+      appendFamily(out, name, METRIC_GAUGE, PSTR("Size of the last /api response"));
+      for (int i = 0; i < API_FORMAT_COUNT; i++) {
+        strlcpy_P(label, API_FORMAT_NAMES[i], sizeof(label));
+        appendMetric(out, name, PSTR("{format=\"%s\"} %u\n"), label, (unsigned)apiPayloadBytes[i]);
+      }
+      return true;
+    case 8:
+      name = PSTR("dashboard_wifi_connect_seconds");
+      appendFamily(out, name, METRIC_HISTOGRAM, PSTR("Time to (re)connect WiFi"));
+      appendHistogram(out, name, "", wifiConnectTime);
+      return true;
+    case 9:
+      if (!ntpClock.synced) return true;
+      appendScalar(out, PSTR("dashboard_ntp_sync_age_seconds"), METRIC_GAUGE, PSTR("Seconds since the last NTP sync"),
+                   PSTR(" %u\n"), (unsigned)ntpSyncAgeSeconds());
+      appendScalar(out, PSTR("dashboard_ntp_error_seconds"), METRIC_GAUGE, PSTR("Estimated clock error"),
+                   PSTR(" %.3f\n"), ntpErrorMs() / 1e3);
+      appendScalar(out, PSTR("dashboard_ntp_offset_seconds"), METRIC_GAUGE, PSTR("Correction applied at the last sync"),
+                   PSTR(" %.3f\n"), ntpClock.offsetMs / 1e3);
+      appendScalar(out, PSTR("dashboard_ntp_drift_ppm"), METRIC_GAUGE, PSTR("Estimated oscillator drift"),
+                   PSTR(" %.2f\n"), ntpClock.driftPpm);
+      appendScalar(out, PSTR("dashboard_ntp_failures_total"), METRIC_COUNTER, PSTR("NTP requests without a usable reply"),
+                   PSTR(" %u\n"), (unsigned)ntpClock.failures);
+      return true;
+    case 10:
+      name = PSTR("dashboard_task_run_seconds");
+      appendFamily(out, name, METRIC_SUMMARY, PSTR("Time each scheduler task ran"));
+      for (int i = 0; i < TASK_COUNT; i++) {
+        strlcpy_P(label, TASK_NAMES[i], sizeof(label));
+        appendMetric(out, name, PSTR("_sum{task=\"%s\"} %.6f\n"), label, taskState[i].runTime.sumUs / 1e6);
+        appendMetric(out, name, PSTR("_count{task=\"%s\"} %u\n"), label, (unsigned)taskState[i].runTime.count);
+      }
+      return true;
+    case 11:
+      name = PSTR("dashboard_task_run_max_seconds");
+      appendFamily(out, name, METRIC_GAUGE, PSTR("Longest run per task"));
+      for (int i = 0; i < TASK_COUNT; i++) {
+        strlcpy_P(label, TASK_NAMES[i], sizeof(label));
+        appendMetric(out, name, PSTR("{task=\"%s\"} %.6f\n"), label, taskState[i].runTime.maxUs / 1e6);
+      }
+      name = PSTR("dashboard_task_budget_overruns_total");
+      appendFamily(out, name, METRIC_COUNTER, PSTR("Runs longer than the task's time budget"));
+      for (int i = 0; i < TASK_COUNT; i++) {
+        strlcpy_P(label, TASK_NAMES[i], sizeof(label));
+        appendMetric(out, name, PSTR("{task=\"%s\"} %u\n"), label, (unsigned)taskState[i].overruns);
+      }
+      return true;
+    case 12:
+      name = PSTR("dashboard_task_deadline_misses_total");
+      appendFamily(out, name, METRIC_COUNTER, PSTR("Runs that started later than the task's deadline"));
+      for (int i = 0; i < TASK_COUNT; i++) {
+        strlcpy_P(label, TASK_NAMES[i], sizeof(label));
+        appendMetric(out, name, PSTR("{task=\"%s\"} %u\n"), label, (unsigned)taskState[i].deadlineMisses);
+      }
+      return true;
+    default: {
+      // One task's lateness histogram per call
+      uint32_t task = cursor - 14;
+      if (task >= TASK_COUNT) return false;
+      name = PSTR("dashboard_task_lateness_seconds");
+      if (task == 0) {
+        appendFamily(out, name, METRIC_HISTOGRAM, PSTR("Delay between a task falling due and starting"));
+      }
+      strlcpy_P(label, TASK_NAMES[task], sizeof(label));
+      snprintf_P(labels, sizeof(labels), PSTR("task=\"%s\""), label);
+      appendHistogram(out, name, labels, taskState[task].lateness);
+      return true;
+    }
+  }
+}
+
+void handleMetrics() {
+  server.sendStream(200, "text/plain; version=0.0.4", generateMetrics);
 }
 
-String getWebInterface() {
-  return R"rawliteral(
+// --- LOG EXPORT ---
+const char LOG_LEVEL_NAMES[][6] PROGMEM = {"none", "error", "warn", "info", "debug"};
+
+// Recent entries as text, oldest first, one per line:
+// <seq> <seconds since boot> <level letter> <message>. ?since=<seq> returns
+// only later entries; ?level=<name> only that level and more severe ones.
+void handleLog() {
+  uint32_t seq = logCount > LOG_ENTRIES ? logCount - LOG_ENTRIES : 0;
+  if (server.hasArg("since")) {
+    seq = max<uint32_t>(seq, server.arg("since").toInt() + 1);
+  }
+  uint8_t maxLevel = LOG_LEVEL_DEBUG;
+  if (server.hasArg("level")) {
+    String level = server.arg("level");
+    for (uint8_t i = LOG_LEVEL_ERROR; i <= LOG_LEVEL_DEBUG; i++) {
+      if (strcmp_P(level.c_str(), LOG_LEVEL_NAMES[i]) == 0) maxLevel = i;
+    }
+  }
+
+  String out;
+  out.reserve((logCount - min(seq, logCount)) * 48);
+  for (; seq < logCount; seq++) {
+    const LogEntry& entry = logEntries[seq % LOG_ENTRIES];
+    if (entry.level > maxLevel) continue;
+    char line[LOG_TEXT_LENGTH + 32];
+    snprintf_P(line, sizeof(line), PSTR("%u %u.%03u %c %s\n"), (unsigned)seq, (unsigned)(entry.ms / 1000),
+               (unsigned)(entry.ms % 1000), LOG_LEVEL_LETTERS[entry.level], entry.text);
+    out += line;
+  }
+  server.sendHeader("Cache-Control", "no-cache");
+  server.send(200, "text/plain", out);
+}
+
+// --- TRACE EXPORT ---
+#if TRACE_ENABLED
+const uint32_t TRACE_EVENTS_PER_CHUNK = 16;
+const uint32_t TRACE_CURSOR_DONE = UINT32_MAX;
+
+// The cursor is 1 + the sequence number of the next event, read from the
+// live ring: events overwritten while the response drains are skipped and
+// the dump ends once it catches up with the newest event.
+bool generateTrace(String& out, uint32_t& cursor) {
+  if (cursor == TRACE_CURSOR_DONE) return false;
+  if (cursor == 0) {
+    out += F("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"");
+    out += displayName;
+    out += F("\"}}");
+    cursor = 1 + (traceCount > TRACE_EVENTS ? traceCount - TRACE_EVENTS : 0);
+    return true;
+  }
+
+  uint32_t seq = cursor - 1;
+  if (traceCount - seq > TRACE_EVENTS) seq = traceCount - TRACE_EVENTS;
+  double cyclesPerUs = ESP.getCpuFreqMHz();
+  for (uint32_t n = 0; n < TRACE_EVENTS_PER_CHUNK && seq != traceCount; n++, seq++) {
+    const TraceEvent& event = traceEvents[seq & (TRACE_EVENTS - 1)];
+    char name[sizeof(TRACE_NAMES[0])];
+    strlcpy_P(name, TRACE_NAMES[event.name], sizeof(name));
+    char line[96];
+    snprintf_P(line, sizeof(line), PSTR(",{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.1f,\"pid\":0,\"tid\":0}"),
+               name, event.phase,
+               ((double)event.wraps * 4294967296.0 + event.cycles) / cyclesPerUs);
+    out += line;
+  }
+  if (seq == traceCount) {
+    out += F("]}");
+    cursor = TRACE_CURSOR_DONE;
+  } else {
+    cursor = seq + 1;
+  }
+  return true;
+}
+
+void handleTrace() {
+  server.sendStream(200, "application/json", generateTrace);
+}
+#else
+void handleTrace() {
+  server.send(404, "text/plain", "Tracing disabled (TRACE_ENABLED=0)");
+}
+#endif
+
+// --- SCREEN SNAPSHOTS ---
+// Snapshots are encoded straight from the SSD1306 frame buffer, eight
+// scanlines at a time, and each piece is written through to the socket.
+// Only what the TCP window cannot take yet waits in the connection's buffer.
+const int SNAPSHOT_ROW_BYTES = SCREEN_WIDTH / 8;
+const int SNAPSHOT_ROWS_PER_CHUNK = 8;
+bool snapshotRendered = false;
+
+// Packs one scanline MSB-first. The SSD1306 buffer is page-major: each byte
+// holds 8 vertical pixels of one column.
+void packScanline(const uint8_t* fb, int y, uint8_t* out, bool lit) {
+  const uint8_t* page = fb + (y / 8) * SCREEN_WIDTH;
+  uint8_t mask = 1 << (y & 7);
+  for (int b = 0; b < SNAPSHOT_ROW_BYTES; b++) {
+    uint8_t bits = 0;
+    for (int i = 0; i < 8; i++) {
+      bits <<= 1;
+      if (((page[b * 8 + i] & mask) != 0) == lit) {
+        bits |= 1;
+      }
+    }
+    out[b] = bits;
+  }
+}
+
+// Optional ?view=<n> renders that view into the frame buffer (not pushed to
+// the panel) so every view can be fetched without waiting for the rotation.
+bool beginSnapshot() {
+  snapshotRendered = false;
+  if (server.hasArg("view")) {
+    int view = server.arg("view").toInt();
+    if (view < 0 || view >= VIEW_COUNT) {
+      server.send(400, "text/plain", "Invalid view");
+      return false;
+    }
+    renderView(static_cast<View>(view));
+    snapshotRendered = true;
+  }
+  server.sendHeader("Cache-Control", "no-cache");
+  return true;
+}
+
+void endSnapshot() {
+  if (snapshotRendered) {
+    renderView(currentView);
+  }
+}
+
+void handleScreenPBM() {
+  if (!beginSnapshot()) return;
+
+  const uint8_t* fb = display.getBuffer();
+  char header[16];
+  int headerLen = snprintf(header, sizeof(header), "P4\n%d %d\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+
+  server.setContentLength(headerLen + SNAPSHOT_ROW_BYTES * SCREEN_HEIGHT);
+  server.send(200, "image/x-portable-bitmap", "");
+  server.sendContent(header, headerLen);
+
+  // PBM uses 1 for black, so unlit pixels are the set bits
+  uint8_t chunk[SNAPSHOT_ROW_BYTES * SNAPSHOT_ROWS_PER_CHUNK];
+  for (int y = 0; y < SCREEN_HEIGHT; y += SNAPSHOT_ROWS_PER_CHUNK) {
+    for (int r = 0; r < SNAPSHOT_ROWS_PER_CHUNK; r++) {
+      packScanline(fb, y + r, chunk + r * SNAPSHOT_ROW_BYTES, false);
+    }
+    server.sendContent((const char*)chunk, sizeof(chunk));
+  }
+
+  endSnapshot();
+}
+
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t len) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *data++;
+    for (int k = 0; k < 8; k++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+void putBE32(uint8_t* p, uint32_t v) {
+  p[0] = v >> 24;
+  p[1] = v >> 16;
+  p[2] = v >> 8;
+  p[3] = v;
+}
+
+// 1-bit grayscale PNG whose IDAT is a single stored (uncompressed) deflate
+// block. Sizes are fixed, so CRC and Adler-32 are computed while streaming.
+void handleScreenPNG() {
+  if (!beginSnapshot()) return;
+
+  const uint8_t* fb = display.getBuffer();
+  const int rowLen = SNAPSHOT_ROW_BYTES + 1;  // filter byte + pixels
+  const uint16_t rawLen = rowLen * SCREEN_HEIGHT;
+  const uint32_t idatLen = 2 + 5 + rawLen + 4;  // zlib hdr, block hdr, data, adler
+
+  server.setContentLength(8 + 25 + (12 + idatLen) + 12);
+  server.send(200, "image/png", "");
+
+  uint8_t head[8 + 25 + 8 + 7];
+  static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  memcpy(head, signature, 8);
+
+  uint8_t* ihdr = head + 8;
+  putBE32(ihdr, 13);
+  memcpy(ihdr + 4, "IHDR", 4);
+  putBE32(ihdr + 8, SCREEN_WIDTH);
+  putBE32(ihdr + 12, SCREEN_HEIGHT);
+  ihdr[16] = 1;  // bit depth
+  ihdr[17] = 0;  // grayscale
+  ihdr[18] = 0;  // deflate
+  ihdr[19] = 0;  // adaptive filtering
+  ihdr[20] = 0;  // no interlace
+  putBE32(ihdr + 21, crc32Update(0, ihdr + 4, 17));
+
+  uint8_t* idat = ihdr + 25;
+  putBE32(idat, idatLen);
+  memcpy(idat + 4, "IDAT", 4);
+  idat[8] = 0x78;  // zlib: deflate, 32K window
+  idat[9] = 0x01;  // no dict, check bits
+  idat[10] = 0x01;  // final stored block
+  idat[11] = rawLen & 0xFF;
+  idat[12] = rawLen >> 8;
+  idat[13] = ~rawLen & 0xFF;
+  idat[14] = (~rawLen >> 8) & 0xFF;
+  uint32_t crc = crc32Update(0, idat + 4, 11);
+  server.sendContent((const char*)head, sizeof(head));
+
+  uint32_t adlerA = 1, adlerB = 0;
+  uint8_t chunk[rowLen * SNAPSHOT_ROWS_PER_CHUNK];
+  for (int y = 0; y < SCREEN_HEIGHT; y += SNAPSHOT_ROWS_PER_CHUNK) {
+    for (int r = 0; r < SNAPSHOT_ROWS_PER_CHUNK; r++) {
+      uint8_t* row = chunk + r * rowLen;
+      row[0] = 0;  // filter: none
+      packScanline(fb, y + r, row + 1, true);
+    }
+    for (size_t i = 0; i < sizeof(chunk); i++) {
+      adlerA = (adlerA + chunk[i]) % 65521;
+      adlerB = (adlerB + adlerA) % 65521;
+    }
+    crc = crc32Update(crc, chunk, sizeof(chunk));
+    server.sendContent((const char*)chunk, sizeof(chunk));
+  }
+
+  uint8_t tail[8 + 12];
+  putBE32(tail, (adlerB << 16) | adlerA);
+  crc = crc32Update(crc, tail, 4);
+  putBE32(tail + 4, crc);
+  putBE32(tail + 8, 0);
+  memcpy(tail + 12, "IEND", 4);
+  putBE32(tail + 16, crc32Update(0, tail + 12, 4));
+  server.sendContent((const char*)tail, sizeof(tail));
+
+  endSnapshot();
+}
+
+const char WEB_INTERFACE[] PROGMEM = R"rawliteral(
 <!DOCTYPE html>
 <html>
 <head>
@@ -1409,6 +4433,20 @@ String getWebInterface() {
             transform: translateY(-2px);
         }
 
+        .views {
+            display: grid;
+            grid-template-columns: repeat(auto-fill, minmax(256px, 1fr));
+            gap: 15px;
+        }
+
+        .views img {
+            width: 100%;
+            image-rendering: pixelated;
+            background: #000;
+            border-radius: 6px;
+            cursor: pointer;
+        }
+
         .footer {
             text-align: center;
             color: white;
@@ -1447,6 +4485,11 @@ String getWebInterface() {
 
         <div id="content" class="loading">Loading dashboard...</div>
 
+        <div class="card">
+            <h2>🖥️ OLED Views</h2>
+            <div id="views" class="views"></div>
+        </div>
+
         <div style="text-align: center; margin-top: 20px;">
             <a href="/settings" class="settings-btn">⚙️ Settings</a>
         </div>
@@ -1467,6 +4510,11 @@ String getWebInterface() {
             return '🌤️';
         }
 
+        // The API sends null for a temperature it does not have
+        function formatTemp(value) {
+            return value === null || value === undefined ? '--' : Math.round(value);
+        }
+
         function getMoonEmoji(phase) {
             if (phase.includes('New')) return '🌑';
             if (phase.includes('Waxing Crescent')) return '🌒';
@@ -1479,11 +4527,18 @@ String getWebInterface() {
             return '🌙';
         }
 
+        // Only groups changed since `version` are sent; merge them into state
+        let state = {};
+        let version = 0;
+
         function updateDashboard() {
-            fetch('/api')
+            fetch('/api?since=' + version)
                 .then(response => response.json())
-                .then(data => {
+                .then(delta => {
+                    const data = Object.assign(state, delta);
+                    version = delta.version;
                     document.getElementById('location').textContent = data.location;
+                    if (delta.views) loadViews(delta.views);
 
                     const weatherIcon = getWeatherEmoji(data.weatherCode);
                     const moonIcon = getMoonEmoji(data.moonPhase);
@@ -1507,7 +4562,7 @@ String getWebInterface() {
                         <div class="card">
                             <h2>🌤️ Current Weather</h2>
                             <div class="weather-main">
-                                <div class="temp-display">${Math.round(data.temperature)}°${data.tempUnit}</div>
+                                <div class="temp-display">${formatTemp(data.temperature)}°${data.tempUnit}</div>
                                 <div class="weather-icon">${weatherIcon}</div>
                             </div>
                             <div class="info-row">
@@ -1527,7 +4582,7 @@ String getWebInterface() {
                                 return `
                                     <div class="forecast-item">
                                         <span class="forecast-date">${date} ${icon}</span>
-                                        <span class="forecast-temp">${Math.round(day.maxTemp)}° / ${Math.round(day.minTemp)}°</span>
+                                        <span class="forecast-temp">${formatTemp(day.maxTemp)}° / ${formatTemp(day.minTemp)}°</span>
                                     </div>
                                 `;
                             }).join('')}
@@ -1597,6 +4652,34 @@ String getWebInterface() {
                 });
         }
 
+        // OLED previews of the enabled views, in the order /api lists them.
+        // Each is rendered on demand, so they load one after another rather
+        // than all at once; click one to refresh it
+        let previewKey = '';
+        function loadViews(views) {
+            const shown = views.map((view, i) => ({index: i, title: view.title || view.name, enabled: view.enabled}))
+                               .filter(view => view.enabled);
+            const key = shown.map(view => view.index).join();
+            if (key === previewKey) return;
+            previewKey = key;
+
+            const container = document.getElementById('views');
+            container.innerHTML = shown.map(view =>
+                `<img alt="${view.title}" title="${view.title}" data-view="${view.index}"
+                      onclick="this.src='/screen.png?view=${view.index}&t=' + Date.now()">`
+            ).join('');
+            const images = Array.from(container.querySelectorAll('img'));
+            const next = i => {
+                if (i >= images.length || previewKey !== key) return;
+                images[i].onload = images[i].onerror = () => {
+                    images[i].onload = images[i].onerror = null;
+                    next(i + 1);
+                };
+                images[i].src = '/screen.png?view=' + images[i].dataset.view;
+            };
+            next(0);
+        }
+
         // Initial load
         updateDashboard();
 
@@ -1606,4 +4689,7 @@ String getWebInterface() {
 </body>
 </html>
 )rawliteral";
-}
\ No newline at end of file
+
+const char* getWebInterface() {
+  return WEB_INTERFACE;
+}
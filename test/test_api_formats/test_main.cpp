@@ -0,0 +1,123 @@
+// /api as JSON and as MessagePack for the same snapshot: both carry the same
+// data, and what each costs in bytes and encode time, as recordApiEncode()
+// counts them for /metrics on the device.
+#include "../../src/main.cpp"
+#include <unity.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+const uint16_t API_PORT = 18184;
+
+// GET on a fresh connection, pumping the server until EOF; returns the body
+// length, the body itself left at the front of body
+size_t fetchBody(const char* path, char* body, size_t size) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(API_PORT);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  TEST_ASSERT_EQUAL(0, connect(fd, (sockaddr*)&address, sizeof(address)));
+  char request[128];
+  int n = snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: localhost\r\n\r\n", path);
+  send(fd, request, n, MSG_NOSIGNAL);
+
+  size_t length = 0;
+  unsigned long start = millis();
+  while (millis() - start < 5000 && length < size) {
+    server.handleClient();
+    ssize_t got = recv(fd, body + length, size - length, MSG_DONTWAIT);
+    if (got == 0) break;
+    if (got > 0) length += got;
+  }
+  close(fd);
+  TEST_ASSERT_EQUAL_STRING_LEN("HTTP/1.1 200", body, 12);
+  const char* end = (const char*)memmem(body, length, "\r\n\r\n", 4);
+  TEST_ASSERT_NOT_NULL(end);
+  size_t header = end + 4 - body;
+  memmove(body, body + header, length - header);
+  return length - header;
+}
+
+void useSnapshot() {
+  weather.tempDeci = 215;
+  weather.code = 3;
+  for (int i = 0; i < FORECAST_DAYS; i++) {
+    ForecastDay& day = weather.forecast[i];
+    day.date = packDate(2024, 6, 10 + i);
+    day.maxDeci = 240 + 5 * i;
+    day.minDeci = 140 - 5 * i;
+    day.code = i + 1;
+  }
+}
+
+void setUp() {
+  useSnapshot();
+  memset(apiEncodeTime, 0, sizeof(apiEncodeTime));
+  memset(apiPayloadBytes, 0, sizeof(apiPayloadBytes));
+}
+
+void tearDown() {}
+
+void test_both_formats_carry_the_snapshot() {
+  static char body[16 * 1024];
+  size_t length = fetchBody("/api", body, sizeof(body));
+  DynamicJsonDocument json(8192);
+  TEST_ASSERT_FALSE(deserializeJson(json, body, length));
+
+  length = fetchBody("/api?format=msgpack", body, sizeof(body));
+  DynamicJsonDocument packed(8192);
+  TEST_ASSERT_FALSE(deserializeMsgPack(packed, body, length));
+
+  TEST_ASSERT_EQUAL(json["version"].as<uint64_t>(), packed["v"].as<uint64_t>());
+  TEST_ASSERT_EQUAL(215, packed["t"].as<int>());
+  TEST_ASSERT_EQUAL_FLOAT(21.5f, json["temperature"].as<float>());
+  TEST_ASSERT_EQUAL(json["weatherCode"].as<int>(), packed["wc"].as<int>());
+  TEST_ASSERT_EQUAL(json["forecast"].size(), packed["f"].size());
+  TEST_ASSERT_EQUAL(VIEW_COUNT, json["views"].size());  // the document held it all
+  TEST_ASSERT_EQUAL(VIEW_COUNT, packed["vw"].size());
+  TEST_ASSERT_EQUAL_STRING(json["views"][0]["name"], packed["vw"][0]["n"]);
+}
+
+// Host encode times are the host's; on the device the same counters come out
+// of /metrics as dashboard_api_encode_seconds and dashboard_api_payload_bytes.
+// Payload sizes carry over as they are.
+void test_size_and_encode_time() {
+  const int REQUESTS = 200;
+  static char body[16 * 1024];
+  for (int i = 0; i < REQUESTS; i++) {
+    fetchBody("/api", body, sizeof(body));
+    fetchBody("/api?format=msgpack", body, sizeof(body));
+  }
+  TEST_ASSERT_EQUAL(REQUESTS, apiEncodeTime[API_FORMAT_JSON].count);
+  TEST_ASSERT_EQUAL(REQUESTS, apiEncodeTime[API_FORMAT_MSGPACK].count);
+
+  char report[128];
+  for (int i = 0; i < API_FORMAT_COUNT; i++) {
+    snprintf(report, sizeof(report), "/api %s: %u bytes, encode mean %.1f us, max %u us (host)",
+             API_FORMAT_NAMES[i], (unsigned)apiPayloadBytes[i],
+             (double)apiEncodeTime[i].sumUs / apiEncodeTime[i].count, (unsigned)apiEncodeTime[i].maxUs);
+    TEST_MESSAGE(report);
+  }
+  snprintf(report, sizeof(report), "MessagePack is %u%% of the JSON payload",
+           (unsigned)(100 * apiPayloadBytes[API_FORMAT_MSGPACK] / apiPayloadBytes[API_FORMAT_JSON]));
+  TEST_MESSAGE(report);
+  TEST_ASSERT_LESS_THAN(apiPayloadBytes[API_FORMAT_JSON], apiPayloadBytes[API_FORMAT_MSGPACK]);
+}
+
+int main() {
+  // 06:13:20 UTC: no clock minute rolls over between the two formats
+  timeval tv = {1718000000, 0};
+  halSetTime(tv);
+  char port[8];
+  snprintf(port, sizeof(port), "%u", API_PORT);
+  setenv("NATIVE_HTTP_PORT", port, 1);
+  server.on("/api", HTTP_GET, handleAPI);
+  server.begin();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_both_formats_carry_the_snapshot);
+  RUN_TEST(test_size_and_encode_time);
+  return UNITY_END();
+}
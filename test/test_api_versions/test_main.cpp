@@ -0,0 +1,159 @@
+// /api versions: deltas within a boot, and no reuse across reboots
+#include "../../src/main.cpp"
+#include <unity.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+const uint16_t API_PORT = 18183;
+
+TimeContext apiNow;
+void* volatile heldBlock;  // moves the free heap between polls
+
+// GET on a fresh connection, pumping the server until EOF; the body parsed
+// as JSON into doc
+void fetchApi(const char* path, JsonDocument& doc) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(API_PORT);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  TEST_ASSERT_EQUAL(0, connect(fd, (sockaddr*)&address, sizeof(address)));
+  char request[128];
+  int n = snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: localhost\r\n\r\n", path);
+  send(fd, request, n, MSG_NOSIGNAL);
+
+  static char response[16 * 1024];
+  size_t length = 0;
+  unsigned long start = millis();
+  while (millis() - start < 5000 && length < sizeof(response) - 1) {
+    server.handleClient();
+    ssize_t got = recv(fd, response + length, sizeof(response) - 1 - length, MSG_DONTWAIT);
+    if (got == 0) break;
+    if (got > 0) length += got;
+  }
+  close(fd);
+  response[length] = '\0';
+  TEST_ASSERT_EQUAL_STRING_LEN("HTTP/1.1 200", response, 12);
+  const char* body = strstr(response, "\r\n\r\n");
+  TEST_ASSERT_NOT_NULL(body);
+  TEST_ASSERT_FALSE(deserializeJson(doc, body + 4));
+}
+
+void fetchSince(uint64_t token, JsonDocument& doc) {
+  char path[48];
+  snprintf(path, sizeof(path), "/api?since=%llu", (unsigned long long)token);
+  fetchApi(path, doc);
+}
+
+// A reboot as far as /api versioning is concerned
+void rebootApi() {
+  apiBootId = 0;
+  apiVersion = 0;
+  memset(apiGroupVersions, 0, sizeof(apiGroupVersions));
+  memset(apiGroupFingerprints, 0, sizeof(apiGroupFingerprints));
+}
+
+void setUp() {
+  rebootApi();
+  captureTime(apiNow);
+  weather.tempDeci = 215;
+}
+
+void tearDown() {}
+
+void test_versions_carry_the_boot_id() {
+  refreshApiVersions(apiNow);
+  TEST_ASSERT_NOT_EQUAL(0, apiBootId);
+  TEST_ASSERT_LESS_THAN(1UL << 21, apiBootId);
+  uint64_t token = apiVersionToken(apiVersion);
+  TEST_ASSERT_EQUAL(apiBootId, token >> 32);
+  TEST_ASSERT_LESS_OR_EQUAL((1ULL << 53) - 1, token);  // exact in a JS number
+}
+
+void test_since_returns_only_changed_groups() {
+  refreshApiVersions(apiNow);
+  uint64_t token = apiVersionToken(apiVersion);
+  TEST_ASSERT_EQUAL(apiVersion, apiSinceVersion(token));
+
+  weather.tempDeci = 230;
+  refreshApiVersions(apiNow);
+  uint32_t since = apiSinceVersion(token);
+  TEST_ASSERT_GREATER_THAN(since, apiGroupVersions[API_WEATHER]);
+  TEST_ASSERT_LESS_OR_EQUAL(since, apiGroupVersions[API_FORECAST]);
+  TEST_ASSERT_LESS_OR_EQUAL(since, apiGroupVersions[API_CONFIG]);
+}
+
+void test_future_version_gets_everything() {
+  refreshApiVersions(apiNow);
+  TEST_ASSERT_EQUAL(0, apiSinceVersion(apiVersionToken(apiVersion + 1)));
+}
+
+// Across simulated reboots a version from one boot never selects a delta in
+// another, even where the per-boot counters line up. Boot ids are 21 random
+// bits, so among 200 boots a shared id is rare (~1 %) but not impossible.
+void test_versions_from_other_boots_get_everything() {
+  const int BOOTS = 200;
+  static uint64_t tokens[BOOTS];
+  int sharedIds = 0;
+  for (int boot = 0; boot < BOOTS; boot++) {
+    rebootApi();
+    refreshApiVersions(apiNow);
+    tokens[boot] = apiVersionToken(apiVersion);
+    for (int earlier = 0; earlier < boot; earlier++) {
+      if (tokens[earlier] >> 32 == apiBootId) {
+        sharedIds++;
+        continue;
+      }
+      TEST_ASSERT_EQUAL(0, apiSinceVersion(tokens[earlier]));
+    }
+  }
+  TEST_ASSERT_LESS_OR_EQUAL(1, sharedIds);
+}
+
+// What goes over the wire: a full response, then deltas holding only the
+// groups that changed, with heap wobble between polls not counting
+void test_since_body_holds_only_changed_groups() {
+  DynamicJsonDocument doc(8192);
+  fetchApi("/api", doc);
+  for (const char* field : {"uptime", "freeHeap", "temperature", "sunrise", "moonPhase", "forecast", "views",
+                            "heapHistory"}) {
+    TEST_ASSERT_TRUE_MESSAGE(doc.containsKey(field), field);
+  }
+  uint64_t token = doc["version"];
+
+  heldBlock = malloc(600);
+  fetchSince(token, doc);
+  free(heldBlock);
+  TEST_ASSERT_EQUAL_MESSAGE(1, doc.size(), "only the version, nothing changed");
+  TEST_ASSERT_EQUAL(token, doc["version"].as<uint64_t>());
+
+  weather.tempDeci = 180;
+  fetchSince(token, doc);
+  TEST_ASSERT_TRUE(doc.containsKey("temperature"));
+  TEST_ASSERT_TRUE(doc.containsKey("weatherCode"));
+  for (const char* field : {"uptime", "freeHeap", "forecast", "views", "heapHistory", "sunrise"}) {
+    TEST_ASSERT_FALSE_MESSAGE(doc.containsKey(field), field);
+  }
+  TEST_ASSERT_GREATER_THAN(token, doc["version"].as<uint64_t>());
+}
+
+int main() {
+  // 06:13:20 UTC: no clock minute rolls over while the suite runs
+  timeval tv = {1718000000, 0};
+  halSetTime(tv);
+  char port[8];
+  snprintf(port, sizeof(port), "%u", API_PORT);
+  setenv("NATIVE_HTTP_PORT", port, 1);
+  server.on("/api", HTTP_GET, handleAPI);
+  server.begin();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_versions_carry_the_boot_id);
+  RUN_TEST(test_since_returns_only_changed_groups);
+  RUN_TEST(test_future_version_gets_everything);
+  RUN_TEST(test_versions_from_other_boots_get_everything);
+  RUN_TEST(test_since_body_holds_only_changed_groups);
+  return UNITY_END();
+}
@@ -0,0 +1,128 @@
+// The boot timeline and the time zone a geocode brings: setup() and loop()
+// get real data on the panel inside the boot budget, phases are stamped
+// once, by the boot job only, and a new zone applies without a reboot.
+#include "../../src/main.cpp"
+#include <unity.h>
+
+char fixtureDir[] = "/tmp/dashboard_boot_XXXXXX";
+uint32_t firstMark;  // markBootPhase() as the process starts, millis() near 0
+const uint32_t BOOT_BUDGET_MS = 3000;  // power-on to the first real frame
+
+void writeFixture(const char* host, const char* json) {
+  char path[96];
+  snprintf(path, sizeof(path), "%s/%s.json", fixtureDir, host);
+  FILE* f = fopen(path, "w");
+  fputs(json, f);
+  fclose(f);
+}
+
+void useGeocodedZone(const char* tz) {
+  char json[256];
+  snprintf(json, sizeof(json),
+           "{\"results\":[{\"name\":\"New York\",\"latitude\":40.71427,\"longitude\":-74.00597,"
+           "\"country\":\"United States\",\"timezone\":\"%s\"}]}",
+           tz);
+  writeFixture("geocoding-api.open-meteo.com", json);
+}
+
+// Runs queued jobs to completion
+void settle() {
+  for (int i = 0; i < MAX_JOBS; i++) {
+    while (jobs[i].id != 0 && (jobs[i].state == JOB_QUEUED || jobs[i].state == JOB_RUNNING)) runJobs();
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+// A phase done in the first millisecond must not read as pending and be
+// stamped again later
+void test_first_millisecond_is_kept() {
+  TEST_ASSERT_NOT_EQUAL(0, firstMark);
+  delay(2);
+  markBootPhase(BOOT_DISPLAY);
+  TEST_ASSERT_EQUAL(firstMark, bootPhaseMs[BOOT_DISPLAY]);
+}
+
+// millis() counts from process start, standing in for power-on. The host
+// link is up at once, so this holds the firmware's own share of the budget;
+// on the device /api's boot timeline adds the SDK boot and association.
+void test_boot_reaches_first_frame_within_budget() {
+  setup();
+  TEST_ASSERT_NOT_EQUAL(0, bootPhaseMs[BOOT_FIRST_FRAME]);
+  TEST_ASSERT_EQUAL(0, bootPhaseMs[BOOT_WIFI]);  // the frame did not wait for the link
+
+  unsigned long start = millis();
+  while ((bootPhaseMs[BOOT_WEATHER] == 0 || bootJobId != -1) && millis() - start < 5000) loop();
+
+  char report[160];
+  int n = snprintf(report, sizeof(report), "boot timeline (ms):");
+  for (int i = 0; i < BOOT_PHASE_COUNT; i++) {
+    char name[sizeof(BOOT_PHASE_NAMES[0])];
+    strlcpy_P(name, BOOT_PHASE_NAMES[i], sizeof(name));
+    n += snprintf(report + n, sizeof(report) - n, " %s %u", name, (unsigned)bootPhaseMs[i]);
+  }
+  TEST_MESSAGE(report);
+
+  TEST_ASSERT_LESS_THAN(BOOT_BUDGET_MS, bootPhaseMs[BOOT_FIRST_FRAME]);
+  TEST_ASSERT_NOT_EQUAL(0, bootPhaseMs[BOOT_READY]);
+  TEST_ASSERT_LESS_THAN(BOOT_BUDGET_MS, bootPhaseMs[BOOT_READY]);
+  TEST_ASSERT_NOT_EQUAL(0, bootPhaseMs[BOOT_SERVER]);
+  TEST_ASSERT_NOT_EQUAL(0, bootPhaseMs[BOOT_WEATHER]);
+  TEST_ASSERT_LESS_THAN(BOOT_BUDGET_MS, bootPhaseMs[BOOT_WEATHER]);
+}
+
+void test_only_the_boot_job_stamps_phases() {
+  useGeocodedZone("CET-1CEST,M3.5.0,M10.5.0/3");
+  bootJobId = queueSettingsJob(true, false);
+  settle();
+  TEST_ASSERT_NOT_EQUAL(0, bootPhaseMs[BOOT_GEOCODE]);
+  TEST_ASSERT_NOT_EQUAL(0, bootPhaseMs[BOOT_WEATHER]);
+  TEST_ASSERT_EQUAL(-1, bootJobId);
+
+  // A settings save long after boot leaves a skipped phase skipped
+  bootPhaseMs[BOOT_GEOCODE] = 0;
+  bootPhaseMs[BOOT_WEATHER] = 0;
+  queueSettingsJob(true, false);
+  settle();
+  TEST_ASSERT_EQUAL(0, bootPhaseMs[BOOT_GEOCODE]);
+  TEST_ASSERT_EQUAL(0, bootPhaseMs[BOOT_WEATHER]);
+  fetchWeatherData();
+  TEST_ASSERT_EQUAL(0, bootPhaseMs[BOOT_WEATHER]);
+}
+
+void test_geocoded_zone_applies_at_once() {
+  applyTimeZone();
+  solarDay.date = 1;
+  useGeocodedZone("EST5EDT,M3.2.0,M11.1.0");
+  TEST_ASSERT_TRUE(fetchGeocodingData(String("New York")));
+  TEST_ASSERT_EQUAL_STRING("EST5EDT,M3.2.0,M11.1.0", getenv("TZ"));
+  TEST_ASSERT_EQUAL(0, solarDay.date);  // sun times redone for the new offset
+
+  time_t noonUtc = 1718020800;  // 2024-06-10 12:00 UTC
+  struct tm local;
+  localtime_r(&noonUtc, &local);
+  TEST_ASSERT_EQUAL(8, local.tm_hour);
+}
+
+int main() {
+  markBootPhase(BOOT_DISPLAY);
+  firstMark = bootPhaseMs[BOOT_DISPLAY];
+
+  setenv("NATIVE_FS_ROOT", mkdtemp(fixtureDir), 1);
+  setenv("NATIVE_HTTP_FIXTURES", fixtureDir, 1);
+  setenv("NATIVE_HTTP_PORT", "18186", 1);
+  LittleFS.begin();
+  writeFixture("api.open-meteo.com",
+               "{\"current_weather\":{\"temperature\":21.5,\"windspeed\":3.4,\"weathercode\":1},"
+               "\"daily\":{\"time\":[\"2024-06-10\",\"2024-06-11\",\"2024-06-12\"],"
+               "\"temperature_2m_max\":[24.0,25.5,23.0],\"temperature_2m_min\":[14.0,15.5,13.0],"
+               "\"weathercode\":[1,2,3]}}");
+
+  UNITY_BEGIN();
+  RUN_TEST(test_first_millisecond_is_kept);
+  RUN_TEST(test_boot_reaches_first_frame_within_budget);
+  RUN_TEST(test_only_the_boot_job_stamps_phases);
+  RUN_TEST(test_geocoded_zone_applies_at_once);
+  return UNITY_END();
+}
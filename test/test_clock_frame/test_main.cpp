@@ -0,0 +1,55 @@
+// The clock view redraws every second for as long as it is up; a frame
+// must not touch the heap.
+#include "../../src/main.cpp"
+#include <unity.h>
+#include <NativeHeap.h>
+
+const time_t FRAME_START = 1718000000;  // 2024-06-10, a Monday
+
+void setFrameClock(time_t t) {
+  timeval tv = {t, 0};
+  halSetTime(tv);
+}
+
+void setUp() {
+  setenv("TZ", timeZone, 1);
+  tzset();
+  display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS);
+  display.setTextColor(WHITE);
+  viewEnabledMask = (1 << VIEW_COUNT) - 1;
+  currentView = CLOCK_VIEW;
+  setFrameClock(FRAME_START);
+  drawView(CLOCK_VIEW);  // first use of localtime and the like
+}
+
+void tearDown() {}
+
+void test_clock_frame_does_not_allocate() {
+  const int FRAMES = 3600;  // an hour, every second redrawn
+  uint32_t before = nativeHeapAllocations();
+  for (int i = 1; i <= FRAMES; i++) {
+    setFrameClock(FRAME_START + i);
+    TEST_ASSERT_TRUE(viewNeedsRedraw(CLOCK_VIEW));
+    drawView(CLOCK_VIEW);
+  }
+  uint32_t allocations = nativeHeapAllocations() - before;
+  char report[64];
+  snprintf(report, sizeof(report), "%u allocations in %d clock frames", (unsigned)allocations, FRAMES);
+  TEST_MESSAGE(report);
+  TEST_ASSERT_EQUAL(0, allocations);
+}
+
+// Guards the counter itself: a String that outgrows its inline buffer
+void test_counter_sees_allocations() {
+  uint32_t before = nativeHeapAllocations();
+  String text(displayName);
+  text += " and then some more text";
+  TEST_ASSERT_GREATER_THAN(before, nativeHeapAllocations());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_clock_frame_does_not_allocate);
+  RUN_TEST(test_counter_sees_allocations);
+  return UNITY_END();
+}
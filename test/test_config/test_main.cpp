@@ -0,0 +1,214 @@
+// /config.bin round trips: the current record, a version 1 record whose
+// crc sits where version 2 keeps its view settings, the one-time import of
+// a legacy /config.json, and records that must be turned away. Runs on the
+// native LittleFS, a scratch host directory.
+#include "../../src/main.cpp"
+#include <unity.h>
+
+char fsRoot[] = "/tmp/dashboard_config_XXXXXX";
+
+// Version 1 ended after viewDuration
+const size_t CONFIG_V1_SIZE = offsetof(ConfigRecord, viewEnabledMask) + sizeof(uint32_t);
+
+void restoreDefaults() {
+  strlcpy(cityName, "Kreuzlingen, Switzerland", sizeof(cityName));
+  strlcpy(displayName, "Kreuzlingen, CH", sizeof(displayName));
+  strlcpy(latitude, "47.65", sizeof(latitude));
+  strlcpy(longitude, "9.18", sizeof(longitude));
+  strlcpy(timeZone, "CET-1CEST,M3.5.0,M10.5.0/3", sizeof(timeZone));
+  strlcpy(tempUnit, "C", sizeof(tempUnit));
+  viewDuration = 5000;
+  manualCoordinates = false;
+  viewEnabledMask = (1 << VIEW_COUNT) - 1;
+  memset(viewSeconds, 0, sizeof(viewSeconds));
+}
+
+void useBerlin() {
+  strlcpy(cityName, "Berlin, Germany", sizeof(cityName));
+  strlcpy(displayName, "Berlin, DE", sizeof(displayName));
+  strlcpy(latitude, "52.5244", sizeof(latitude));
+  strlcpy(longitude, "13.4105", sizeof(longitude));
+  strlcpy(timeZone, "CET-1CEST,M3.5.0,M10.5.0/3", sizeof(timeZone));
+  strlcpy(tempUnit, "F", sizeof(tempUnit));
+  viewDuration = 8000;
+  manualCoordinates = true;
+  viewEnabledMask = 0x05;
+  for (int i = 0; i < VIEW_COUNT; i++) viewSeconds[i] = 3 + i;
+}
+
+void writeFile(const char* path, const void* data, size_t length) {
+  File file = LittleFS.open(path, "w");
+  TEST_ASSERT_TRUE(file);
+  TEST_ASSERT_EQUAL(length, file.write((const uint8_t*)data, length));
+  file.close();
+}
+
+void assertBerlin() {
+  TEST_ASSERT_EQUAL_STRING("Berlin, Germany", cityName);
+  TEST_ASSERT_EQUAL_STRING("Berlin, DE", displayName);
+  TEST_ASSERT_EQUAL_STRING("52.5244", latitude);
+  TEST_ASSERT_EQUAL_STRING("13.4105", longitude);
+  TEST_ASSERT_EQUAL_STRING("F", tempUnit);
+  TEST_ASSERT_EQUAL(8000, viewDuration);
+  TEST_ASSERT_TRUE(manualCoordinates);
+}
+
+void setUp() {
+  LittleFS.remove(CONFIG_PATH);
+  LittleFS.remove(CONFIG_TEMP_PATH);
+  LittleFS.remove(LEGACY_CONFIG_PATH);
+  restoreDefaults();
+}
+
+void tearDown() {}
+
+void test_round_trip() {
+  useBerlin();
+  TEST_ASSERT_TRUE(saveConfig());
+  TEST_ASSERT_FALSE(LittleFS.exists(CONFIG_TEMP_PATH));
+  restoreDefaults();
+
+  loadConfig();
+  assertBerlin();
+  TEST_ASSERT_EQUAL(0x05, viewEnabledMask);
+  for (int i = 0; i < VIEW_COUNT; i++) TEST_ASSERT_EQUAL(3 + i, viewSeconds[i]);
+}
+
+// A version 1 record keeps its fields; the view settings it predates stay
+// at their defaults instead of taking the old crc's bytes
+void test_version_1_record_keeps_defaults_for_the_tail() {
+  useBerlin();
+  ConfigRecord rec;
+  captureConfig(rec);
+  rec.version = 1;
+  rec.size = CONFIG_V1_SIZE;
+  uint32_t crc = crc32Update(0, (const uint8_t*)&rec, CONFIG_V1_SIZE - sizeof(crc));
+  memcpy((uint8_t*)&rec + CONFIG_V1_SIZE - sizeof(crc), &crc, sizeof(crc));
+  writeFile(CONFIG_PATH, &rec, CONFIG_V1_SIZE);
+  restoreDefaults();
+
+  loadConfig();
+  assertBerlin();
+  TEST_ASSERT_EQUAL((1 << VIEW_COUNT) - 1, viewEnabledMask);
+  for (int i = 0; i < VIEW_COUNT; i++) TEST_ASSERT_EQUAL(0, viewSeconds[i]);
+
+  // The next save writes the current version
+  TEST_ASSERT_TRUE(saveConfig());
+  TEST_ASSERT_TRUE(readConfigRecord(rec));
+  TEST_ASSERT_EQUAL(CONFIG_VERSION, rec.version);
+  TEST_ASSERT_EQUAL(sizeof(ConfigRecord), rec.size);
+}
+
+void test_legacy_json_is_migrated_once() {
+  const char json[] =
+      "{\"cityName\":\"Berlin, Germany\",\"displayName\":\"Berlin, DE\",\"latitude\":\"52.5244\","
+      "\"longitude\":\"13.4105\",\"timezone\":\"CET-1CEST,M3.5.0,M10.5.0/3\",\"tempUnit\":\"F\","
+      "\"viewDuration\":8000,\"manualCoordinates\":true}";
+  writeFile(LEGACY_CONFIG_PATH, json, strlen(json));
+
+  loadConfig();
+  assertBerlin();
+  TEST_ASSERT_FALSE(LittleFS.exists(LEGACY_CONFIG_PATH));
+  TEST_ASSERT_TRUE(LittleFS.exists(CONFIG_PATH));
+
+  restoreDefaults();
+  loadConfig();
+  assertBerlin();
+}
+
+// Oversized strings in old JSON are cut to the fields, never overrun them
+void test_legacy_json_strings_are_bounded() {
+  char json[256];
+  snprintf(json, sizeof(json), "{\"cityName\":\"%0120d\",\"tempUnit\":\"Fahrenheit\"}", 0);
+  writeFile(LEGACY_CONFIG_PATH, json, strlen(json));
+  loadConfig();
+  TEST_ASSERT_EQUAL(sizeof(cityName) - 1, strlen(cityName));
+  TEST_ASSERT_EQUAL_STRING("F", tempUnit);
+}
+
+void test_corrupt_json_leaves_defaults() {
+  writeFile(LEGACY_CONFIG_PATH, "{\"cityName\":", 12);
+  loadConfig();
+  TEST_ASSERT_EQUAL_STRING("Kreuzlingen, Switzerland", cityName);
+  TEST_ASSERT_TRUE(LittleFS.exists(LEGACY_CONFIG_PATH));
+}
+
+// Every byte covered by the crc, a wrong magic or size, a version from
+// newer firmware and a truncated file are all rejected, leaving defaults
+void test_damaged_records_are_rejected() {
+  useBerlin();
+  ConfigRecord good;
+  captureConfig(good);
+
+  for (size_t offset = 0; offset < sizeof(good); offset++) {
+    ConfigRecord bad = good;
+    ((uint8_t*)&bad)[offset] ^= 0x40;
+    writeFile(CONFIG_PATH, &bad, sizeof(bad));
+    ConfigRecord rec;
+    char message[32];
+    snprintf(message, sizeof(message), "flipped byte %u", (unsigned)offset);
+    TEST_ASSERT_FALSE_MESSAGE(readConfigRecord(rec), message);
+  }
+
+  ConfigRecord newer = good;
+  newer.version = CONFIG_VERSION + 1;
+  newer.crc = crc32Update(0, (const uint8_t*)&newer, offsetof(ConfigRecord, crc));
+  writeFile(CONFIG_PATH, &newer, sizeof(newer));
+  ConfigRecord rec;
+  TEST_ASSERT_FALSE(readConfigRecord(rec));
+
+  writeFile(CONFIG_PATH, &good, sizeof(good) - 1);
+  TEST_ASSERT_FALSE(readConfigRecord(rec));
+
+  restoreDefaults();
+  loadConfig();
+  TEST_ASSERT_EQUAL_STRING("Kreuzlingen, Switzerland", cityName);
+}
+
+// Host cost of a boot's loadConfig(), record against legacy JSON, in the
+// 80 MHz cycles ESP.getCycleCount() counts on the native build. File access
+// is the host's, so only the ratio carries over; on the device loadConfig()
+// logs its own time in microseconds.
+void test_load_benchmark() {
+  const int LOADS = 2000;
+  useBerlin();
+  TEST_ASSERT_TRUE(saveConfig());
+  uint32_t start = ESP.getCycleCount();
+  for (int i = 0; i < LOADS; i++) loadConfig();
+  uint32_t record = (ESP.getCycleCount() - start) / LOADS;
+
+  const char json[] =
+      "{\"cityName\":\"Berlin, Germany\",\"displayName\":\"Berlin, DE\",\"latitude\":\"52.5244\","
+      "\"longitude\":\"13.4105\",\"timezone\":\"CET-1CEST,M3.5.0,M10.5.0/3\",\"tempUnit\":\"F\","
+      "\"viewDuration\":8000,\"manualCoordinates\":true}";
+  uint32_t legacy = 0;
+  for (int i = 0; i < LOADS; i++) {
+    LittleFS.remove(CONFIG_PATH);
+    writeFile(LEGACY_CONFIG_PATH, json, strlen(json));
+    start = ESP.getCycleCount();
+    loadConfig();
+    legacy += ESP.getCycleCount() - start;
+  }
+  legacy /= LOADS;
+
+  char report[96];
+  snprintf(report, sizeof(report), "loadConfig: record %u host cycles, legacy JSON import %u host cycles",
+           (unsigned)record, (unsigned)legacy);
+  TEST_MESSAGE(report);
+  TEST_ASSERT_LESS_THAN(legacy, record);
+}
+
+int main() {
+  setenv("NATIVE_FS_ROOT", mkdtemp(fsRoot), 1);
+  LittleFS.begin();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip);
+  RUN_TEST(test_version_1_record_keeps_defaults_for_the_tail);
+  RUN_TEST(test_legacy_json_is_migrated_once);
+  RUN_TEST(test_legacy_json_strings_are_bounded);
+  RUN_TEST(test_corrupt_json_leaves_defaults);
+  RUN_TEST(test_damaged_records_are_rejected);
+  RUN_TEST(test_load_benchmark);
+  return UNITY_END();
+}
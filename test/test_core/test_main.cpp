@@ -0,0 +1,110 @@
+// Pure helpers of the firmware, on the host: pio test -e native
+//
+// The firmware is a single translation unit, so each suite compiles it in
+// whole and reaches its statics and types directly; setup() and loop() are
+// there but never run.
+#include "../../src/main.cpp"
+#include <unity.h>
+
+void setUp() {
+  viewEnabledMask = 0xFF;
+  memset(viewSeconds, 0, sizeof(viewSeconds));
+  viewDuration = 5000;
+}
+
+void tearDown() {}
+
+void test_minute_of_day_round_trip() {
+  char text[6];
+  TEST_ASSERT_EQUAL(0, parseMinuteOfDay("00:00"));
+  TEST_ASSERT_EQUAL(23 * 60 + 59, parseMinuteOfDay("23:59"));
+  TEST_ASSERT_EQUAL(-1, parseMinuteOfDay("7:30"));
+  TEST_ASSERT_EQUAL(-1, parseMinuteOfDay("07-30"));
+  TEST_ASSERT_EQUAL_STRING("07:05", formatMinuteOfDay(7 * 60 + 5, text, sizeof(text)));
+  TEST_ASSERT_EQUAL_STRING("N/A", formatMinuteOfDay(-1, text, sizeof(text)));
+  TEST_ASSERT_EQUAL_STRING("23:59", formatMinuteOfDay(INT16_MAX, text, sizeof(text)));
+}
+
+void test_packed_date_round_trip() {
+  char text[11];
+  uint16_t date = parsePackedDate("2024-02-29");
+  TEST_ASSERT_EQUAL(packDate(2024, 2, 29), date);
+  TEST_ASSERT_EQUAL_STRING("2024-02-29", formatPackedDate(date, text, sizeof(text)));
+  TEST_ASSERT_EQUAL(0, parsePackedDate("1999-12-31"));
+  TEST_ASSERT_EQUAL(0, parsePackedDate("2024-13-01"));
+  TEST_ASSERT_EQUAL(0, parsePackedDate(nullptr));
+  TEST_ASSERT_EQUAL_STRING("", formatPackedDate(0, text, sizeof(text)));
+}
+
+void test_deci_degrees() {
+  TEST_ASSERT_EQUAL(215, toDeciDegrees(21.5f));
+  TEST_ASSERT_EQUAL(-3, toDeciDegrees(-0.26f));
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, -12.3f, fromDeciDegrees(-123));
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, fromDeciDegrees(TEMP_UNKNOWN));
+  TEST_ASSERT_EQUAL(TEMP_UNKNOWN, toDeciDegrees(NAN));
+}
+
+void test_whole_degrees() {
+  char text[6];
+  strcpy(tempUnit, "C");
+  TEST_ASSERT_EQUAL_STRING("21", formatWholeDegrees(215, text, sizeof(text)));
+  TEST_ASSERT_EQUAL_STRING("--", formatWholeDegrees(TEMP_UNKNOWN, text, sizeof(text)));
+  strcpy(tempUnit, "F");
+  TEST_ASSERT_EQUAL_STRING("70", formatWholeDegrees(215, text, sizeof(text)));
+  TEST_ASSERT_EQUAL_STRING("--", formatWholeDegrees(TEMP_UNKNOWN, text, sizeof(text)));
+  strcpy(tempUnit, "C");
+}
+
+void test_rotation_skips_disabled_views() {
+  viewEnabledMask = (1 << CLOCK_VIEW) | (1 << MOON_VIEW);
+  TEST_ASSERT_EQUAL(MOON_VIEW, nextEnabledView(CLOCK_VIEW));
+  TEST_ASSERT_EQUAL(CLOCK_VIEW, nextEnabledView(MOON_VIEW));
+  TEST_ASSERT_EQUAL(MOON_VIEW, nextEnabledView(WEATHER_VIEW));
+
+  viewEnabledMask = 1 << DATE_VIEW;
+  TEST_ASSERT_EQUAL(DATE_VIEW, nextEnabledView(DATE_VIEW));
+}
+
+void test_view_duration_override() {
+  viewSeconds[QUOTE_VIEW] = 12;
+  TEST_ASSERT_EQUAL(12000, viewDurationMs(QUOTE_VIEW));
+  TEST_ASSERT_EQUAL(5000, viewDurationMs(CLOCK_VIEW));
+}
+
+void test_fnv1a_known_vector() {
+  // FNV-1a 32 of "a"
+  TEST_ASSERT_EQUAL_HEX32(0xE40C292C, fnv1a(FNV_OFFSET_BASIS, "a", 1));
+  TEST_ASSERT_NOT_EQUAL(fnv1a(FNV_OFFSET_BASIS, (int32_t)1), fnv1a(FNV_OFFSET_BASIS, (int32_t)2));
+}
+
+// Every family's TYPE line survives in full, however long its HELP text
+void test_metric_families_complete() {
+  String out;
+  uint32_t cursor = 0;
+  while (generateMetrics(out, cursor)) {}
+  int families = 0;
+  for (int start = 0; start < (int)out.length();) {
+    int end = out.indexOf('\n', start);
+    String line = out.substring(start, end);
+    if (line.startsWith("# TYPE ")) {
+      families++;
+      TEST_ASSERT_TRUE_MESSAGE(line.endsWith(" counter") || line.endsWith(" gauge") ||
+                               line.endsWith(" histogram") || line.endsWith(" summary"), line.c_str());
+    }
+    start = end + 1;
+  }
+  TEST_ASSERT_GREATER_THAN(20, families);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_minute_of_day_round_trip);
+  RUN_TEST(test_packed_date_round_trip);
+  RUN_TEST(test_deci_degrees);
+  RUN_TEST(test_whole_degrees);
+  RUN_TEST(test_rotation_skips_disabled_views);
+  RUN_TEST(test_view_duration_override);
+  RUN_TEST(test_fnv1a_known_vector);
+  RUN_TEST(test_metric_families_complete);
+  return UNITY_END();
+}
@@ -0,0 +1,104 @@
+// Every view is redrawn for as long as the device runs, so drawView() must
+// never touch the heap, whatever the state of time, weather and WiFi.
+#include "../../src/main.cpp"
+#include <unity.h>
+#include <NativeHeap.h>
+
+const time_t DRAW_START = 1718000000;  // 2024-06-10, a Monday
+
+void setDrawClock(time_t t) {
+  timeval tv = {t, 0};
+  halSetTime(tv);
+}
+
+void setKnownWeather() {
+  weather.tempDeci = -42;
+  weather.code = 61;
+  for (int i = 0; i < FORECAST_DAYS; i++) {
+    weather.forecast[i] = {packDate(2024, 6, 10 + i), (int16_t)(215 + i), (int16_t)(-30 + i), (int16_t)(i * 45)};
+  }
+}
+
+void setUnknownWeather() {
+  weather.tempDeci = TEMP_UNKNOWN;
+  weather.code = CODE_UNKNOWN;
+  for (int i = 0; i < FORECAST_DAYS; i++) {
+    weather.forecast[i] = {0, TEMP_UNKNOWN, TEMP_UNKNOWN, CODE_UNKNOWN};
+  }
+}
+
+// Draws every view (and every quote) once, failing on the first view that
+// allocates
+void drawEveryView(const char* state) {
+  for (int v = 0; v < VIEW_COUNT; v++) {
+    View view = static_cast<View>(v);
+    int variants = view == QUOTE_VIEW ? NUM_QUOTES : 1;
+    for (int q = 0; q < variants; q++) {
+      currentQuoteIndex = q;
+      uint32_t before = nativeHeapAllocations();
+      drawView(view);
+      uint32_t allocations = nativeHeapAllocations() - before;
+      char message[96];
+      snprintf(message, sizeof(message), "%s view, %s, quote %d", VIEW_NAMES[view], state, q);
+      TEST_ASSERT_EQUAL_MESSAGE(0, allocations, message);
+    }
+  }
+}
+
+void setUp() {
+  setenv("TZ", timeZone, 1);
+  tzset();
+  display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS);
+  display.setTextColor(WHITE);
+  setDrawClock(DRAW_START);
+  updateSky();
+  wifiState = WIFI_UP;
+  strlcpy(tempUnit, "C", sizeof(tempUnit));
+  setKnownWeather();
+  for (int v = 0; v < VIEW_COUNT; v++) drawView(static_cast<View>(v));  // first use of localtime and the like
+}
+
+void tearDown() {}
+
+void test_views_with_data() {
+  for (const char* unit : {"C", "F", "B"}) {
+    strlcpy(tempUnit, unit, sizeof(tempUnit));
+    drawEveryView(unit);
+  }
+}
+
+void test_views_without_weather() {
+  setUnknownWeather();
+  drawEveryView("no weather");
+}
+
+void test_views_without_wifi() {
+  wifiState = WIFI_BACKOFF;
+  wifiDownSince = millis();
+  drawEveryView("WiFi down");
+}
+
+void test_views_before_time_sync() {
+  setDrawClock(1000);
+  moon = MoonState();
+  solarDay = SolarDay();
+  drawEveryView("no time");
+}
+
+void test_views_through_a_day() {
+  for (time_t t = DRAW_START; t < DRAW_START + 86400; t += 3600 + 59) {
+    setDrawClock(t);
+    updateSky();
+    drawEveryView("hourly");
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_views_with_data);
+  RUN_TEST(test_views_without_weather);
+  RUN_TEST(test_views_without_wifi);
+  RUN_TEST(test_views_before_time_sync);
+  RUN_TEST(test_views_through_a_day);
+  return UNITY_END();
+}
@@ -0,0 +1,191 @@
+// A week of uptime, compressed: the wall clock steps a minute at a time
+// while the firmware fetches weather every ten minutes, redraws the
+// display, answers the dashboard's API, screen and metrics requests and
+// now and then saves new settings. The heap model in native_hal tracks
+// every allocation, so the largest free block must hold up across the
+// week and the free heap must not creep down from one day to the next.
+#include "../../src/main.cpp"
+#include <unity.h>
+#include <NativeHeap.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+const uint16_t SOAK_PORT = 18182;
+const time_t SOAK_START = 1718000000;  // 2024-06-10
+const int SOAK_DAYS = 7;
+const uint32_t SOAK_MIN_MAX_BLOCK = 24 * 1024;
+const uint32_t SOAK_DAILY_DRIFT = 512;  // free heap a day may lose to noise
+
+char fixtureDir[] = "/tmp/dashboard_soak_XXXXXX";
+
+void setSoakClock(time_t t) {
+  timeval tv = {t, 0};
+  halSetTime(tv);
+}
+
+// Open-Meteo's answers, varied per fetch so payload sizes vary too
+void writeFixtures(int fetch) {
+  char path[96];
+  snprintf(path, sizeof(path), "%s/api.open-meteo.com.json", fixtureDir);
+  FILE* f = fopen(path, "w");
+  fprintf(f,
+          "{\"latitude\":52.52,\"longitude\":13.42,\"timezone\":\"Europe/Berlin\","
+          "\"current_weather\":{\"temperature\":%.1f,\"windspeed\":%d.4,\"weathercode\":%d},"
+          "\"daily\":{\"time\":[\"2024-06-%02d\",\"2024-06-%02d\",\"2024-06-%02d\"],"
+          "\"temperature_2m_max\":[%.1f,%.1f,%s],\"temperature_2m_min\":[%.1f,%.1f,%.1f],"
+          "\"weathercode\":[%d,%d,%d]}}",
+          (fetch % 300) / 10.0 - 5, fetch % 40, (fetch * 7) % 100, 10 + fetch / 144 % 20, 11 + fetch / 144 % 20,
+          12 + fetch / 144 % 20, (fetch % 250) / 10.0, 21.5, fetch % 5 ? "19.25" : "null", -1.5, 8.0,
+          (fetch % 90) / 10.0, fetch % 4, (fetch * 3) % 99, 61);
+  fclose(f);
+
+  snprintf(path, sizeof(path), "%s/geocoding-api.open-meteo.com.json", fixtureDir);
+  f = fopen(path, "w");
+  fprintf(f,
+          "{\"results\":[{\"name\":\"Berlin\",\"latitude\":52.52437,\"longitude\":13.41053,"
+          "\"country\":\"Germany\",\"timezone\":\"Europe/Berlin\",\"population\":%d}]}",
+          3426354 + fetch);
+  fclose(f);
+}
+
+// One request on a fresh connection, the firmware's server pumped until
+// the response has been read to EOF; returns the status code
+int request(const char* method, const char* path, const char* body = "") {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(SOAK_PORT);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+    close(fd);
+    return 0;
+  }
+  char head[256];
+  int n = snprintf(head, sizeof(head),
+                   "%s %s HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/x-www-form-urlencoded\r\n"
+                   "Content-Length: %u\r\n\r\n%s",
+                   method, path, (unsigned)strlen(body), body);
+  send(fd, head, n, MSG_NOSIGNAL);
+
+  char status[16] = "";
+  size_t statusLength = 0;
+  char chunk[4096];
+  unsigned long start = millis();
+  while (millis() - start < 5000) {
+    server.handleClient();
+    ssize_t got = recv(fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+    if (got == 0) break;
+    if (got > 0 && statusLength < sizeof(status) - 1) {
+      size_t take = min<size_t>(got, sizeof(status) - 1 - statusLength);
+      memcpy(status + statusLength, chunk, take);
+      statusLength += take;
+    }
+  }
+  close(fd);
+  int code = 0;
+  sscanf(status, "HTTP/1.1 %d", &code);
+  return code;
+}
+
+// Runs queued settings jobs to completion
+void settle() {
+  for (int i = 0; i < MAX_JOBS; i++) {
+    while (jobs[i].id != 0 && (jobs[i].state == JOB_QUEUED || jobs[i].state == JOB_RUNNING)) runJobs();
+  }
+}
+
+void test_week_of_uptime() {
+  uint32_t failuresBefore = nativeHeapFailures();
+  uint32_t minMaxBlock = UINT32_MAX;
+  uint32_t dayStartFree[SOAK_DAYS + 1] = {};
+  int fetches = 0;
+  int errors = 0;
+  char path[48];
+
+  for (int minute = 0; minute <= SOAK_DAYS * 24 * 60; minute++) {
+    setSoakClock(SOAK_START + minute * 60);
+    if (minute % 10 == 0) {
+      writeFixtures(fetches++);
+      if (!fetchWeatherData()) errors++;
+    }
+    if (minute % (6 * 60) == 0) {
+      // A settings save every six hours, alternating units and city, which
+      // runs a geocode, a config write and a fetch as a background job
+      const char* form = minute % (12 * 60) ? "city=Berlin%2C+DE&tempUnit=F&duration=5"
+                                            : "city=Berlin&tempUnit=C&duration=5";
+      if (request("POST", "/settings/save", form) != 202) errors++;
+      settle();
+    }
+
+    updateSky();
+    for (int view = 0; view < VIEW_COUNT; view++) {
+      currentView = (View)view;
+      currentQuoteIndex = minute % NUM_QUOTES;
+      drawView(currentView);
+    }
+    saveRtcState();
+
+    // What an open dashboard polls, plus the odd scrape and debug page
+    snprintf(path, sizeof(path), "/api?since=%llu", (unsigned long long)apiVersionToken(apiVersion));
+    if (request("GET", minute % 2 ? path : "/api") != 200) errors++;
+    snprintf(path, sizeof(path), "/screen.pbm?view=%d", minute % VIEW_COUNT);
+    if (request("GET", minute % 3 ? path : "/screen.png") != 200) errors++;
+    if (minute % 5 == 0 && request("GET", "/metrics") != 200) errors++;
+    if (minute % 15 == 0 && request("GET", "/log") != 200) errors++;
+    if (minute % 60 == 0 && request("GET", "/trace") != 200) errors++;
+    if (minute % 60 == 30 && request("GET", "/") != 200) errors++;
+
+    updateHeapStats();
+    minMaxBlock = min<uint32_t>(minMaxBlock, ESP.getMaxFreeBlockSize());
+    if (minute % (24 * 60) == 0) dayStartFree[minute / (24 * 60)] = ESP.getFreeHeap();
+  }
+
+  char report[160];
+  snprintf(report, sizeof(report), "%d days, %d fetches: free %u -> %u bytes, largest block low %u, fragmentation %u%%",
+           SOAK_DAYS, fetches, (unsigned)dayStartFree[1], (unsigned)dayStartFree[SOAK_DAYS], (unsigned)minMaxBlock,
+           ESP.getHeapFragmentation());
+  TEST_MESSAGE(report);
+
+  TEST_ASSERT_EQUAL(0, errors);
+  TEST_ASSERT_EQUAL_MESSAGE(failuresBefore, nativeHeapFailures(), "the heap model ran out of room");
+  TEST_ASSERT_GREATER_OR_EQUAL(SOAK_MIN_MAX_BLOCK, minMaxBlock);
+  TEST_ASSERT_GREATER_OR_EQUAL(SOAK_MIN_MAX_BLOCK, heapMinMaxBlock);
+  // Day 0 still has first-use allocations settling in; from day 1 on, no leak
+  for (int day = 2; day <= SOAK_DAYS; day++) {
+    TEST_ASSERT_GREATER_OR_EQUAL(dayStartFree[1] - SOAK_DAILY_DRIFT, dayStartFree[day]);
+  }
+}
+
+void* volatile held;  // so the compiler keeps the malloc below
+
+// Guards the model itself: memory taken shows up, and comes back on free
+void test_model_tracks_blocks() {
+  uint32_t before = ESP.getFreeHeap();
+  held = malloc(1000);  // 1000 bytes and the header, in 8 byte blocks
+  TEST_ASSERT_EQUAL(before - 1008, ESP.getFreeHeap());
+  free(held);
+  TEST_ASSERT_EQUAL(before, ESP.getFreeHeap());
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main() {
+  setenv("NATIVE_FS_ROOT", mkdtemp(fixtureDir), 1);
+  setenv("NATIVE_HTTP_FIXTURES", fixtureDir, 1);
+  char port[8];
+  snprintf(port, sizeof(port), "%u", SOAK_PORT);
+  setenv("NATIVE_HTTP_PORT", port, 1);
+  setSoakClock(SOAK_START);
+  writeFixtures(0);
+  setup();
+  updateWifi();  // the link, and with it the web server, as loop() brings them up
+  settle();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_model_tracks_blocks);
+  RUN_TEST(test_week_of_uptime);
+  return UNITY_END();
+}
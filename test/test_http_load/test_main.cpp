@@ -0,0 +1,141 @@
+// Load test of the web server: 1, 4 and 8 clients issuing back-to-back
+// requests against the running firmware for a few seconds each, reporting
+// requests per second and p99 latency. More clients than connection slots
+// must queue, not fail.
+#include "../../src/main.cpp"
+#include <unity.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+const uint16_t LOAD_PORT = 18181;
+const unsigned long LOAD_MS = 3000;
+const uint32_t LOAD_P99_LIMIT_US = 250000;
+
+// What the browser dashboard fetches
+const char* const LOAD_PATHS[] = {"/api", "/screen.png", "/screen.pbm?view=6", "/api?since=1", "/"};
+const int LOAD_PATH_COUNT = sizeof(LOAD_PATHS) / sizeof(LOAD_PATHS[0]);
+
+struct LoadClient {
+  std::vector<uint32_t> latencyUs;
+  int failures = 0;
+  char lastError[96] = "";
+};
+
+// One GET on a fresh connection, read to EOF. Fails on anything but a 200
+// whose body matches its Content-Length.
+bool fetchOnce(const char* path, LoadClient& client) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(LOAD_PORT);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+    close(fd);
+    snprintf(client.lastError, sizeof(client.lastError), "%s: connect failed", path);
+    return false;
+  }
+  char request[128];
+  int n = snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: localhost\r\n\r\n", path);
+  send(fd, request, n, MSG_NOSIGNAL);
+
+  static thread_local char response[64 * 1024];
+  size_t length = 0;
+  ssize_t got;
+  while (length < sizeof(response) - 1 && (got = recv(fd, response + length, sizeof(response) - 1 - length, 0)) > 0) {
+    length += got;
+  }
+  close(fd);
+  response[length] = '\0';
+
+  int status = 0;
+  sscanf(response, "HTTP/1.1 %d", &status);
+  const char* headerEnd = strstr(response, "\r\n\r\n");
+  const char* contentLength = strcasestr(response, "\r\nContent-Length: ");
+  bool complete = headerEnd != nullptr;
+  if (complete && contentLength && contentLength < headerEnd) {
+    size_t expected = strtoul(contentLength + 18, nullptr, 10);
+    complete = length - (headerEnd + 4 - response) == expected;
+  }
+  if (status != 200 || !complete) {
+    snprintf(client.lastError, sizeof(client.lastError), "%s: status %d, %u bytes", path, status, (unsigned)length);
+    return false;
+  }
+  return true;
+}
+
+void runLoad(int clients) {
+  std::vector<LoadClient> results(clients);
+  std::atomic<bool> stop(false);
+  std::atomic<int> running(clients);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < clients; i++) {
+    results[i].latencyUs.reserve(100000);
+    threads.emplace_back([&, i]() {
+      LoadClient& client = results[i];
+      for (int r = i; !stop; r++) {
+        timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        bool ok = fetchOnce(LOAD_PATHS[r % LOAD_PATH_COUNT], client);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        if (!ok) client.failures++;
+        client.latencyUs.push_back((end.tv_sec - start.tv_sec) * 1000000 + (end.tv_nsec - start.tv_nsec) / 1000);
+      }
+      running--;
+    });
+  }
+
+  // The firmware runs its whole loop meanwhile, display and all
+  unsigned long start = millis();
+  while (millis() - start < LOAD_MS) loop();
+  stop = true;
+  while (running > 0) loop();
+  for (std::thread& t : threads) t.join();
+
+  std::vector<uint32_t> all;
+  int failures = 0;
+  const char* error = "";
+  for (const LoadClient& client : results) {
+    all.insert(all.end(), client.latencyUs.begin(), client.latencyUs.end());
+    failures += client.failures;
+    if (client.failures) error = client.lastError;
+  }
+  std::sort(all.begin(), all.end());
+  uint32_t p99 = all[all.size() * 99 / 100];
+
+  char report[160];
+  snprintf(report, sizeof(report), "%d clients: %u requests, %.0f req/s, p50 %.2f ms, p99 %.2f ms, %d failed",
+           clients, (unsigned)all.size(), all.size() * 1000.0 / LOAD_MS, all[all.size() / 2] / 1000.0,
+           p99 / 1000.0, failures);
+  TEST_MESSAGE(report);
+  TEST_ASSERT_EQUAL_MESSAGE(0, failures, error);
+  TEST_ASSERT_LESS_THAN(LOAD_P99_LIMIT_US, p99);
+}
+
+void test_load_1_client() { runLoad(1); }
+void test_load_4_clients() { runLoad(4); }
+void test_load_8_clients() { runLoad(8); }
+
+void setUp() {}
+void tearDown() {}
+
+int main() {
+  char fsRoot[] = "/tmp/dashboard_load_XXXXXX";
+  setenv("NATIVE_FS_ROOT", mkdtemp(fsRoot), 1);
+  setenv("NATIVE_HTTP_FIXTURES", fsRoot, 1);  // no fixtures: fetches fail fast
+  char port[8];
+  snprintf(port, sizeof(port), "%u", LOAD_PORT);
+  setenv("NATIVE_HTTP_PORT", port, 1);
+  setup();
+  updateWifi();  // the link, and with it the web server, as loop() brings them up
+
+  UNITY_BEGIN();
+  RUN_TEST(test_load_1_client);
+  RUN_TEST(test_load_4_clients);
+  RUN_TEST(test_load_8_clients);
+  return UNITY_END();
+}
@@ -0,0 +1,249 @@
+// The runtime lunar calculator against a published ephemeris: new and full
+// moon instants from the US Naval Observatory's phases of the moon tables
+// (UTC, to the minute). 2024 falls inside lunar_table.h, so the same dates
+// also check the table; the earlier ones only the computed path, which the
+// firmware falls back to outside 2020-2060.
+#include "../../src/main.cpp"
+#include <unity.h>
+
+const int PHASE_TIME_TOLERANCE_S = 5 * 60;  // "a few minutes", see LUNAR CALCULATOR
+const float ELONGATION_TOLERANCE_DEG = 0.5f;
+const int TABLE_TOLERANCE_S = 90;  // the table is the full series, rounded
+
+struct PublishedPhase {
+  int year, month, day, hour, minute;
+  bool full;
+};
+
+const PublishedPhase USNO_PHASES[] = {
+  {2000, 1, 6, 18, 14, false}, {2000, 1, 21, 4, 40, true},
+  {2015, 9, 28, 2, 50, true},  {2017, 8, 21, 18, 30, false},
+  {2018, 1, 31, 13, 27, true}, {2019, 7, 2, 19, 16, false},
+  {2024, 1, 11, 11, 57, false}, {2024, 1, 25, 17, 54, true},
+  {2024, 2, 9, 22, 59, false},  {2024, 2, 24, 12, 30, true},
+  {2024, 3, 10, 9, 0, false},   {2024, 3, 25, 7, 0, true},
+  {2024, 4, 8, 18, 21, false},  {2024, 4, 23, 23, 49, true},
+  {2024, 5, 8, 3, 22, false},   {2024, 5, 23, 13, 53, true},
+  {2024, 6, 6, 12, 38, false},  {2024, 6, 22, 1, 8, true},
+  {2024, 7, 5, 22, 57, false},  {2024, 7, 21, 10, 17, true},
+  {2024, 8, 4, 11, 13, false},  {2024, 8, 19, 18, 26, true},
+  {2024, 9, 3, 1, 55, false},   {2024, 9, 18, 2, 34, true},
+  {2024, 10, 2, 18, 49, false}, {2024, 10, 17, 11, 26, true},
+  {2024, 11, 1, 12, 47, false}, {2024, 11, 15, 21, 28, true},
+  {2024, 12, 1, 6, 21, false},  {2024, 12, 15, 9, 2, true},
+};
+
+time_t utc(const PublishedPhase& p) {
+  struct tm date = {};
+  date.tm_year = p.year - 1900;
+  date.tm_mon = p.month - 1;
+  date.tm_mday = p.day;
+  date.tm_hour = p.hour;
+  date.tm_min = p.minute;
+  return timegm(&date);
+}
+
+// Lunation number of a published phase, counted like lunarPhaseTime's k
+int32_t lunationOf(const PublishedPhase& p) {
+  double lunations = (double)(utc(p) - NEW_MOON_EPOCH) / SYNODIC_MONTH_SECONDS - (p.full ? 0.5 : 0.0);
+  return (int32_t)lround(lunations);
+}
+
+void describe(const PublishedPhase& p, char* out, size_t size) {
+  snprintf(out, size, "%s moon %04d-%02d-%02d %02d:%02d", p.full ? "full" : "new", p.year, p.month, p.day,
+           p.hour, p.minute);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_phase_times_match_usno() {
+  int worst = 0;
+  for (const PublishedPhase& p : USNO_PHASES) {
+    char message[48];
+    describe(p, message, sizeof(message));
+    int error = abs((int)(lunarPhaseTime(lunationOf(p), p.full) - utc(p)));
+    TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(PHASE_TIME_TOLERANCE_S, error, message);
+    worst = max(worst, error);
+  }
+  char report[48];
+  snprintf(report, sizeof(report), "lunarPhaseTime: worst error %d s", worst);
+  TEST_MESSAGE(report);
+}
+
+void test_elongation_at_published_phases() {
+  float worst = 0;
+  for (const PublishedPhase& p : USNO_PHASES) {
+    char message[48];
+    describe(p, message, sizeof(message));
+    float elongation = lunarElongation(utc(p));
+    float error = p.full ? fabsf(elongation - 180.0f) : min(elongation, 360.0f - elongation);
+    TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(ELONGATION_TOLERANCE_DEG, error, message);
+    worst = max(worst, error);
+  }
+  char report[48];
+  snprintf(report, sizeof(report), "lunarElongation: worst error %.2f deg", worst);
+  TEST_MESSAGE(report);
+}
+
+void test_table_matches_usno() {
+  for (const PublishedPhase& p : USNO_PHASES) {
+    if (p.year < 2020) continue;
+    char message[48];
+    describe(p, message, sizeof(message));
+    int i = lunarTableIndex(utc(p) + (p.full ? 0 : TABLE_TOLERANCE_S));
+    TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE(0, i, message);
+    time_t tabled = p.full ? lunarFullMoon(i) : lunarNewMoon(i);
+    TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(TABLE_TOLERANCE_S, abs((int)(tabled - utc(p))), message);
+  }
+}
+
+// Reference illuminated fraction: the Moon's longitude, latitude and
+// distance from the larger terms of Meeus ch. 47 and the Sun's from ch. 25,
+// in double precision, then the phase angle from the full triangle
+// (ch. 48.2-48.3) rather than the elongation shortcut the firmware takes.
+// Good to about 0.05 degrees, well inside a percent of illumination.
+struct MoonTerm {
+  int8_t D, M, Mp, F;
+  int32_t longitude;  // 1e-6 degree
+  int32_t distance;   // metres
+};
+
+const MoonTerm LONGITUDE_DISTANCE[] = {
+  {0, 0, 1, 0, 6288774, -20905355}, {2, 0, -1, 0, 1274027, -3699111}, {2, 0, 0, 0, 658314, -2955968},
+  {0, 0, 2, 0, 213618, -569925},    {0, 1, 0, 0, -185116, 48888},     {0, 0, 0, 2, -114332, -3149},
+  {2, 0, -2, 0, 58793, 246158},     {2, -1, -1, 0, 57066, -152138},   {2, 0, 1, 0, 53322, -170733},
+  {2, -1, 0, 0, 45758, -204586},    {0, 1, -1, 0, -40923, -129620},   {1, 0, 0, 0, -34720, 108743},
+  {0, 1, 1, 0, -30383, 104755},     {2, 0, 0, -2, 15327, 10321},      {0, 0, 1, 2, -12528, 0},
+  {0, 0, 1, -2, 10980, 79661},      {4, 0, -1, 0, 10675, -34782},     {0, 0, 3, 0, 10034, -23210},
+  {4, 0, -2, 0, 8548, -21636},      {2, 1, -1, 0, -7888, 24208},      {2, 1, 0, 0, -6766, 30824},
+  {1, 0, -1, 0, -5163, -8379},      {1, 1, 0, 0, 4987, -16675},       {2, -1, 1, 0, 4036, -12831},
+  {2, 0, 2, 0, 3994, -10445},       {4, 0, 0, 0, 3861, -11650},       {2, 0, -3, 0, 3665, 14403},
+  {0, 1, -2, 0, -2689, -7003},      {2, -1, -2, 0, 2390, 10056},      {1, 0, 1, 0, -2348, 6322},
+  {2, -2, 0, 0, 2236, -9884},
+};
+
+const MoonTerm LATITUDE[] = {  // longitude holds the latitude coefficient
+  {0, 0, 0, 1, 5128122, 0}, {0, 0, 1, 1, 280602, 0},   {0, 0, 1, -1, 277693, 0}, {2, 0, 0, -1, 173237, 0},
+  {2, 0, -1, 1, 55413, 0},  {2, 0, -1, -1, 46271, 0},  {2, 0, 0, 1, 32573, 0},   {0, 0, 2, 1, 17198, 0},
+  {2, 0, 1, -1, 9266, 0},   {0, 0, 2, -1, 8822, 0},    {2, -1, 0, -1, 8216, 0},  {2, 0, -2, -1, 4324, 0},
+  {2, 0, 1, 1, 4200, 0},    {2, 1, 0, -1, -3359, 0},   {2, -1, -1, 1, 2463, 0},  {2, -1, 0, 1, 2211, 0},
+  {2, -1, -1, -1, 2065, 0}, {0, 1, -1, -1, -1870, 0},  {4, 0, -1, -1, 1828, 0},  {0, 1, 0, 1, -1794, 0},
+};
+
+double rad(double degrees) { return degrees * M_PI / 180.0; }
+
+double referenceIllumination(time_t t) {
+  double T = (t - J2000_EPOCH) / (36525.0 * 86400.0);
+  double Lp = 218.3164477 + 481267.88123421 * T - 0.0015786 * T * T;
+  double D = 297.8501921 + 445267.1114034 * T - 0.0018819 * T * T;
+  double M = 357.5291092 + 35999.0502909 * T - 0.0001536 * T * T;
+  double Mp = 134.9633964 + 477198.8675055 * T + 0.0087414 * T * T;
+  double F = 93.2720950 + 483202.0175233 * T - 0.0036539 * T * T;
+  double E = 1 - 0.002516 * T - 0.0000074 * T * T;
+  double A1 = 119.75 + 131.849 * T, A2 = 53.09 + 479264.290 * T, A3 = 313.45 + 481266.484 * T;
+
+  double sumL = 3958 * sin(rad(A1)) + 1962 * sin(rad(Lp - F)) + 318 * sin(rad(A2));
+  double sumR = 0;
+  for (const MoonTerm& term : LONGITUDE_DISTANCE) {
+    double arg = rad(term.D * D + term.M * M + term.Mp * Mp + term.F * F);
+    double e = abs(term.M) == 2 ? E * E : term.M ? E : 1;
+    sumL += e * term.longitude * sin(arg);
+    sumR += e * term.distance * cos(arg);
+  }
+  double sumB = -2235 * sin(rad(Lp)) + 382 * sin(rad(A3)) + 175 * sin(rad(A1 - F)) + 175 * sin(rad(A1 + F)) +
+                127 * sin(rad(Lp - Mp)) - 115 * sin(rad(Lp + Mp));
+  for (const MoonTerm& term : LATITUDE) {
+    double e = abs(term.M) == 2 ? E * E : term.M ? E : 1;
+    sumB += e * term.longitude * sin(rad(term.D * D + term.M * M + term.Mp * Mp + term.F * F));
+  }
+  double moonLongitude = Lp + sumL / 1e6;
+  double moonLatitude = sumB / 1e6;
+  double moonDistance = 385000.56 + sumR / 1000;  // km
+
+  double L0 = 280.46646 + 36000.76983 * T;
+  double e = 0.016708634 - 0.000042037 * T;
+  double C = (1.914602 - 0.004817 * T) * sin(rad(M)) + 0.019993 * sin(rad(2 * M)) + 0.000289 * sin(rad(3 * M));
+  double sunLongitude = L0 + C;
+  double sunDistance = 149597870.7 * 1.000001018 * (1 - e * e) / (1 + e * cos(rad(M + C)));
+
+  double elongation = acos(cos(rad(moonLatitude)) * cos(rad(moonLongitude - sunLongitude)));
+  double phaseAngle = atan2(sunDistance * sin(elongation), moonDistance - sunDistance * cos(elongation));
+  return (1 + cos(phaseAngle)) * 50;
+}
+
+void test_reference_at_published_phases() {
+  for (const PublishedPhase& p : USNO_PHASES) {
+    char message[48];
+    describe(p, message, sizeof(message));
+    // Full moons can be a few percent short when the Moon passes off the
+    // Sun-Earth line; a new moon can be lit a little for the same reason
+    if (p.full) TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE(97.0, referenceIllumination(utc(p)), message);
+    else TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(3.0, referenceIllumination(utc(p)), message);
+  }
+}
+
+struct IlluminationRun {
+  float worst;
+  uint32_t cycles;  // per computeMoon, host cycles at the 80 MHz scale
+};
+
+// Hourly over a year from start: worst illumination error and cost
+IlluminationRun runIllumination(time_t start) {
+  const int HOURS = 366 * 24;
+  IlluminationRun run = {0, 0};
+  MoonState state;
+  for (int h = 0; h < HOURS; h++) {
+    time_t t = start + h * 3600;
+    computeMoon(t, state);
+    run.worst = max(run.worst, (float)fabs(state.illumination - referenceIllumination(t)));
+  }
+  volatile uint8_t sink = 0;
+  uint32_t begin = ESP.getCycleCount();
+  for (int h = 0; h < HOURS; h++) {
+    computeMoon(start + h * 3600, state);
+    sink = sink + state.illumination;
+  }
+  run.cycles = (ESP.getCycleCount() - begin) / HOURS;
+  return run;
+}
+
+// The table path against the runtime algorithm, which the firmware uses
+// past 2060. Illumination on both is the phase angle from
+// lunarElongation(); the cosine of the fraction of the lunation elapsed
+// that the table path used before was up to 8 points off, since the Moon
+// runs ahead of or behind its mean motion by up to a day.
+void test_illumination_benchmark() {
+  const float ILLUMINATION_TOLERANCE = 1.0f;  // percent, rounding included
+  IlluminationRun table = runIllumination(1704067200);     // 2024
+  IlluminationRun computed = runIllumination(3049228800);  // 2066
+  char report[96];
+  snprintf(report, sizeof(report), "table: worst %.2f%%, %u host cycles; computed: worst %.2f%%, %u host cycles",
+           table.worst, (unsigned)table.cycles, computed.worst, (unsigned)computed.cycles);
+  TEST_MESSAGE(report);
+  TEST_ASSERT_LESS_OR_EQUAL(ILLUMINATION_TOLERANCE, table.worst);
+  TEST_ASSERT_LESS_OR_EQUAL(ILLUMINATION_TOLERANCE, computed.worst);
+  TEST_ASSERT_LESS_THAN(computed.cycles, table.cycles);
+}
+
+// Outside the table computeMoon brackets t with the computed phases
+void test_computed_moon_brackets_published_phases() {
+  MoonState state;
+  PublishedPhase newMoon = {2000, 1, 6, 18, 14, false};
+  PublishedPhase fullMoon = {2000, 1, 21, 4, 40, true};
+  computeMoon(utc(newMoon) + 7 * 86400, state);
+  TEST_ASSERT_INT_WITHIN(PHASE_TIME_TOLERANCE_S, utc(newMoon), state.lastNewMoon);
+  TEST_ASSERT_INT_WITHIN(PHASE_TIME_TOLERANCE_S, utc(fullMoon), state.nextFullMoon);
+  TEST_ASSERT_EQUAL(2, state.phase);  // first quarter
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_phase_times_match_usno);
+  RUN_TEST(test_elongation_at_published_phases);
+  RUN_TEST(test_table_matches_usno);
+  RUN_TEST(test_computed_moon_brackets_published_phases);
+  RUN_TEST(test_reference_at_published_phases);
+  RUN_TEST(test_illumination_benchmark);
+  return UNITY_END();
+}
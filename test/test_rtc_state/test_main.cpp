@@ -0,0 +1,137 @@
+// RtcState through native_hal's RTC user memory: what saveRtcState() writes
+// comes back after a warm reset, and a damaged or foreign block is refused
+// so the firmware cold starts instead.
+#include "../../src/main.cpp"
+#include <unity.h>
+
+const time_t RTC_TEST_EPOCH = 1718000000;  // 2024-06-10
+const uint32_t RTC_TEST_MS = 750;  // into that second, when saved
+
+void setClock(time_t t, uint32_t ms = 0) {
+  timeval tv = {t, (suseconds_t)ms * 1000};
+  halSetTime(tv);
+}
+
+int64_t clockMs() {
+  timeval tv;
+  halGetTime(tv);
+  return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+void useSampleState() {
+  weather.tempDeci = -35;
+  weather.code = 71;
+  for (int i = 0; i < FORECAST_DAYS; i++) {
+    ForecastDay& day = weather.forecast[i];
+    day.date = packDate(2024, 6, 10 + i);
+    day.maxDeci = 180 + i;
+    day.minDeci = 90 - i;
+    day.code = i + 1;
+  }
+  weatherFetchedAt = RTC_TEST_EPOCH - 120;
+  currentView = (View)(VIEW_COUNT - 1);
+  currentQuoteIndex = 7;
+}
+
+// What a reset clears: everything restoreRtcState() brings back
+void forgetState() {
+  weather.tempDeci = TEMP_UNKNOWN;
+  weather.code = CODE_UNKNOWN;
+  memset(weather.forecast, 0, sizeof(weather.forecast));
+  weatherFetchedAt = 0;
+  currentView = CLOCK_VIEW;
+  currentQuoteIndex = 0;
+}
+
+void assertSampleState() {
+  TEST_ASSERT_EQUAL(-35, weather.tempDeci);
+  TEST_ASSERT_EQUAL(71, weather.code);
+  for (int i = 0; i < FORECAST_DAYS; i++) {
+    TEST_ASSERT_EQUAL(packDate(2024, 6, 10 + i), weather.forecast[i].date);
+    TEST_ASSERT_EQUAL(180 + i, weather.forecast[i].maxDeci);
+    TEST_ASSERT_EQUAL(90 - i, weather.forecast[i].minDeci);
+    TEST_ASSERT_EQUAL(i + 1, weather.forecast[i].code);
+  }
+  TEST_ASSERT_EQUAL(RTC_TEST_EPOCH - 120, weatherFetchedAt);
+  TEST_ASSERT_EQUAL(VIEW_COUNT - 1, currentView);
+  TEST_ASSERT_EQUAL(7, currentQuoteIndex);
+}
+
+void setUp() {
+  ESP.getResetInfoPtr()->reason = REASON_SOFT_WDT_RST;
+  setClock(RTC_TEST_EPOCH, RTC_TEST_MS);
+  useSampleState();
+  saveRtcState();
+  forgetState();
+}
+
+void tearDown() {}
+
+// The clock comes back to the millisecond it was saved at plus millis(),
+// the time since this boot; the native millis() counts from process start
+void test_round_trip() {
+  setClock(0);  // the wall clock is lost with the reset
+  TEST_ASSERT_TRUE(restoreRtcState());
+  int64_t expected = (int64_t)RTC_TEST_EPOCH * 1000 + RTC_TEST_MS + millis();
+  assertSampleState();
+  TEST_ASSERT_INT64_WITHIN(20, expected, clockMs());
+}
+
+// The first 128 bytes belong to the OTA bootloader
+void test_leaves_bootloader_area_alone() {
+  uint32_t bootloader[RTC_STATE_OFFSET];
+  memset(bootloader, 0xA5, sizeof(bootloader));
+  TEST_ASSERT_TRUE(ESP.rtcUserMemoryWrite(0, bootloader, sizeof(bootloader)));
+  useSampleState();
+  saveRtcState();
+  uint32_t after[RTC_STATE_OFFSET];
+  TEST_ASSERT_TRUE(ESP.rtcUserMemoryRead(0, after, sizeof(after)));
+  TEST_ASSERT_EQUAL_MEMORY(bootloader, after, sizeof(after));
+}
+
+// Any single flipped byte, as a brown-out might leave, fails the check and
+// restores nothing
+void test_damaged_block_is_rejected() {
+  RtcState good;
+  TEST_ASSERT_TRUE(ESP.rtcUserMemoryRead(RTC_STATE_OFFSET, (uint32_t*)&good, sizeof(good)));
+  TEST_ASSERT_TRUE(isValidRtcState(good));
+
+  for (size_t offset = 0; offset < sizeof(good); offset++) {
+    RtcState bad = good;
+    ((uint8_t*)&bad)[offset] ^= 0x10;
+    ESP.rtcUserMemoryWrite(RTC_STATE_OFFSET, (uint32_t*)&bad, sizeof(bad));
+    char message[32];
+    snprintf(message, sizeof(message), "flipped byte %u", (unsigned)offset);
+    TEST_ASSERT_FALSE_MESSAGE(restoreRtcState(), message);
+    TEST_ASSERT_EQUAL_MESSAGE(TEMP_UNKNOWN, weather.tempDeci, message);
+    TEST_ASSERT_EQUAL_MESSAGE(0, weatherFetchedAt, message);
+  }
+}
+
+// A block from other firmware with a valid crc is still not ours
+void test_other_version_is_rejected() {
+  RtcState state;
+  ESP.rtcUserMemoryRead(RTC_STATE_OFFSET, (uint32_t*)&state, sizeof(state));
+  state.version = RTC_STATE_VERSION + 1;
+  state.crc = crc32Update(0, (const uint8_t*)&state, offsetof(RtcState, crc));
+  ESP.rtcUserMemoryWrite(RTC_STATE_OFFSET, (uint32_t*)&state, sizeof(state));
+  TEST_ASSERT_FALSE(restoreRtcState());
+  TEST_ASSERT_EQUAL(TEMP_UNKNOWN, weather.tempDeci);
+}
+
+// After power-on the memory is noise, even when it happens to check out
+void test_power_on_is_a_cold_start() {
+  ESP.getResetInfoPtr()->reason = REASON_DEFAULT_RST;
+  TEST_ASSERT_FALSE(restoreRtcState());
+  TEST_ASSERT_EQUAL(TEMP_UNKNOWN, weather.tempDeci);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip);
+  RUN_TEST(test_leaves_bootloader_area_alone);
+  RUN_TEST(test_damaged_block_is_rejected);
+  RUN_TEST(test_other_version_is_rejected);
+  RUN_TEST(test_power_on_is_a_cold_start);
+  return UNITY_END();
+}
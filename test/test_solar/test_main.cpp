@@ -0,0 +1,149 @@
+// computeSolarDay against reference sun times, and what a day costs.
+//
+// The reference rows come from scripts/solar_reference.py: NOAA's full
+// solar calculator, iterated to each event. The firmware evaluates NOAA's
+// shorter fractional-year series once at noon, which is good to a minute
+// or two away from the polar circles.
+#include "../../src/main.cpp"
+#include <unity.h>
+
+const int RISE_SET_TOLERANCE_MIN = 2;
+const int CIVIL_TOLERANCE_MIN = 3;  // the shallower crossing amplifies declination error
+// Beyond 60 degrees the declination taken at noon, which moves up to 0.4
+// degrees a day around the equinoxes, shifts every crossing by minutes
+const float HIGH_LATITUDE = 60.0f;
+const int HIGH_LATITUDE_TOLERANCE_MIN = 4;
+
+struct SolarReference {
+  const char* place;
+  float latitude;
+  float longitude;
+  int year, month, day;
+  int offsetMinutes;
+  int16_t minutes[5];  // dawn, sunrise, noon, sunset, dusk; local minute of day
+};
+
+const SolarReference REFERENCE[] = {
+  {"London", 51.5074, -0.1278, 2024, 6, 21, 60, {235, 283, 782, 1282, 1329}},
+  {"London", 51.5074, -0.1278, 2024, 12, 21, 0, {444, 484, 719, 954, 994}},
+  {"New York", 40.7128, -74.0060, 2024, 3, 20, -240, {391, 418, 783, 1149, 1176}},
+  {"Sydney", -33.8688, 151.2093, 2024, 12, 21, 660, {312, 341, 773, 1206, 1235}},
+  {"Cape Town", -33.9249, 18.4241, 2024, 6, 21, 120, {444, 471, 768, 1065, 1093}},
+  {"Quito", -0.1807, -78.4678, 2024, 9, 22, -300, {342, 363, 726, 1090, 1110}},
+  {"Tokyo", 35.6762, 139.6503, 2025, 1, 1, 540, {383, 411, 705, 999, 1027}},
+  {"Anchorage", 61.2181, -149.9003, 2024, 2, 29, -540, {437, 481, 792, 1104, 1148}},
+  {"Reykjavik", 64.1466, -21.9426, 2024, 6, 21, 0, {MINUTE_UNKNOWN, 175, 810, 4, MINUTE_UNKNOWN}},
+  {"Tromso", 69.6492, 18.9553, 2024, 6, 21, 120, {MINUTE_UNKNOWN, MINUTE_UNKNOWN, 766, MINUTE_UNKNOWN, MINUTE_UNKNOWN}},
+  {"Tromso", 69.6492, 18.9553, 2024, 12, 21, 60, {572, MINUTE_UNKNOWN, 702, MINUTE_UNKNOWN, 833}},
+};
+
+int dayOfYear(int year, int month, int day) {
+  struct tm date = {};
+  date.tm_year = year - 1900;
+  date.tm_mon = month - 1;
+  date.tm_mday = day;
+  time_t t = timegm(&date);
+  gmtime_r(&t, &date);
+  return date.tm_yday;
+}
+
+// Minutes apart on the clock face, so 23:59 and 00:01 are 2 apart
+int minutesApart(int a, int b) {
+  int d = abs(a - b) % 1440;
+  return d > 720 ? 1440 - d : d;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_matches_reference_table() {
+  const char* const EVENTS[] = {"dawn", "sunrise", "noon", "sunset", "dusk"};
+  int worst = 0;
+  for (const SolarReference& ref : REFERENCE) {
+    SolarDay day;
+    computeSolarDay(ref.latitude, ref.longitude, dayOfYear(ref.year, ref.month, ref.day), ref.year,
+                    ref.offsetMinutes, day);
+    int16_t got[5] = {day.dawnMinute, day.sunriseMinute, day.noonMinute, day.sunsetMinute, day.duskMinute};
+    for (int i = 0; i < 5; i++) {
+      char message[64];
+      snprintf(message, sizeof(message), "%s %04d-%02d-%02d %s", ref.place, ref.year, ref.month, ref.day, EVENTS[i]);
+      if (ref.minutes[i] == MINUTE_UNKNOWN) {
+        TEST_ASSERT_EQUAL_MESSAGE(MINUTE_UNKNOWN, got[i], message);
+        continue;
+      }
+      TEST_ASSERT_NOT_EQUAL_MESSAGE(MINUTE_UNKNOWN, got[i], message);
+      int error = minutesApart(got[i], ref.minutes[i]);
+      bool civil = i == 0 || i == 4;
+      int tolerance = fabsf(ref.latitude) > HIGH_LATITUDE ? HIGH_LATITUDE_TOLERANCE_MIN
+                      : civil                             ? CIVIL_TOLERANCE_MIN
+                                                          : RISE_SET_TOLERANCE_MIN;
+      TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(tolerance, error, message);
+      worst = max(worst, error);
+    }
+  }
+  char report[48];
+  snprintf(report, sizeof(report), "worst error %d min", worst);
+  TEST_MESSAGE(report);
+}
+
+// Every day of a leap year at a mid latitude: a sunrise before noon before
+// a sunset, and the day length never jumps by more than a few minutes
+void test_year_is_continuous() {
+  int previousLength = -1;
+  for (int yday = 0; yday < 366; yday++) {
+    SolarDay day;
+    computeSolarDay(48.8566f, 2.3522f, yday, 2024, 60, day);
+    TEST_ASSERT_LESS_THAN(day.noonMinute, day.sunriseMinute);
+    TEST_ASSERT_GREATER_THAN(day.noonMinute, day.sunsetMinute);
+    int length = day.sunsetMinute - day.sunriseMinute;
+    if (previousLength >= 0) TEST_ASSERT_LESS_OR_EQUAL(5, abs(length - previousLength));
+    previousLength = length;
+  }
+}
+
+// Host cost of a day, for comparing changes to computeSolarDay on one
+// machine only. The ESP8266 has no FPU and its soft-float is far slower, so
+// this says nothing about the device; there updateSolarDay() counts the
+// real cycles and /metrics exports them.
+void test_host_benchmark() {
+  const int DAYS = 20000;
+  SolarDay day;
+  volatile int16_t sink = 0;
+  uint32_t start = ESP.getCycleCount();
+  for (int i = 0; i < DAYS; i++) {
+    computeSolarDay(51.5074f, -0.1278f, i % 365, 2025, 0, day);
+    sink = sink + day.sunriseMinute;
+  }
+  uint32_t elapsed = ESP.getCycleCount() - start;
+  char report[80];
+  snprintf(report, sizeof(report), "computeSolarDay: %u ns per day on this host",
+           (unsigned)(elapsed * 1000ULL / 80 / DAYS));
+  TEST_MESSAGE(report);
+}
+
+void test_update_counts_cycles_for_metrics() {
+  timeval tv = {1718000000, 0};  // 2024-06-10
+  halSetTime(tv);
+  TimeContext now;
+  captureTime(now);
+  solarDay.date = 0;
+  solarComputeCycles = 0;
+  updateSolarDay(now);
+  TEST_ASSERT_NOT_EQUAL(0, solarComputeCycles);
+
+  String out;
+  uint32_t cursor = 0;
+  while (generateMetrics(out, cursor)) {}
+  char line[64];
+  snprintf(line, sizeof(line), "dashboard_solar_compute_cycles %u\n", (unsigned)solarComputeCycles);
+  TEST_ASSERT_NOT_NULL(strstr(out.c_str(), line));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_matches_reference_table);
+  RUN_TEST(test_year_is_continuous);
+  RUN_TEST(test_host_benchmark);
+  RUN_TEST(test_update_counts_cycles_for_metrics);
+  return UNITY_END();
+}
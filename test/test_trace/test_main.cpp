@@ -0,0 +1,54 @@
+// What a TRACE_SPAN leaves in the ring buffer, and what it costs on the
+// host next to the budget of under a microsecond per span.
+#include "../../src/main.cpp"
+#include <unity.h>
+
+const uint32_t SPAN_BUDGET_CYCLES = 80;  // 1 us at 80 MHz
+
+void setUp() {}
+void tearDown() {}
+
+void test_span_records_begin_and_end() {
+  uint32_t before = traceCount;
+  {
+    TRACE_SPAN(TRACE_SAVE_CONFIG);
+    TRACE_SPAN(TRACE_DRAW_VIEW);
+  }
+  TEST_ASSERT_EQUAL(before + 4, traceCount);
+  const char expected[] = "BBEE";
+  const uint8_t names[] = {TRACE_SAVE_CONFIG, TRACE_DRAW_VIEW, TRACE_DRAW_VIEW, TRACE_SAVE_CONFIG};
+  for (uint32_t i = 0; i < 4; i++) {
+    const TraceEvent& event = traceEvents[(before + i) & (TRACE_EVENTS - 1)];
+    TEST_ASSERT_EQUAL(expected[i], event.phase);
+    TEST_ASSERT_EQUAL(names[i], event.name);
+  }
+}
+
+// Host time per span, begin and end, in the 80 MHz cycles ESP.getCycleCount()
+// counts on the native build. Most of it is the host's clock_gettime()
+// behind getCycleCount(), while on the chip that read is a single
+// rsr.ccount, so the figure is reported, not held to the budget. Build with
+// -DTRACE_BUDGET_CHECK to fail above it anyway, e.g. on a quiet benchmark box.
+void test_span_cycle_benchmark() {
+  const int SPANS = 200000;
+  uint32_t start = ESP.getCycleCount();
+  for (int i = 0; i < SPANS; i++) {
+    TRACE_SPAN(TRACE_HANDLE_API);
+  }
+  uint32_t elapsed = ESP.getCycleCount() - start;
+  uint32_t cycles = elapsed / SPANS;
+  char report[96];
+  snprintf(report, sizeof(report), "TRACE_SPAN: %u host cycles per span (80 MHz scale), %u ns",
+           (unsigned)cycles, (unsigned)(elapsed * 1000ULL / 80 / SPANS));
+  TEST_MESSAGE(report);
+#ifdef TRACE_BUDGET_CHECK
+  TEST_ASSERT_LESS_THAN(SPAN_BUDGET_CYCLES, cycles);
+#endif
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_span_records_begin_and_end);
+  RUN_TEST(test_span_cycle_benchmark);
+  return UNITY_END();
+}
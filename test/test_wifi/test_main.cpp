@@ -0,0 +1,163 @@
+// The reconnect machine in updateWifi() against native_hal's settable link:
+// connect times are taken from the WiFi.begin() that got through, and the
+// cached lease is only reused for as long as the DHCP server granted it.
+#include "../../src/main.cpp"
+#include <unity.h>
+
+char fsRoot[] = "/tmp/dashboard_wifi_XXXXXX";
+const time_t WIFI_TEST_EPOCH = 1718000000;  // 2024-06-10
+
+void setClock(time_t t) {
+  timeval tv = {t, 0};
+  halSetTime(tv);
+}
+
+// A DHCP connect at the test epoch, cached in /wifi.bin
+void connectOverDhcp() {
+  setClock(WIFI_TEST_EPOCH);
+  WiFi.linkStatus = WL_CONNECTED;
+  beginWifiAttempt(false);
+  updateWifi();
+  TEST_ASSERT_EQUAL(WIFI_UP, wifiState);
+}
+
+void setUp() {
+  LittleFS.remove(WIFI_LEASE_PATH);
+  wifiLeaseValid = false;
+  wifiStaticLease = false;
+  wifiRetryDelay = WIFI_RETRY_MIN;
+  nativeDhcpLeaseSeconds = 86400;
+}
+
+void tearDown() { WiFi.linkStatus = WL_CONNECTED; }
+
+void test_dhcp_connect_caches_the_lease_time() {
+  nativeDhcpLeaseSeconds = 7200;
+  connectOverDhcp();
+  TEST_ASSERT_FALSE(wifiLastConnectFast);
+  TEST_ASSERT_TRUE(loadWifiLease());
+  TEST_ASSERT_EQUAL(7200, wifiLease.leaseSeconds);
+  TEST_ASSERT_EQUAL(WIFI_TEST_EPOCH, wifiLease.leasedAt);
+  TEST_ASSERT_TRUE(wifiLeaseUsable());
+}
+
+// A link that comes up during the backoff is timed from its WiFi.begin(),
+// not from when the backoff started
+void test_backoff_connect_is_timed_from_begin() {
+  WiFi.linkStatus = WL_DISCONNECTED;
+  beginWifiAttempt(false);
+  wifiAttemptStart = millis() - WIFI_SCAN_TIMEOUT;
+  updateWifi();
+  TEST_ASSERT_EQUAL(WIFI_BACKOFF, wifiState);
+
+  wifiAttemptStart -= 2000;  // that begin() was 17 s ago
+  WiFi.linkStatus = WL_CONNECTED;
+  updateWifi();
+  TEST_ASSERT_EQUAL(WIFI_UP, wifiState);
+  TEST_ASSERT_UINT32_WITHIN(50, WIFI_SCAN_TIMEOUT + 2000, wifiLastConnectMs);
+}
+
+// The backoff waits from its own start; a retry only follows once it is over
+void test_backoff_waits_its_delay() {
+  WiFi.linkStatus = WL_DISCONNECTED;
+  beginWifiAttempt(false);
+  wifiAttemptStart = millis() - WIFI_SCAN_TIMEOUT;
+  updateWifi();
+  TEST_ASSERT_EQUAL(WIFI_BACKOFF, wifiState);
+  updateWifi();
+  TEST_ASSERT_EQUAL(WIFI_BACKOFF, wifiState);
+
+  wifiBackoffStart -= WIFI_RETRY_MIN;
+  updateWifi();
+  TEST_ASSERT_EQUAL(WIFI_SCAN_RETRY, wifiState);
+  TEST_ASSERT_UINT32_WITHIN(50, 0, millis() - wifiAttemptStart);
+  TEST_ASSERT_EQUAL(2 * WIFI_RETRY_MIN, wifiRetryDelay);
+}
+
+// A lost link rejoins on the cached IP while the lease lasts, over DHCP after
+void test_expired_lease_falls_back_to_dhcp() {
+  nativeDhcpLeaseSeconds = 3600;
+  connectOverDhcp();
+
+  WiFi.linkStatus = WL_DISCONNECTED;
+  updateWifi();
+  TEST_ASSERT_EQUAL(WIFI_FAST_RETRY, wifiState);
+  WiFi.linkStatus = WL_CONNECTED;
+  updateWifi();
+  TEST_ASSERT_TRUE(wifiLastConnectFast);
+
+  setClock(WIFI_TEST_EPOCH + 3600);
+  WiFi.linkStatus = WL_DISCONNECTED;
+  updateWifi();
+  TEST_ASSERT_EQUAL(WIFI_SCAN_RETRY, wifiState);
+}
+
+// Still up on the cached IP when the lease runs out: renewed over DHCP
+void test_static_link_renews_when_the_lease_runs_out() {
+  nativeDhcpLeaseSeconds = 3600;
+  connectOverDhcp();
+  beginWifiAttempt(true);
+  updateWifi();
+  TEST_ASSERT_TRUE(wifiStaticLease);
+
+  setClock(WIFI_TEST_EPOCH + 3599);
+  updateWifi();
+  TEST_ASSERT_EQUAL(WIFI_UP, wifiState);
+  setClock(WIFI_TEST_EPOCH + 3600);
+  updateWifi();
+  TEST_ASSERT_EQUAL(WIFI_SCAN_RETRY, wifiState);
+  updateWifi();
+  TEST_ASSERT_EQUAL(WIFI_UP, wifiState);
+  TEST_ASSERT_FALSE(wifiStaticLease);
+  TEST_ASSERT_EQUAL(WIFI_TEST_EPOCH + 3600, wifiLease.leasedAt);
+}
+
+// Granted before the clock was set: not reused until dated, and dated back
+// to the connect once the clock is known
+void test_lease_without_clock_is_dated_later() {
+  setClock(0);
+  WiFi.linkStatus = WL_CONNECTED;
+  beginWifiAttempt(false);
+  updateWifi();
+  TEST_ASSERT_EQUAL(0, wifiLease.leasedAt);
+  TEST_ASSERT_FALSE(wifiLeaseUsable());
+
+  wifiLeaseGrantedMs -= 30000;  // connected 30 s before the clock was set
+  setClock(WIFI_TEST_EPOCH);
+  updateWifi();
+  TEST_ASSERT_EQUAL(WIFI_TEST_EPOCH - 30, wifiLease.leasedAt);
+  TEST_ASSERT_TRUE(loadWifiLease());
+  TEST_ASSERT_EQUAL(WIFI_TEST_EPOCH - 30, wifiLease.leasedAt);
+}
+
+// Nothing got through since boot: the setup portal opens instead of the
+// backoff, and its connect brings the dashboard back
+void test_failed_boot_opens_the_portal() {
+  bootPhaseMs[BOOT_WIFI] = 0;
+  WiFi.linkStatus = WL_DISCONNECTED;
+  beginWifiAttempt(false);
+  wifiAttemptStart = millis() - WIFI_SCAN_TIMEOUT;
+  updateWifi();
+  TEST_ASSERT_EQUAL(WIFI_PORTAL, wifiState);
+  TEST_ASSERT_NOT_NULL(portalFields);
+  updateWifi();  // native_hal's portal connects at once
+  TEST_ASSERT_EQUAL(WIFI_UP, wifiState);
+  TEST_ASSERT_NULL(portalFields);
+}
+
+int main() {
+  setenv("NATIVE_FS_ROOT", mkdtemp(fsRoot), 1);
+  setenv("NATIVE_HTTP_PORT", "18185", 1);  // the first connect starts the web server
+  LittleFS.begin();
+  display.begin();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_dhcp_connect_caches_the_lease_time);
+  RUN_TEST(test_backoff_connect_is_timed_from_begin);
+  RUN_TEST(test_backoff_waits_its_delay);
+  RUN_TEST(test_expired_lease_falls_back_to_dhcp);
+  RUN_TEST(test_static_link_renews_when_the_lease_runs_out);
+  RUN_TEST(test_lease_without_clock_is_dated_later);
+  RUN_TEST(test_failed_boot_opens_the_portal);
+  return UNITY_END();
+}